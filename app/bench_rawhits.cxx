@@ -0,0 +1,232 @@
+/**
+ * @file bench_rawhits.cxx
+ * Benchmark the ROOT I/O of the raw strip hits, stored as a
+ * std::vector<ldmx::RawSiStripHit> and as ldmx::RawSiStripHitColumns.
+ *
+ * Synthetic high-occupancy events are made with the strip digitizer from
+ * random tracks crossing the sensors. The same events are written to one tree
+ * per format in the same file and read back, and the write and read
+ * throughputs and the compressed size of each format are reported.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include "Tracking/Event/RawSiStripHit.h"
+#include "Tracking/Event/RawSiStripHitColumns.h"
+#include "Tracking/Sim/PhiloxRandom.h"
+#include "Tracking/Sim/StripDigitizer.h"
+
+static void usage() {
+  std::cout
+      << "Usage: ldmx-bench-rawhits [options]\n"
+      << "  Write and read synthetic raw strip hits in both formats.\n"
+      << "  --events N      : number of events (default 1000)\n"
+      << "  --tracks N      : tracks crossing the sensors per event\n"
+      << "                    (default 1000)\n"
+      << "  --sensors N     : number of sensors (default 40)\n"
+      << "  --compression N : ROOT compression setting of the file\n"
+      << "                    (default: the ROOT default)\n"
+      << "  --output FILE   : file written and read (default\n"
+      << "                    rawhits_benchmark.root)\n"
+      << std::endl;
+}
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+/// Time since start in s
+double seconds(const Clock::time_point& start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Make the raw hits of the events with the strip digitizer
+std::vector<std::vector<ldmx::RawSiStripHit>> makeEvents(int n_events,
+                                                          int n_tracks,
+                                                          int n_sensors) {
+  // Sensors of 640 strips of 60 um, 320 um thick
+  const double half_length_u = 19.2;
+  const double thickness = 0.32;
+
+  tracking::sim::StripDigitizer digitizer(
+      tracking::sim::StripDigitizer::Config{});
+  tracking::sim::PhiloxRandom noise(1, 1);
+  std::default_random_engine generator;
+  generator.seed(1);
+  std::uniform_int_distribution<int> sensor(0, n_sensors - 1);
+  std::uniform_real_distribution<double> u(-half_length_u, half_length_u);
+  std::uniform_real_distribution<double> slope(-0.3, 0.3);
+  std::uniform_real_distribution<double> edep(0.06, 0.2);
+  std::uniform_real_distribution<double> time(0., 10.);
+
+  std::vector<std::vector<ldmx::RawSiStripHit>> events(n_events);
+  for (int e = 0; e < n_events; e++) {
+    digitizer.clear();
+    for (int t = 0; t < n_tracks; t++) {
+      double u0 = u(generator), du = 0.5 * thickness * slope(generator);
+      digitizer.deposit(sensor(generator), half_length_u, thickness,
+                        Acts::Vector3(u0 - du, 0., -0.5 * thickness),
+                        Acts::Vector3(u0 + du, 0., 0.5 * thickness),
+                        edep(generator), time(generator));
+    }
+    digitizer.readout(noise, e, events[e]);
+  }
+  return events;
+}
+
+/// Write the events in a tree of the file and return the time in s
+template <typename event_t>
+double write(TFile& file, const std::string& name,
+             const std::vector<event_t>& events) {
+  file.cd();
+  auto* tree = new TTree(name.c_str(), name.c_str());
+  // The branch follows the pointer, the events are written without a copy
+  event_t* address = nullptr;
+  tree->Branch(name.c_str(), &address);
+
+  auto start = Clock::now();
+  for (const auto& e : events) {
+    address = const_cast<event_t*>(&e);
+    tree->Fill();
+  }
+  tree->Write();
+  return seconds(start);
+}
+
+/// Sum of the samples of an event, so that all of them are read
+long sumSamples(const std::vector<ldmx::RawSiStripHit>& hits) {
+  long sum = 0;
+  for (const auto& hit : hits)
+    for (short sample : hit.getSamples()) sum += sample;
+  return sum;
+}
+long sumSamples(const ldmx::RawSiStripHitColumns& hits) {
+  long sum = 0;
+  for (std::size_t i = 0; i < hits.size(); i++) {
+    const short* samples = hits.getSamples(i);
+    for (std::size_t s = 0; s < hits.getNSamples(i); s++) sum += samples[s];
+  }
+  return sum;
+}
+
+/// Read back the events of a tree and return the time in s
+template <typename event_t>
+double read(TFile& file, const std::string& name, long& checksum) {
+  auto* tree = file.Get<TTree>(name.c_str());
+  event_t* event = nullptr;
+  tree->SetBranchAddress(name.c_str(), &event);
+
+  checksum = 0;
+  auto start = Clock::now();
+  for (Long64_t e = 0; e < tree->GetEntries(); e++) {
+    tree->GetEntry(e);
+    checksum += sumSamples(*event);
+  }
+  double time = seconds(start);
+  tree->ResetBranchAddresses();
+  delete event;
+  return time;
+}
+
+/// Print the throughputs and sizes of a format
+void report(const std::string& format, TTree* tree, int n_events,
+            double write_time, double read_time) {
+  double raw_mb = tree->GetTotBytes() / 1e6;
+  double zip_mb = tree->GetZipBytes() / 1e6;
+  std::cout << format << std::endl
+            << "  uncompressed = " << raw_mb << " MB  compressed = " << zip_mb
+            << " MB (" << 1e3 * zip_mb / n_events << " kB/event, ratio "
+            << raw_mb / zip_mb << ")" << std::endl
+            << "  write = " << raw_mb / write_time << " MB/s ("
+            << n_events / write_time << " events/s)" << std::endl
+            << "  read  = " << raw_mb / read_time << " MB/s ("
+            << n_events / read_time << " events/s)" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int n_events = 1000, n_tracks = 1000, n_sensors = 40, compression = -1;
+  std::string output = "rawhits_benchmark.root";
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--events") && has_value) {
+      n_events = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--tracks") && has_value) {
+      n_tracks = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--sensors") && has_value) {
+      n_sensors = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--compression") && has_value) {
+      compression = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--output") && has_value) {
+      output = argv[++i];
+    } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+      usage();
+      return 0;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (n_events < 1 || n_tracks < 0 || n_sensors < 1) {
+    usage();
+    return 1;
+  }
+
+  try {
+    const auto hits = makeEvents(n_events, n_tracks, n_sensors);
+    std::vector<ldmx::RawSiStripHitColumns> columns;
+    columns.reserve(hits.size());
+    std::size_t n_hits = 0;
+    for (const auto& event : hits) {
+      columns.emplace_back(event);
+      n_hits += event.size();
+    }
+
+    double write_hits, write_columns;
+    {
+      TFile file(output.c_str(), "RECREATE");
+      if (compression >= 0) file.SetCompressionSettings(compression);
+      write_hits = write(file, "RawSiStripHits", hits);
+      write_columns = write(file, "RawSiStripHitColumns", columns);
+      file.Close();
+    }
+
+    TFile file(output.c_str(), "READ");
+    long sum_hits, sum_columns;
+    double read_hits =
+        read<std::vector<ldmx::RawSiStripHit>>(file, "RawSiStripHits",
+                                               sum_hits);
+    double read_columns = read<ldmx::RawSiStripHitColumns>(
+        file, "RawSiStripHitColumns", sum_columns);
+    if (sum_hits != sum_columns)
+      throw std::runtime_error("the two formats read back different samples");
+
+    std::cout << "events: " << n_events << "  raw hits/event = "
+              << double(n_hits) / n_events << "  compression = "
+              << file.GetCompressionSettings() << std::endl;
+    report("std::vector<ldmx::RawSiStripHit>",
+           file.Get<TTree>("RawSiStripHits"), n_events, write_hits, read_hits);
+    report("ldmx::RawSiStripHitColumns",
+           file.Get<TTree>("RawSiStripHitColumns"), n_events, write_columns,
+           read_columns);
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file bench_tracks.cxx
+ * Benchmark the accessors of ldmx::Track, with the perigee parameters in
+ * fixed size arrays, against the heap vectors of the version 1 of the class.
+ *
+ * The version 1 storage and accessors are kept here as TrackV1. The same
+ * synthetic track sample is put in both layouts, and three steps are timed
+ * for each: filling the tracks with the setters the way the CKF does,
+ * copying the collections the way the event store does when they are added,
+ * and reading them with the accessors the way TrackingRecoDQM does. The
+ * sums of what is read must agree between the two layouts.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Tracking/Event/Track.h"
+#include "Tracking/Sim/TrackingUtils.h"
+
+static void usage() {
+  std::cout
+      << "Usage: ldmx-bench-tracks [options]\n"
+      << "  Compare the vector and the array storage of the track parameters.\n"
+      << "  --events N : number of events (default 10000)\n"
+      << "  --tracks N : tracks per event (default 10)\n"
+      << "  --repeat N : times each step is repeated, the fastest is kept\n"
+      << "               (default 5)\n"
+      << std::endl;
+}
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * The storage and accessors of the version 1 of ldmx::Track: the perigee
+ * parameters, covariance, location, momentum and position in vectors.
+ */
+class TrackV1 {
+ public:
+  virtual ~TrackV1() {}
+
+  void setNhits(int nhits) { n_hits_ = nhits; }
+  int getNhits() const { return n_hits_; }
+  void setNdf(int ndf) { ndf_ = ndf; }
+  int getNdf() const { return ndf_; }
+  void setNsharedHits(int nsh) { n_shared_hits_ = nsh; }
+  int getNsharedHits() const { return n_shared_hits_; }
+  void setChi2(double chi2) { chi2_ = chi2; }
+  double getChi2() const { return chi2_; }
+
+  void addMeasurementIndex(unsigned int measIdx) {
+    meas_idxs_.push_back(measIdx);
+  }
+
+  void setPerigeeParameters(const std::vector<double>& par) {
+    perigee_pars_ = par;
+  }
+  void setPerigeeCov(const std::vector<double>& cov) { perigee_cov_ = cov; }
+  const std::vector<double>& getPerigeeCov() const { return perigee_cov_; }
+
+  void setPerigeeLocation(const double& x, const double& y, const double& z) {
+    perigee_[0] = x;
+    perigee_[1] = y;
+    perigee_[2] = z;
+  }
+  void setMomentum(const double& px, const double& py, const double& pz) {
+    momentum_[0] = px;
+    momentum_[1] = py;
+    momentum_[2] = pz;
+  }
+  const std::vector<double>& getMomentum() const { return momentum_; }
+
+  double getD0() const { return perigee_pars_[0]; }
+  double getZ0() const { return perigee_pars_[1]; }
+  double getPhi() const { return perigee_pars_[2]; }
+  double getTheta() const { return perigee_pars_[3]; }
+  double getQoP() const { return perigee_pars_[4]; }
+
+  void addTrackState(const ldmx::Track::TrackState& ts) {
+    trackStates_.push_back(ts);
+  }
+
+ protected:
+  int n_hits_{0};
+  int n_outliers_{0};
+  int ndf_{0};
+  int n_shared_hits_{0};
+  int n_holes_{0};
+  double chi2_{0};
+  std::vector<double> perigee_pars_{0., 0., 0., 0., 0., 0.};
+  std::vector<double> perigee_cov_;
+  std::vector<double> perigee_{0., 0., 0.};
+  std::vector<double> momentum_{0., 0., 0.};
+  std::vector<double> position_{0., 0., 0.};
+  std::vector<unsigned int> meas_idxs_{};
+  int trackID_{-1};
+  double truthProb_{0.};
+  int pdgID_{0};
+  std::vector<ldmx::Track::TrackState> trackStates_;
+};
+
+/// What the CKF has at hand when it makes a track
+struct FitResult {
+  std::vector<double> pars;
+  std::vector<double> cov;
+  double px, py, pz;
+  double chi2;
+  int n_hits;
+  ldmx::Track::TrackState target, ecal;
+};
+
+/// Make the synthetic track sample, the fit results of each event
+std::vector<std::vector<FitResult>> makeSample(int n_events, int n_tracks) {
+  std::default_random_engine generator;
+  generator.seed(1);
+  std::uniform_real_distribution<double> flat(-1., 1.);
+  std::uniform_real_distribution<double> p(0.1, 4.);
+  std::uniform_int_distribution<int> hits(8, 14);
+
+  auto state = [&](double ref_x, ldmx::TrackStateType type) {
+    ldmx::Track::TrackState ts;
+    ts.refX = ref_x;
+    ts.refY = 0.;
+    ts.refZ = 0.;
+    for (int i = 0; i < 6; i++) ts.params.push_back(flat(generator));
+    for (int i = 0; i < 21; i++) ts.cov.push_back(1e-3 * (1. + flat(generator)));
+    ts.ts_type = type;
+    return ts;
+  };
+
+  std::vector<std::vector<FitResult>> sample(n_events);
+  for (auto& event : sample) {
+    event.resize(n_tracks);
+    for (auto& fit : event) {
+      double mom = p(generator), theta = 0.2 * flat(generator),
+             phi = 0.2 * flat(generator);
+      fit.pars = {flat(generator), flat(generator), phi, 1.5708 + theta,
+                  (flat(generator) > 0 ? 1. : -1.) / mom, 0.};
+      // Positive diagonal, so that the errors are defined
+      for (int i = 0; i < 6; i++)
+        for (int j = i; j < 6; j++)
+          fit.cov.push_back(i == j ? 1e-4 * (2. + flat(generator))
+                                   : 1e-6 * flat(generator));
+      fit.px = mom * std::cos(theta) * std::cos(phi);
+      fit.py = mom * std::cos(theta) * std::sin(phi);
+      fit.pz = mom * std::sin(theta);
+      fit.chi2 = 10. * (1. + flat(generator));
+      fit.n_hits = hits(generator);
+      fit.target = state(0., ldmx::AtTarget);
+      fit.ecal = state(240., ldmx::AtECAL);
+    }
+  }
+  return sample;
+}
+
+/// Fill the tracks of the sample with the setters, the way the CKF does
+template <typename track_t>
+void fill(const std::vector<std::vector<FitResult>>& sample,
+          std::vector<std::vector<track_t>>& events) {
+  events.clear();
+  events.resize(sample.size());
+  for (std::size_t e = 0; e < sample.size(); e++) {
+    for (const auto& fit : sample[e]) {
+      track_t trk = track_t();
+      trk.setPerigeeLocation(0., 0., 0.);
+      trk.setChi2(fit.chi2);
+      trk.setNhits(fit.n_hits);
+      trk.setNdf(fit.n_hits - 5);
+      trk.setNsharedHits(0);
+      trk.setPerigeeParameters(fit.pars);
+      std::vector<double> v_trk_cov(fit.cov);
+      trk.setPerigeeCov(v_trk_cov);
+      trk.setMomentum(fit.px, fit.py, fit.pz);
+      for (int h = 0; h < fit.n_hits; h++) trk.addMeasurementIndex(h);
+      trk.addTrackState(fit.target);
+      trk.addTrackState(fit.ecal);
+      events[e].push_back(trk);
+    }
+  }
+}
+
+/// Read the tracks with the accessors the way TrackingRecoDQM does, and
+/// sum what is read so that nothing is optimized away
+template <typename track_t>
+double read(const std::vector<std::vector<track_t>>& events) {
+  double sum = 0.;
+  for (const auto& tracks : events) {
+    for (const auto& track : tracks) {
+      double trk_d0 = track.getD0();
+      double trk_z0 = track.getZ0();
+      double trk_qop = track.getQoP();
+      double trk_theta = track.getTheta();
+      double trk_phi = track.getPhi();
+      const auto& trk_mom = track.getMomentum();
+      double pt_bending =
+          std::sqrt(trk_mom[0] * trk_mom[0] + trk_mom[1] * trk_mom[1]);
+      double pt_beam =
+          std::sqrt(trk_mom[1] * trk_mom[1] + trk_mom[2] * trk_mom[2]);
+      Acts::BoundSymMatrix cov =
+          tracking::sim::utils::unpackCov(track.getPerigeeCov());
+      double sigmad0 = std::sqrt(cov(Acts::BoundIndices::eBoundLoc0,
+                                     Acts::BoundIndices::eBoundLoc0));
+      double sigmaqop = std::sqrt(cov(Acts::BoundIndices::eBoundQOverP,
+                                      Acts::BoundIndices::eBoundQOverP));
+      sum += trk_d0 + trk_z0 + trk_qop + trk_theta + trk_phi + pt_bending +
+             pt_beam + sigmad0 + sigmaqop + track.getChi2() / track.getNdf() +
+             track.getNhits() + track.getNsharedHits();
+    }
+  }
+  return sum;
+}
+
+/// Times of the steps for one layout, in ns per track
+struct Times {
+  double fill{1e30}, copy{1e30}, read{1e30};
+};
+
+/// Time the steps on the sample, keeping the fastest of the repetitions
+template <typename track_t>
+Times run(const std::vector<std::vector<FitResult>>& sample, int repeat,
+          double& sum) {
+  const double n_tracks = sample.size() * sample.front().size();
+  auto ns = [n_tracks](const Clock::time_point& start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+               .count() /
+           n_tracks;
+  };
+
+  Times times;
+  std::vector<std::vector<track_t>> events, copies;
+  for (int r = 0; r < repeat; r++) {
+    auto start = Clock::now();
+    fill(sample, events);
+    times.fill = std::min(times.fill, ns(start));
+
+    start = Clock::now();
+    copies = events;
+    times.copy = std::min(times.copy, ns(start));
+    copies.clear();
+
+    start = Clock::now();
+    sum = read(events);
+    times.read = std::min(times.read, ns(start));
+  }
+  return times;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int n_events = 10000, n_tracks = 10, repeat = 5;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--events") && has_value) {
+      n_events = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--tracks") && has_value) {
+      n_tracks = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--repeat") && has_value) {
+      repeat = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+      usage();
+      return 0;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (n_events < 1 || n_tracks < 1 || repeat < 1) {
+    usage();
+    return 1;
+  }
+
+  try {
+    const auto sample = makeSample(n_events, n_tracks);
+
+    double sum_vectors, sum_arrays;
+    Times vectors = run<TrackV1>(sample, repeat, sum_vectors);
+    Times arrays = run<ldmx::Track>(sample, repeat, sum_arrays);
+    if (sum_vectors != sum_arrays)
+      throw std::runtime_error("the two layouts read back different values");
+
+    std::cout << "events: " << n_events << "  tracks/event = " << n_tracks
+              << "  repetitions = " << repeat << std::endl
+              << "time per track [ns]   vectors (v1)   arrays (v2)   speedup"
+              << std::endl;
+    auto line = [](const char* step, double v1, double v2) {
+      std::cout << "  " << step << "   " << v1 << "   " << v2 << "   "
+                << v1 / v2 << std::endl;
+    };
+    line("fill", vectors.fill, arrays.fill);
+    line("copy", vectors.copy, arrays.copy);
+    line("read", vectors.read, arrays.read);
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file convert_fieldmap.cxx
+ * Convert an ASCII magnetic field map to the binary format read by
+ * loadDefaultBField.
+ *
+ * By default the binary map is written next to the ASCII one, where it is
+ * picked up automatically as a cache by loadDefaultBField.
+ */
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+static void usage() {
+  std::cout << "Usage: ldmx-convert-fieldmap [--float] {input.dat} [output]\n"
+            << "  Convert the ASCII field map {input.dat} to the binary format.\n"
+            << "  The output defaults to {input.dat}.bin, the cache location\n"
+            << "  looked up by loadDefaultBField.\n"
+            << "  --float : store the field values in single precision\n"
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool single_precision = false;
+  std::string input, output;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--float")) {
+      single_precision = true;
+    } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+      usage();
+      return 0;
+    } else if (input.empty()) {
+      input = argv[i];
+    } else if (output.empty()) {
+      output = argv[i];
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (input.empty()) {
+    usage();
+    return 1;
+  }
+
+  if (output.empty()) output = tracking::sim::binaryFieldMapCachePath(input);
+
+  try {
+    convertFieldMapToBinary(input, output, 1. * Acts::UnitConstants::mm,
+                            1000. * Acts::UnitConstants::T, single_precision);
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  std::cout << "Wrote " << output << std::endl;
+  return 0;
+}
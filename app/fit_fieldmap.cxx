@@ -0,0 +1,75 @@
+/**
+ * @file fit_fieldmap.cxx
+ * Fit the region model of a magnetic field map used by the hybrid field.
+ *
+ * The map is split in boxes fitted with linear (or constant) models of the
+ * field until each model is within the tolerance of the interpolated map.
+ * The resulting model file is given to the MagneticFieldMapProvider.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "Tracking/Sim/BFieldRegionModel.h"
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+static void usage() {
+  std::cout
+      << "Usage: ldmx-fit-fieldmap [options] {input} {output}\n"
+      << "  Fit the region model of the field map {input} (ASCII or binary)\n"
+      << "  and write it to {output}.\n"
+      << "  --tolerance {T} : largest deviation of each field component from\n"
+      << "                    the map, in T (default 0.001)\n"
+      << "  --order {0|1}   : constant or linear models (default 1)\n"
+      << "  --min-cells {n} : don't split the regions below n cells along an\n"
+      << "                    axis (default 2)\n"
+      << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  tracking::sim::BFieldRegionModel::Config cfg;
+  std::string input, output;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+      usage();
+      return 0;
+    } else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc) {
+      cfg.tolerance = std::atof(argv[++i]) * Acts::UnitConstants::T;
+    } else if (!strcmp(argv[i], "--order") && i + 1 < argc) {
+      cfg.order = std::atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--min-cells") && i + 1 < argc) {
+      cfg.min_cells = std::atoi(argv[++i]);
+    } else if (input.empty()) {
+      input = argv[i];
+    } else if (output.empty()) {
+      output = argv[i];
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (input.empty() || output.empty() || !(cfg.tolerance > 0.)) {
+    usage();
+    return 1;
+  }
+
+  try {
+    auto grid = loadDefaultBFieldGrid(input);
+    auto model = tracking::sim::BFieldRegionModel::fit(grid, cfg);
+    model.write(output);
+
+    std::cout << "Wrote " << output << ": " << model.regions().size()
+              << " regions covering " << 100. * model.coverage()
+              << "% of the map" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -71,7 +71,7 @@ public:
    *
    * @return[out] A std::vector of 16 bit samples.
    */
-  std::vector<short> getSamples() const { return samples_; }
+  const std::vector<short>& getSamples() const { return samples_; }
 
   /**
    * Get the time stamp of this hit.
@@ -85,6 +85,23 @@ public:
    */
   long getTime() const { return time_; }
 
+  /**
+   * Set the sensor and the strip of this hit.
+   *
+   * @param[in] sensor_id The ID of the sensor, as the layer ID of the sim
+   *    hits.
+   * @param[in] strip The strip of the sensor, counted along the local u
+   *    axis.
+   */
+  void setSensorID(int sensor_id) { sensor_id_ = sensor_id; }
+  void setStrip(int strip) { strip_ = strip; }
+
+  /// @return[out] The ID of the sensor of this hit.
+  int getSensorID() const { return sensor_id_; }
+
+  /// @return[out] The strip of this hit.
+  int getStrip() const { return strip_; }
+
   /**
    * When the less than operator is used for comparison, return true if this
    * hit's time is less than the hit we are comparing against.
@@ -119,8 +136,15 @@ protected:
   /// The hit time stamp in units of ns.
   long time_{0};
 
+  /// The ID of the sensor
+  int sensor_id_{0};
+
+  /// The strip of the sensor
+  int strip_{0};
+
   /// Class declaration needed by the ROOT dictionary.
-  ClassDef(RawSiStripHit, 1);
+  /// Version 2: sensor ID and strip
+  ClassDef(RawSiStripHit, 2);
 
 }; // RawSiStripHit
 } // namespace ldmx
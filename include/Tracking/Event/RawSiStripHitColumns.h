@@ -0,0 +1,130 @@
+#pragma once
+
+//~~ StdLib ~~//
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "Tracking/Event/RawSiStripHit.h"
+
+//~~ ROOT ~~//
+#include "TObject.h"  // Needed for ClassDef, ClassImp
+
+namespace ldmx {
+
+/**
+ * A collection of raw strip hits stored by column.
+ *
+ * The ADC samples of all the hits are packed back to back in one buffer,
+ * with the offset of the first sample of each hit, and the sensor, strip and
+ * time of the hits are one column each. An event is then a few large arrays
+ * instead of one vector of samples per strip, which is faster to write and
+ * read and compresses better. The samples of a hit are accessed in place.
+ *
+ * The collection is built from and converted back to ldmx::RawSiStripHit.
+ */
+class RawSiStripHitColumns {
+ public:
+  /// Default constructor
+  RawSiStripHitColumns() = default;
+
+  /**
+   * Constructor from a hit collection.
+   *
+   * @param hits The hits to store.
+   */
+  explicit RawSiStripHitColumns(const std::vector<RawSiStripHit>& hits);
+
+  /// Default destructor
+  virtual ~RawSiStripHitColumns() = default;
+
+  /// Remove all hits
+  void Clear();
+
+  /// Print the number of hits
+  void Print() const;
+
+  /**
+   * Reserve the memory of a number of hits.
+   *
+   * @param n_hits The number of hits.
+   * @param n_samples The total number of samples of the hits.
+   */
+  void reserve(std::size_t n_hits, std::size_t n_samples);
+
+  /**
+   * Add a hit at the end of the collection.
+   *
+   * @param hit The hit to add.
+   */
+  void push_back(const RawSiStripHit& hit);
+
+  /**
+   * Add a hit at the end of the collection.
+   *
+   * @param sensor_id The ID of the sensor of the hit.
+   * @param strip The strip of the hit.
+   * @param time The timestamp of the hit in ns.
+   * @param samples The ADC samples of the hit.
+   * @param n_samples The number of samples.
+   */
+  void push_back(int sensor_id, int strip, long time, const short* samples,
+                 std::size_t n_samples);
+
+  /// @return The number of hits.
+  [[nodiscard]] std::size_t size() const { return time_.size(); }
+
+  /**
+   * @param i Index of the hit.
+   * @return A copy of the hit as an ldmx::RawSiStripHit.
+   */
+  [[nodiscard]] RawSiStripHit getHit(std::size_t i) const;
+
+  /// @return A copy of all the hits as ldmx::RawSiStripHit.
+  [[nodiscard]] std::vector<RawSiStripHit> getHits() const;
+
+  //--- Per hit ---//
+
+  [[nodiscard]] int getSensorID(std::size_t i) const { return sensor_id_[i]; }
+  [[nodiscard]] int getStrip(std::size_t i) const { return strip_[i]; }
+  [[nodiscard]] long getTime(std::size_t i) const { return time_[i]; }
+
+  /// @return The number of samples of hit i.
+  [[nodiscard]] std::size_t getNSamples(std::size_t i) const {
+    return sample_offsets_[i + 1] - sample_offsets_[i];
+  }
+
+  /// @return The getNSamples(i) samples of hit i.
+  [[nodiscard]] const short* getSamples(std::size_t i) const {
+    return samples_.data() + sample_offsets_[i];
+  }
+
+  //--- Columns ---//
+
+  [[nodiscard]] const std::vector<int>& getSensorIDs() const {
+    return sensor_id_;
+  }
+  [[nodiscard]] const std::vector<int>& getStrips() const { return strip_; }
+  [[nodiscard]] const std::vector<long>& getTimes() const { return time_; }
+  [[nodiscard]] const std::vector<short>& getSamples() const {
+    return samples_;
+  }
+
+  friend std::ostream& operator<<(std::ostream& output,
+                                  const RawSiStripHitColumns& hits);
+
+ private:
+  std::vector<int> sensor_id_;
+  std::vector<int> strip_;
+  std::vector<long> time_;
+
+  /// Samples of all hits, those of hit i start at sample_offsets_[i]. There
+  /// is one more offset than hits.
+  std::vector<unsigned int> sample_offsets_{0};
+  std::vector<short> samples_;
+
+  /// Class declaration needed by the ROOT dictionary.
+  ClassDef(RawSiStripHitColumns, 1);
+
+};  // RawSiStripHitColumns
+}  // namespace ldmx
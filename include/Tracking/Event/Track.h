@@ -5,6 +5,8 @@
 //----------------------//
 //   C++ Standard Lib   //
 //----------------------//
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <vector>
 
@@ -118,7 +120,7 @@ class Track {
   
   //Add measurement to track
   void addMeasurementIndex(unsigned int measIdx) {meas_idxs_.push_back(measIdx);}
-  std::vector<unsigned int> getMeasurementsIdxs() const{return meas_idxs_;} 
+  const std::vector<unsigned int>& getMeasurementsIdxs() const {return meas_idxs_;}
   
   ///d_0 z_0 phi_0 theta q/p t
   //void setPerigeeParameters(const Acts::BoundVector& par)  {perigee_pars_ = par; }
@@ -132,15 +134,17 @@ class Track {
   //  perigee_cov_  = cov;
   //}
 
-  //Vector representation
-  void setPerigeeParameters(const std::vector<double>& par) {perigee_pars_ = par;}
-  std::vector<double>  getPerigeeParameters() const {return perigee_pars_;}
+  //Vector representation. Missing elements are set to 0, extra ones ignored
+  void setPerigeeParameters(const std::vector<double>& par) {copy(par, perigee_pars_);}
+  void setPerigeeParameters(const std::array<double, 6>& par) {perigee_pars_ = par;}
+  const std::array<double, 6>& getPerigeeParameters() const {return perigee_pars_;}
 
-  void setPerigeeCov(const std::vector<double>& cov) {perigee_cov_ = cov;}
-  std::vector<double> getPerigeeCov() const {return perigee_cov_;}
+  void setPerigeeCov(const std::vector<double>& cov) {copy(cov, perigee_cov_);}
+  void setPerigeeCov(const std::array<double, 21>& cov) {perigee_cov_ = cov;}
+  const std::array<double, 21>& getPerigeeCov() const {return perigee_cov_;}
 
   void setPerigeeLocation(const std::vector<double>& perigee) {
-    perigee_ = perigee;
+    copy(perigee, perigee_);
   }
   
   void setPerigeeLocation(const double& x, const double& y, const double& z) {
@@ -162,13 +166,13 @@ class Track {
     position_[2] = z;
   }
 
-  std::vector<double> getPerigeeLocation() const {return perigee_;};
+  const std::array<double, 3>& getPerigeeLocation() const {return perigee_;};
   double getPerigeeX() const {return perigee_[0];};
   double getPerigeeY() const {return perigee_[1];};
   double getPerigeeZ() const {return perigee_[2];};
   
-  std::vector<double> getMomentum() const {return momentum_;};
-  std::vector<double> getPosition() const {return position_;};
+  const std::array<double, 3>& getMomentum() const {return momentum_;};
+  const std::array<double, 3>& getPosition() const {return position_;};
     
   //getters -- TODO use an enum instead
   
@@ -183,7 +187,16 @@ class Track {
     trackStates_.push_back(ts);
   };
 
-  std::vector<TrackState> getTrackStates() const {return trackStates_; }
+  const std::vector<TrackState>& getTrackStates() const {return trackStates_; }
+
+  /// Copy a vector into a fixed size array, padding with zeros. Also used
+  /// by the I/O rules reading the version 1 of the class.
+  template <std::size_t N>
+  static void copy(const std::vector<double>& v, std::array<double, N>& a) {
+    std::size_t n = std::min(v.size(), N);
+    std::copy_n(v.begin(), n, a.begin());
+    std::fill(a.begin() + n, a.end(), 0.);
+  }
   
  protected:
     
@@ -205,7 +218,7 @@ class Track {
   
   //6 elements
   //d0 / z0 / phi / theta / qop / t
-  std::vector<double> perigee_pars_{0.,0.,0.,0.,0.,0.};
+  std::array<double, 6> perigee_pars_{0.,0.,0.,0.,0.,0.};
 
   //21 elements
   //d0d0 d0z0 d0phi d0th  d0qop  d0t
@@ -214,16 +227,16 @@ class Track {
   //                 thth thqop  tht
   //                      qopqop qopt
   //                             t
-  std::vector<double> perigee_cov_;
+  std::array<double, 21> perigee_cov_{};
   
   //The perigee location
-  std::vector<double> perigee_{0.,0.,0.};
+  std::array<double, 3> perigee_{0.,0.,0.};
 
   //The 3-momentum at the perigee
-  std::vector<double> momentum_{0.,0.,0.};
+  std::array<double, 3> momentum_{0.,0.,0.};
 
   //The 3-position at the perigee
-  std::vector<double> position_{0.,0.,0.};
+  std::array<double, 3> position_{0.,0.,0.};
 
   //The vector of measurement IDs
   std::vector<unsigned int> meas_idxs_{};
@@ -241,9 +254,30 @@ class Track {
   std::vector<TrackState> trackStates_;
   
   ///Class declaration needed by the ROOT dictionary.
-  ClassDef(Track, 1);
+  ///Version 2: fixed size arrays instead of vectors for the perigee
+  ///parameters, covariance, location, momentum and position
+  ClassDef(Track, 2);
     
 }; //Track
 }//namespace ldmx
+
+// Read the vectors of the version 1 of Track into the arrays
+#ifdef __ROOTCLING__
+#pragma read sourceClass="ldmx::Track" targetClass="ldmx::Track" version="[1]" \
+  source="std::vector<double> perigee_pars_" target="perigee_pars_" \
+  code="{ ldmx::Track::copy(onfile.perigee_pars_, perigee_pars_); }"
+#pragma read sourceClass="ldmx::Track" targetClass="ldmx::Track" version="[1]" \
+  source="std::vector<double> perigee_cov_" target="perigee_cov_" \
+  code="{ ldmx::Track::copy(onfile.perigee_cov_, perigee_cov_); }"
+#pragma read sourceClass="ldmx::Track" targetClass="ldmx::Track" version="[1]" \
+  source="std::vector<double> perigee_" target="perigee_" \
+  code="{ ldmx::Track::copy(onfile.perigee_, perigee_); }"
+#pragma read sourceClass="ldmx::Track" targetClass="ldmx::Track" version="[1]" \
+  source="std::vector<double> momentum_" target="momentum_" \
+  code="{ ldmx::Track::copy(onfile.momentum_, momentum_); }"
+#pragma read sourceClass="ldmx::Track" targetClass="ldmx::Track" version="[1]" \
+  source="std::vector<double> position_" target="position_" \
+  code="{ ldmx::Track::copy(onfile.position_, position_); }"
+#endif
   
 #endif // TRACKING_EVENT_TRACK_H_
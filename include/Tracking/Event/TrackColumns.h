@@ -0,0 +1,189 @@
+#pragma once
+
+//~~ StdLib ~~//
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "Tracking/Event/Track.h"
+
+//~~ ROOT ~~//
+#include "TObject.h"  // Needed for ClassDef, ClassImp
+
+namespace ldmx {
+
+/**
+ * A collection of tracks stored by column.
+ *
+ * Each quantity of the tracks is a column with one entry per track, so a
+ * collection is written as a few large arrays instead of several small
+ * vectors per track, which is faster to write and read and compresses
+ * better. The perigee parameters and covariance have a fixed number of
+ * entries per track. The measurement indices and the track states of all
+ * tracks are stored back to back, with the offset of the first one of each
+ * track.
+ *
+ * The collection is built from and converted back to ldmx::Track, and can be
+ * added to the event next to the Track collection it was built from.
+ */
+class TrackColumns {
+ public:
+  /// Perigee parameters per track: d0 / z0 / phi / theta / qop / t
+  static constexpr std::size_t kNParameters = 6;
+  /// Upper triangle of the covariance of the parameters, per track
+  static constexpr std::size_t kNCovariance = 21;
+
+  /// Default constructor
+  TrackColumns() = default;
+
+  /**
+   * Constructor from a track collection.
+   *
+   * @param tracks The tracks to store.
+   */
+  explicit TrackColumns(const std::vector<Track>& tracks);
+
+  /// Default destructor
+  virtual ~TrackColumns() = default;
+
+  /// Remove all tracks
+  void Clear();
+
+  /// Print the number of tracks
+  void Print() const;
+
+  /**
+   * Add a track at the end of the collection.
+   *
+   * Parameters and covariances with fewer entries than expected, as the
+   * covariance of a track that doesn't have one, are padded with zeros.
+   *
+   * @param track The track to add.
+   */
+  void push_back(const Track& track);
+
+  /// @return The number of tracks.
+  [[nodiscard]] std::size_t size() const { return chi2_.size(); }
+
+  /**
+   * @param i Index of the track.
+   * @return A copy of the track as an ldmx::Track.
+   */
+  [[nodiscard]] Track getTrack(std::size_t i) const;
+
+  /// @return A copy of all the tracks as ldmx::Track.
+  [[nodiscard]] std::vector<Track> getTracks() const;
+
+  //--- Per track ---//
+
+  [[nodiscard]] int getNhits(std::size_t i) const { return n_hits_[i]; }
+  [[nodiscard]] int getNoutliers(std::size_t i) const { return n_outliers_[i]; }
+  [[nodiscard]] int getNdf(std::size_t i) const { return ndf_[i]; }
+  [[nodiscard]] int getNsharedHits(std::size_t i) const {
+    return n_shared_hits_[i];
+  }
+  [[nodiscard]] double getChi2(std::size_t i) const { return chi2_[i]; }
+  [[nodiscard]] int getTrackID(std::size_t i) const { return track_id_[i]; }
+  [[nodiscard]] double getTruthProb(std::size_t i) const {
+    return truth_prob_[i];
+  }
+  [[nodiscard]] int getPdgID(std::size_t i) const { return pdg_id_[i]; }
+
+  /// @return The kNParameters perigee parameters of track i.
+  [[nodiscard]] const double* getPerigeeParameters(std::size_t i) const {
+    return perigee_pars_.data() + i * kNParameters;
+  }
+
+  /// @return The kNCovariance covariance terms of track i.
+  [[nodiscard]] const double* getPerigeeCov(std::size_t i) const {
+    return perigee_cov_.data() + i * kNCovariance;
+  }
+
+  /// @return The perigee location, position and momentum of track i.
+  [[nodiscard]] const double* getPerigeeLocation(std::size_t i) const {
+    return perigee_.data() + 3 * i;
+  }
+  [[nodiscard]] const double* getPosition(std::size_t i) const {
+    return position_.data() + 3 * i;
+  }
+  [[nodiscard]] const double* getMomentum(std::size_t i) const {
+    return momentum_.data() + 3 * i;
+  }
+
+  /// @return The number of measurements of track i.
+  [[nodiscard]] std::size_t getNMeasurements(std::size_t i) const {
+    return meas_offsets_[i + 1] - meas_offsets_[i];
+  }
+
+  /// @return The getNMeasurements(i) measurement indices of track i.
+  [[nodiscard]] const unsigned int* getMeasurementsIdxs(std::size_t i) const {
+    return meas_idxs_.data() + meas_offsets_[i];
+  }
+
+  /// @return The number of track states of track i.
+  [[nodiscard]] std::size_t getNTrackStates(std::size_t i) const {
+    return state_offsets_[i + 1] - state_offsets_[i];
+  }
+
+  /**
+   * @param i Index of the track.
+   * @param j Index of the track state within the track.
+   * @return A copy of the track state as an ldmx::Track::TrackState.
+   */
+  [[nodiscard]] Track::TrackState getTrackState(std::size_t i,
+                                                std::size_t j) const;
+
+  //--- Columns ---//
+
+  [[nodiscard]] const std::vector<double>& getChi2() const { return chi2_; }
+  [[nodiscard]] const std::vector<int>& getNdf() const { return ndf_; }
+  [[nodiscard]] const std::vector<int>& getNhits() const { return n_hits_; }
+  [[nodiscard]] const std::vector<double>& getPerigeeParameters() const {
+    return perigee_pars_;
+  }
+  [[nodiscard]] const std::vector<double>& getPerigeeCov() const {
+    return perigee_cov_;
+  }
+
+  friend std::ostream& operator<<(std::ostream& output,
+                                  const TrackColumns& tracks);
+
+ private:
+  std::vector<int> n_hits_;
+  std::vector<int> n_outliers_;
+  std::vector<int> ndf_;
+  std::vector<int> n_shared_hits_;
+  std::vector<double> chi2_;
+  std::vector<int> track_id_;
+  std::vector<double> truth_prob_;
+  std::vector<int> pdg_id_;
+
+  /// kNParameters and kNCovariance entries per track
+  std::vector<double> perigee_pars_;
+  std::vector<double> perigee_cov_;
+
+  /// 3 entries per track
+  std::vector<double> perigee_;
+  std::vector<double> position_;
+  std::vector<double> momentum_;
+
+  /// Measurement indices of all tracks, those of track i start at
+  /// meas_offsets_[i]. There is one more offset than tracks.
+  std::vector<unsigned int> meas_offsets_{0};
+  std::vector<unsigned int> meas_idxs_;
+
+  /// Track states of all tracks, those of track i start at
+  /// state_offsets_[i]. There is one more offset than tracks.
+  std::vector<unsigned int> state_offsets_{0};
+  /// 3 entries per state
+  std::vector<double> state_ref_;
+  /// kNParameters and kNCovariance entries per state
+  std::vector<double> state_params_;
+  std::vector<double> state_cov_;
+  std::vector<int> state_type_;
+
+  /// Class declaration needed by the ROOT dictionary.
+  ClassDef(TrackColumns, 1);
+
+};  // TrackColumns
+}  // namespace ldmx
@@ -102,7 +102,9 @@ class TruthTrack {
   void setPerigeeParameters(const std::vector<double>& par) {
     perigee_pars_ = par;
   }
-  std::vector<double> getPerigeeParameters() const { return perigee_pars_; }
+  const std::vector<double>& getPerigeeParameters() const {
+    return perigee_pars_;
+  }
 
   void setPerigeeLocation(const std::vector<double>& perigee) {
     perigee_ = perigee;
@@ -126,13 +128,13 @@ class TruthTrack {
     position_[2] = z;
   }
 
-  std::vector<double> getPerigeeLocation() const { return perigee_; };
+  const std::vector<double>& getPerigeeLocation() const { return perigee_; };
   double getPerigeeX() const { return perigee_[0]; };
   double getPerigeeY() const { return perigee_[1]; };
   double getPerigeeZ() const { return perigee_[2]; };
 
-  std::vector<double> getMomentum() const { return momentum_; };
-  std::vector<double> getPosition() const { return position_; };
+  const std::vector<double>& getMomentum() const { return momentum_; };
+  const std::vector<double>& getPosition() const { return position_; };
 
   // getters -- TODO use an enum instead
 
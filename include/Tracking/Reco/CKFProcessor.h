@@ -10,9 +10,12 @@
 #include "Tracking/Sim/PropagatorStepWriter.h"
 
 //--- C++ ---//
-#include <random>
 #include <memory>
 
+//--- ROOT ---//
+#include "TFile.h"
+#include "TTree.h"
+
 //--- LDMX ---//
 #include "Tracking/Reco/TrackingGeometryUser.h"
 
@@ -78,10 +81,15 @@
 //--- Tracking ---//
 #include "Tracking/Sim/TrackingUtils.h"
 #include "Tracking/Sim/IndexSourceLink.h"
+#include "Tracking/Sim/SurfaceSourceLinks.h"
+#include "Tracking/Sim/HitMask.h"
 #include "Tracking/Sim/MeasurementCalibrator.h"
 #include "Tracking/Event/Track.h"
+#include "Tracking/Event/TrackColumns.h"
 #include "Tracking/Event/Measurement.h"
 #include "Tracking/Reco/TrackExtrapolatorTool.h"
+#include "Tracking/Reco/TelescopeNavigator.h"
+#include "Tracking/Sim/PropagationStatistics.h"
 
 
 //--- Interpolated magnetic field ---//
@@ -90,7 +98,13 @@
 using ActionList = Acts::ActionList<Acts::detail::SteppingLogger, Acts::MaterialInteractor>;
 using AbortList = Acts::AbortList<Acts::EndOfWorldReached>;
 
-using CkfPropagator = Acts::Propagator<Acts::EigenStepper<>, Acts::Navigator>;
+//The navigators count the steps of the propagations and set the adaptive
+//step size, see tracking::sim::InstrumentedNavigator
+using CkfPropagator = Acts::Propagator<
+    Acts::EigenStepper<>, tracking::sim::InstrumentedNavigator<Acts::Navigator>>;
+using TelescopePropagator = Acts::Propagator<
+    Acts::EigenStepper<>,
+    tracking::sim::InstrumentedNavigator<tracking::reco::TelescopeNavigator>>;
 using GsfPropagator = Acts::Propagator<
                         Acts::MultiEigenStepperLoop<
                           Acts::StepperExtensionList<
@@ -121,9 +135,9 @@ class CKFProcessor final : public TrackingGeometryUser {
   ~CKFProcessor();
   
   /**
-   *
+   * Open the ntuple of the step statistics, if one is requested.
    */
-void onProcessStart() override {};
+  void onProcessStart() override;
 
   /**
    * onNewRun is the first function called for each processor
@@ -162,12 +176,43 @@ void onProcessStart() override {};
   //Forms the layer to acts map
   auto makeLayerSurfacesMap(std::shared_ptr<const Acts::TrackingGeometry> trackingGeometry) const -> std::unordered_map<unsigned int, const Acts::Surface*>;
 
-  //Make geoid -> source link map Measurements
-  auto makeGeoIdSourceLinkMap(
-      const geo::TrackersTrackingGeometry& tg,
-      const std::vector<ldmx::Measurement > &ldmxsps) -> std::unordered_multimap<Acts::GeometryIdentifier, ActsExamples::IndexSourceLink>;
-    
-    
+  //Iterator over the source links of a surface, as needed by the CKF
+  struct SourceLinkAccIt {
+    using BaseIt = tracking::sim::SurfaceSourceLinks::Iterator;
+    BaseIt it;
+
+    using difference_type = typename BaseIt::difference_type;
+    using iterator_category = typename BaseIt::iterator_category;
+    using value_type = Acts::SourceLink;
+    using pointer = typename BaseIt::pointer;
+    using reference = value_type&;
+
+    SourceLinkAccIt& operator++() {
+      ++it;
+      return *this;
+    }
+    bool operator==(const SourceLinkAccIt& other) const {
+      return it == other.it;
+    }
+    bool operator!=(const SourceLinkAccIt& other) const {
+      return !(*this == other);
+    }
+
+    //by value
+    value_type operator*() const { return value_type{*it}; }
+  };
+
+  //Source link accessor of the CKF. It is connected once and pointed to the
+  //source links of the current event in produce
+  struct SourceLinkAccessor {
+    const tracking::sim::SurfaceSourceLinks* container{nullptr};
+
+    std::pair<SourceLinkAccIt, SourceLinkAccIt> operator()(const Acts::Surface& surface) const {
+      auto [begin, end] = container->range(surface);
+      return {SourceLinkAccIt{begin}, SourceLinkAccIt{end}};
+    }
+  };
+
   //Test the magnetic field
 
   void testField(const std::shared_ptr<Acts::MagneticFieldProvider> bField,
@@ -201,15 +246,16 @@ void onProcessStart() override {};
   bool debug_{false};
 
 
-  //--- Smearing ---//
-
-  std::default_random_engine generator_;
-  std::shared_ptr<std::normal_distribution<float>> normal_;
-
   //Constant BField
   double bfield_{0};
   //Use constant bfield
   bool const_b_field_{true};
+  //Use the region model of the map where available, the map elsewhere
+  bool hybrid_b_field_{false};
+
+  //Navigate the trackers as a sequence of planes instead of with the
+  //general Acts navigator
+  bool telescope_navigator_{false};
 
   //Remove stereo measurements
   bool remove_stereo_{false};
@@ -219,10 +265,32 @@ void onProcessStart() override {};
   
   //Minimum number of hits on tracks
   int min_hits_{7};
+
+  //Number of threads running the CKF on the seeds of an event
+  int n_threads_{1};
+
+  //Track collections of the previous passes. The hits of their good tracks
+  //are not used in this pass
+  std::vector<std::string> used_hit_tracks_{};
+  //The hits used by the previous passes in the current event
+  tracking::sim::HitMask hit_mask_;
   
   //Stepping size (in mm)
   double propagator_step_size_{200.};
   int propagator_maxSteps_{1000};
+
+  //Limit the step size in each region of the field map from the gradient
+  //of the field, up to propagator_step_size_
+  bool adaptive_step_size_{false};
+  //Largest change of the field over a step (in T)
+  double adaptive_step_field_tolerance_{0.05};
+  //Smallest step size limit (in mm)
+  double adaptive_step_min_{5.};
+
+  //Count the steps and the field evaluations of the CKF for each seed
+  bool step_statistics_{false};
+  //Ntuple of the counters of each seed, not written if empty
+  std::string step_statistics_file_{""};
   
   //The extrapolation surface
   bool use_extrapolate_location_{true};
@@ -243,6 +311,9 @@ void onProcessStart() override {};
   //The output track collection
   std::string out_trk_collection_{"Tracks"};
 
+  //Also add the tracks by column, as out_trk_collection_ + "Columns"
+  bool columnar_output_{false};
+
   //Select the hits using TrackID and pdg_id__
   
   int track_id_{-1};
@@ -255,9 +326,6 @@ void onProcessStart() override {};
   //The seed track collection
   std::string seed_coll_name_{"seedTracks"};
 
-  //The interpolated bfield
-  std::string field_map_{""};
-
   //The Propagators
   std::unique_ptr<const CkfPropagator> propagator_;
 
@@ -270,6 +338,44 @@ void onProcessStart() override {};
   //Track Extrapolator Tool
   std::shared_ptr<tracking::reco::TrackExtrapolatorTool<CkfPropagator>> trk_extrap_ ;
 
+  //The CKF and the extrapolator with the telescope navigator, only built
+  //if it is used
+  std::unique_ptr<const TelescopePropagator> telescope_propagator_;
+  std::unique_ptr<const Acts::CombinatorialKalmanFilter<TelescopePropagator,Acts::VectorMultiTrajectory>> telescope_ckf_;
+  std::shared_ptr<tracking::reco::TrackExtrapolatorTool<TelescopePropagator>> telescope_trk_extrap_;
+
+  //--- CKF context, built once in onNewRun ---//
+  //Only the calibrator and the source link accessor are rebound every event
+
+  Acts::GainMatrixUpdater kf_updater_;
+  Acts::GainMatrixSmoother kf_smoother_;
+  std::unique_ptr<Acts::MeasurementSelector> meas_sel_;
+
+  //Local positions and covariances of the measurements of the current event
+  tracking::sim::MeasurementCalibrationView calibration_view_;
+  //Points to the calibration view of the current event
+  tracking::sim::LdmxMeasurementCalibrator calibrator_;
+  //Source links of the current event, grouped by surface. The surface
+  //table is built in onNewRun and the memory is reused between events
+  tracking::sim::SurfaceSourceLinks source_links_;
+  //Points to the source links of the current event
+  SourceLinkAccessor source_link_accessor_;
+
+  std::unique_ptr<Acts::CombinatorialKalmanFilterOptions<SourceLinkAccIt,Acts::VectorMultiTrajectory>> ckf_options_;
+
+  //Perigee surfaces for the track parameters
+  std::shared_ptr<const Acts::PerigeeSurface> origin_surface_;
+  std::shared_ptr<const Acts::PerigeeSurface> tgt_surface_;
+  //Rebuilt every event from the first seed if use_seed_perigee_
+  std::shared_ptr<const Acts::PerigeeSurface> seed_surface_;
+
+  //Unbounded surfaces for the extrapolations to the target and the ecal
+  std::shared_ptr<Acts::Surface> target_surface_;
+  std::shared_ptr<Acts::Surface> ecal_surface_;
+  //The surfaces above and the types of the track states on them
+  std::vector<std::pair<std::shared_ptr<Acts::Surface>, ldmx::TrackStateType>>
+      extrapolation_targets_;
+
   //The GSF Fitter
   //std::unique_ptr<const Acts::GaussianSumFitter<GsfPropagator>> gsf_;
   
@@ -287,6 +393,19 @@ void onProcessStart() override {};
   int nseeds_{0};
   int ntracks_{0};
 
+  //--- Step statistics ---//
+  //Totals over the seeds and largest number of steps of a seed
+  tracking::sim::PropagationCounters step_totals_;
+  std::uint64_t max_seed_steps_{0};
+  //Ntuple with one entry per event with seeds, one element per seed
+  TFile* step_statistics_outfile_{nullptr};
+  TTree* step_statistics_tree_{nullptr};
+  std::vector<unsigned long> seed_steps_;
+  std::vector<unsigned long> seed_accuracy_limited_steps_;
+  std::vector<unsigned long> seed_field_evaluations_;
+  std::vector<unsigned long> seed_surfaces_;
+  std::vector<double> seed_time_;
+
   int eventnr_{0};
 
   //BField Systematics
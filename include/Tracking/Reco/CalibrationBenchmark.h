@@ -0,0 +1,69 @@
+#pragma once
+
+//--- Framework ---//
+#include "Framework/Configure/Parameters.h"
+#include "Framework/EventProcessor.h"
+
+//--- Tracking ---//
+#include "Tracking/Event/Measurement.h"
+#include "Tracking/Sim/MeasurementCalibrator.h"
+
+//--- C++ ---//
+#include <string>
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Micro-benchmark of the measurement calibration used by the CKF.
+ *
+ * For each event, all the measurements are calibrated on fresh track states
+ * with the previous calibration, which copied the ldmx::Measurement on every
+ * call, and with the LdmxMeasurementCalibrator reading the per-event
+ * calibration view, including the time to fill the view. The calibrated
+ * values of the two are compared and the calibrations per second are
+ * reported at the end of the processing. Nothing is added to the event.
+ */
+class CalibrationBenchmark : public framework::Producer {
+ public:
+  CalibrationBenchmark(const std::string& name, framework::Process& process);
+  ~CalibrationBenchmark() = default;
+
+  void configure(framework::config::Parameters& parameters) final override;
+
+  void produce(framework::Event& event) final override;
+
+  void onProcessEnd() final override;
+
+ private:
+  /**
+   * Time the calibration of all the measurements of an event
+   *
+   * @param[in] calibrator the calibrator to benchmark
+   * @param[in] n_measurements the number of measurements of the event
+   * @param[out] values the calibrated local position of each measurement
+   * @return the time spent in the calibrations in ms
+   */
+  template <typename calibrator_t>
+  double timeCalibrations(const calibrator_t& calibrator,
+                          std::size_t n_measurements,
+                          std::vector<double>& values) const;
+
+  /// The measurement collection to calibrate
+  std::string measurement_collection_{"TaggerMeasurements"};
+  /// Number of repetitions per event
+  int n_repeat_{10};
+  /// Benchmark the 1D calibration instead of the 2D one
+  bool use1Dmeasurements_{true};
+
+  /// The calibration view, reused between events
+  tracking::sim::MeasurementCalibrationView view_;
+
+  /// Totals over all the events
+  long n_calibrations_{0};
+  double copy_time_{0.};
+  double view_time_{0.};
+  double max_diff_{0.};
+};
+
+}  // namespace tracking::reco
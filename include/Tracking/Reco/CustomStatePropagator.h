@@ -20,7 +20,7 @@
 
 
 //--- Tracking ---//
-#include "Tracking/Sim/BFieldXYZUtils.h"
+#include "Tracking/Reco/TrackingGeometryUser.h"
 #include "Tracking/Sim/TrackingUtils.h"
 
 //--- C++ ---//
@@ -35,12 +35,13 @@ using AbortList = Acts::AbortList<Acts::EndOfWorldReached>;
 
 namespace tracking::reco{
   
-  class CustomStatePropagator : public framework::Producer {
+  class CustomStatePropagator : public TrackingGeometryUser {
  public:
     CustomStatePropagator(const std::string& name, framework::Process& process);
     ~CustomStatePropagator();
     
     void onProcessStart() final override;
+    void onNewRun(const ldmx::RunHeader& rh) final override;
     void onProcessEnd() final override;
     
     void configure(framework::config::Parameters& parameters) final override;
@@ -56,8 +57,6 @@ namespace tracking::reco{
     Acts::GeometryContext gctx_;
     Acts::MagneticFieldContext bctx_;
 
-    //The interpolated bfield
-    std::string field_map_{""};
     double surf_location_{0.};
     int nstates_{0};
     std::vector<double> bs_size_;
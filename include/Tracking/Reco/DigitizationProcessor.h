@@ -4,20 +4,24 @@
 
 //--- ACTS ---//
 #include "Acts/Definitions/Units.hpp"
-#include "Acts/Digitization/CartesianSegmentation.hpp"
-#include "Acts/Digitization/DigitizationModule.hpp"
-#include "Acts/Digitization/PlanarModuleStepper.hpp"
-#include "Acts/Surfaces/RectangleBounds.hpp"
 #include "Acts/Surfaces/Surface.hpp"
 
 //--- LDMX ---//
+#include "Tracking/Event/RawSiStripHit.h"
+#include "Tracking/Event/RawSiStripHitColumns.h"
+#include "Tracking/Sim/PhiloxRandom.h"
+#include "Tracking/Sim/Range.h"
+#include "Tracking/Sim/StripDigitizer.h"
 #include "Tracking/Sim/TrackingUtils.h"
 
 //--- ACTS ---//
 #include "Acts/Definitions/Units.hpp"
 
 //--- C++ ---//
-#include <random>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace ldmx {
 class Measurement;
@@ -32,6 +36,10 @@ class DigitizationProcessor : public TrackingGeometryUser {
 
   void onProcessStart() final override;
 
+  void onNewRun(const ldmx::RunHeader& rh) final override;
+
+  void onProcessEnd() final override;
+
   void configure(framework::config::Parameters& parameters) final override;
 
   void produce(framework::Event& event);
@@ -47,13 +55,50 @@ class DigitizationProcessor : public TrackingGeometryUser {
   std::vector<ldmx::Measurement> digitizeHits(
       const std::vector<ldmx::SimTrackerHit>& sim_hits);
 
-  // TODO avoid copies and use references
+  /**
+   * Digitize the strips of the sensors crossed by the sim hits: charge
+   * deposition, drift and sharing between strips, and pulse sampling. See
+   * tracking::sim::StripDigitizer.
+   *
+   * @param sim_hits The collection of SimTrackerHits to digitize.
+   * @param raw_hits The strips above threshold are appended to it.
+   */
+  void digitizeStrips(const std::vector<ldmx::SimTrackerHit>& sim_hits,
+                      std::vector<ldmx::RawSiStripHit>& raw_hits);
+  void digitizeStrips(const std::vector<ldmx::SimTrackerHit>& sim_hits,
+                      ldmx::RawSiStripHitColumns& raw_hits);
+
+  /// A sim hit to merge: its sensor, its track and its index in the
+  /// collection
+  struct HitKey {
+    int sensor;
+    int track;
+    std::size_t index;
+  };
+  /// Hits of the same sensor and track, in the order of the collection
+  using HitGroup = ActsExamples::Range<std::vector<HitKey>::const_iterator>;
+
+  /**
+   * Merge the sim hits left by the same track on the same sensor.
+   *
+   * The hit indices are sorted by sensor and track and the runs of equal
+   * keys are merged in one pass, so the hits are only read in place and
+   * copied once to the output.
+   *
+   * @param sim_hits The collection of SimTrackerHits to merge.
+   * @param merged_hits The merged hits are appended to it, ordered by
+   *    sensor and track.
+   */
   bool mergeSimHits(const std::vector<ldmx::SimTrackerHit>& sim_hits,
                     std::vector<ldmx::SimTrackerHit>& merged_hits);
-  bool mergeHits(const std::vector<ldmx::SimTrackerHit>& sihits,
-                 std::vector<ldmx::SimTrackerHit>& mergedHits);
+  bool mergeHits(const std::vector<ldmx::SimTrackerHit>& sim_hits,
+                 const HitGroup& group,
+                 std::vector<ldmx::SimTrackerHit>& merged_hits);
 
  private:
+  /// Deposit the energy of the sim hits in the strip digitizer
+  void depositStrips(const std::vector<ldmx::SimTrackerHit>& sim_hits);
+
   /// The path to the GDML description of the detector
   std::string detector_{""};
   /// Input hit collection to smear.
@@ -73,10 +118,40 @@ class DigitizationProcessor : public TrackingGeometryUser {
   /// v-direction sigma
   double sigma_v_{0};
 
-  //--- Smearing ---//
-
-  std::default_random_engine generator_;
-  std::shared_ptr<std::normal_distribution<float>> normal_;
+  //--- Strip digitization ---//
+
+  /// Also digitize the strips into RawSiStripHits
+  bool strip_digitization_{false};
+  /// Output raw hit collection name.
+  std::string raw_hit_collection_{"RawSiStripHits"};
+  /// Store the raw hits with their samples packed in one buffer
+  bool packed_raw_hits_{false};
+  /// Configuration of the strip digitizer
+  tracking::sim::StripDigitizer::Config strip_cfg_;
+  /// The strip digitizer, only built if it is used
+  std::unique_ptr<tracking::sim::StripDigitizer> strip_digitizer_;
+  /// Events, sim hits and raw hits of the strip digitization
+  long n_strip_events_{0};
+  long n_strip_sim_hits_{0};
+  long n_raw_hits_{0};
+  /// Time spent in the strip digitization, in ms
+  double strip_time_{0.};
+
+  //--- Random numbers ---//
+
+  /// Generators of the smearing and of the strip noise, keyed by the seeds
+  /// of the processor and the run
+  tracking::sim::PhiloxRandom smearing_random_;
+  tracking::sim::PhiloxRandom strip_random_;
+  /// Number of the event being digitized, in the counters of the random
+  /// numbers
+  int event_number_{0};
+  /// Counters and smearing of the hits of the event
+  std::vector<tracking::sim::PhiloxRandom::Counter> counters_;
+  std::vector<float> smearing_;
+
+  /// Hits to merge in the current event, the memory is reused between events
+  std::vector<HitKey> hit_keys_;
 
 };  // Digitization Processor
 }  // namespace tracking::reco
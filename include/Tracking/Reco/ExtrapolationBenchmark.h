@@ -0,0 +1,95 @@
+#pragma once
+
+//--- Framework ---//
+#include "Framework/Configure/Parameters.h"
+#include "Framework/EventProcessor.h"
+
+//--- ACTS ---//
+#include "Acts/EventData/TrackParameters.hpp"
+#include "Acts/Propagator/EigenStepper.hpp"
+#include "Acts/Propagator/Navigator.hpp"
+#include "Acts/Propagator/Propagator.hpp"
+#include "Acts/Surfaces/Surface.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Reco/TelescopeNavigator.h"
+#include "Tracking/Reco/TrackExtrapolatorTool.h"
+#include "Tracking/Reco/TrackingGeometryUser.h"
+#include "Tracking/Sim/PropagationStatistics.h"
+
+//--- C++ ---//
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Benchmark of the extrapolation of a track to several surfaces at once
+ * against its extrapolation to each surface on its own.
+ *
+ * The tracks of a collection are extrapolated from their perigee to planes
+ * along the beam, with the propagator of the CKF, in a single propagation
+ * with TrackExtrapolatorTool and with one propagation per plane. The time
+ * per track of both is reported at the end of the processing, together with
+ * the number of planes reached by only one of the two or at positions
+ * further apart than the tolerance. Nothing is added to the event.
+ */
+class ExtrapolationBenchmark : public TrackingGeometryUser {
+ public:
+  ExtrapolationBenchmark(const std::string& name, framework::Process& process);
+  ~ExtrapolationBenchmark() = default;
+
+  void onNewRun(const ldmx::RunHeader& rh) final override;
+
+  void configure(framework::config::Parameters& parameters) final override;
+
+  void produce(framework::Event& event) final override;
+
+  void onProcessEnd() final override;
+
+ private:
+  using GenericPropagator =
+      Acts::Propagator<Acts::EigenStepper<>,
+                       tracking::sim::InstrumentedNavigator<Acts::Navigator>>;
+  using TelescopePropagator = Acts::Propagator<
+      Acts::EigenStepper<>,
+      tracking::sim::InstrumentedNavigator<TelescopeNavigator>>;
+
+  /**
+   * Extrapolate a track to the planes both ways and compare
+   *
+   * @param[in] extrapolator the extrapolator to benchmark
+   * @param[in] start the parameters at the perigee
+   */
+  template <typename propagator_t>
+  void compare(TrackExtrapolatorTool<propagator_t>& extrapolator,
+               const Acts::BoundTrackParameters& start);
+
+  /// The tracks to extrapolate
+  std::string track_collection_{"RecoilTracks"};
+  /// Position along the beam of the planes
+  std::vector<double> planes_;
+  /// Largest distance between the two positions on a plane
+  double tolerance_{0.001};
+  /// Use the telescope navigator, as the CKF does with the same option
+  bool telescope_navigator_{false};
+
+  std::vector<std::shared_ptr<Acts::Surface>> surfaces_;
+  std::unique_ptr<TrackExtrapolatorTool<GenericPropagator>>
+      generic_extrapolator_;
+  std::unique_ptr<TrackExtrapolatorTool<TelescopePropagator>>
+      telescope_extrapolator_;
+
+  long n_tracks_{0};
+  /// Planes reached in a single propagation and on their own
+  long n_reached_single_pass_{0};
+  long n_reached_per_surface_{0};
+  /// Planes reached by only one of the two or at different positions
+  long n_mismatches_{0};
+  /// Time of the extrapolations in ms
+  double time_single_pass_{0.};
+  double time_per_surface_{0.};
+};
+
+}  // namespace tracking::reco
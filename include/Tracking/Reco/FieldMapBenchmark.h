@@ -0,0 +1,87 @@
+#pragma once
+
+//--- Framework ---//
+#include "Framework/Configure/Parameters.h"
+#include "Framework/EventProcessor.h"
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/MagneticField/MagneticFieldProvider.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Reco/TrackingGeometryUser.h"
+
+//--- C++ ---//
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Micro-benchmark of the interpolated magnetic field lookups.
+ *
+ * Compares the number of field lookups per second of the shared field map
+ * view from the conditions against the Acts::InterpolatedBFieldMap built with
+ * std::function transformations (loadDefaultBField), on the same set of
+ * random positions. The structure-of-arrays copies of the grid (double and
+ * float storage) are benchmarked as well, one position at a time and in
+ * batches. All the paths are compared value by value with the reference.
+ *
+ * If the field map provider has a region model the hybrid field is timed on
+ * the same positions, and its largest deviation from the map view is
+ * reported for each component on the positions covered by the model, with
+ * the number of them above the tolerance of the model. All the work is done
+ * once in onNewRun, no event is processed.
+ */
+class FieldMapBenchmark : public TrackingGeometryUser {
+ public:
+  FieldMapBenchmark(const std::string& name, framework::Process& process);
+  ~FieldMapBenchmark() = default;
+
+  void onNewRun(const ldmx::RunHeader& rh) final override;
+
+  void configure(framework::config::Parameters& parameters) final override;
+
+  void produce(framework::Event& event) final override {};
+
+ private:
+  /**
+   * Time the field lookups of a provider on the benchmark positions
+   *
+   * @param[in] field the field provider to benchmark
+   * @param[out] values the field at each position, zero if out of bounds
+   * @return the time spent in the lookups in ms
+   */
+  double timeLookups(const Acts::MagneticFieldProvider& field,
+                     std::vector<Acts::Vector3>& values);
+
+  /**
+   * Time the batched field lookups of a SoA map on the benchmark positions
+   *
+   * @param[in] field the SoA field map to benchmark
+   * @param[out] values the field at each position, zero if out of bounds
+   * @return the time spent in the lookups in ms
+   */
+  template <typename soa_map_t>
+  double timeBatchedLookups(const soa_map_t& field,
+                            std::vector<Acts::Vector3>& values);
+
+  /// @return the largest norm of the difference between two sets of values
+  double maxDifference(const std::vector<Acts::Vector3>& reference,
+                       const std::vector<Acts::Vector3>& values) const;
+
+  /// Path to the magnetic field map, for the std::function reference
+  std::string field_map_{""};
+  /// Number of lookups per benchmark
+  int n_lookups_{1000000};
+  /// Number of repetitions of each benchmark
+  int n_repeat_{5};
+  /// Ranges of the random positions, in the tracking frame [mm]
+  std::vector<double> x_range_;
+  std::vector<double> y_range_;
+  std::vector<double> z_range_;
+
+  /// The benchmark positions
+  std::vector<Acts::Vector3> positions_;
+};
+
+}  // namespace tracking::reco
@@ -0,0 +1,97 @@
+#pragma once
+
+//--- Framework ---//
+#include "Framework/Configure/Parameters.h"
+#include "Framework/EventProcessor.h"
+
+//--- ACTS ---//
+#include "Acts/EventData/TrackParameters.hpp"
+#include "Acts/Geometry/GeometryIdentifier.hpp"
+#include "Acts/Propagator/EigenStepper.hpp"
+#include "Acts/Propagator/Navigator.hpp"
+#include "Acts/Propagator/Propagator.hpp"
+#include "Acts/Surfaces/Surface.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Reco/TelescopeNavigator.h"
+#include "Tracking/Reco/TrackingGeometryUser.h"
+
+//--- C++ ---//
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Benchmark of the telescope navigator against the general Acts navigator.
+ *
+ * The tracks of a collection are propagated from their perigee through the
+ * trackers with both navigators, with the same stepper and material
+ * interactions as the CKF. Both propagations end on the last plane of
+ * sensors in the direction of the track, so they cover the same path. The steps and the time per track are reported at
+ * the end of the processing, together with the number of tracks for which
+ * the two navigators didn't cross the same sensors. Nothing is added to the
+ * event.
+ */
+class NavigatorBenchmark : public TrackingGeometryUser {
+ public:
+  NavigatorBenchmark(const std::string& name, framework::Process& process);
+  ~NavigatorBenchmark() = default;
+
+  void onNewRun(const ldmx::RunHeader& rh) final override;
+
+  void configure(framework::config::Parameters& parameters) final override;
+
+  void produce(framework::Event& event) final override;
+
+  void onProcessEnd() final override;
+
+ private:
+  /// Totals of the propagations with one navigator
+  struct Totals {
+    long n_tracks{0};
+    long n_failed{0};
+    long n_steps{0};
+    double time{0.};
+  };
+
+  /**
+   * Propagate a track to the end of the trackers
+   *
+   * @param[in] propagator the propagator to benchmark
+   * @param[in] start the parameters at the perigee
+   * @param[in] target the last plane of sensors crossed by the track
+   * @param[out] sensors the sensors with material crossed by the track
+   * @param[in,out] totals the totals of the propagator
+   */
+  template <typename propagator_t>
+  void propagate(const propagator_t& propagator,
+                 const Acts::BoundTrackParameters& start,
+                 const Acts::Surface& target,
+                 std::vector<Acts::GeometryIdentifier>& sensors,
+                 Totals& totals) const;
+
+  /// The tracks to propagate
+  std::string track_collection_{"TaggerTracks"};
+  /// Maximum step size of the propagation
+  double propagator_step_size_{200.};
+  /// Maximum number of steps of the propagation
+  int propagator_maxSteps_{10000};
+
+  /// Unbound surfaces at the first and the last plane of sensors along x
+  std::shared_ptr<Acts::Surface> first_plane_;
+  std::shared_ptr<Acts::Surface> last_plane_;
+
+  std::unique_ptr<const Acts::Propagator<Acts::EigenStepper<>, Acts::Navigator>>
+      generic_propagator_;
+  std::unique_ptr<const Acts::Propagator<Acts::EigenStepper<>, TelescopeNavigator>>
+      telescope_propagator_;
+
+  Totals generic_totals_;
+  Totals telescope_totals_;
+  /// Tracks for which the two navigators crossed different sensors
+  long n_mismatches_{0};
+};
+
+}  // namespace tracking::reco
@@ -7,6 +7,7 @@
 #include "Framework/EventProcessor.h"
 
 //---< Tracking >---//
+#include "Tracking/Sim/HitMask.h"
 #include "Tracking/Sim/LdmxSpacePoint.h"
 #include "Tracking/Sim/SeedToTrackParamMaker.h"
 #include "Tracking/Sim/TrackingUtils.h"
@@ -16,7 +17,9 @@
 
 //---< STD C++ >---//
 
+#include <array>
 #include <iostream>
+#include <map>
 
 //---< ACTS >---//
 #include "Acts/Definitions/Algebra.hpp"
@@ -78,14 +81,147 @@ class SeedFinderProcessor : public TrackingGeometryUser {
    */
   void produce(framework::Event& event);
 
-  bool GroupStrips(const std::vector<ldmx::Measurement>& measurements,
-                   const std::vector<int> strategy);
+ private:
+  /**
+   * Normal equations of the seed fit, A^T W A b = A^T W y', for the
+   * parameters b of the line and parabola centered at the origin of the
+   * strategy. They are the sums of the contributions of the hits.
+   */
+  struct SeedFitSums {
+    Acts::ActsMatrix<5, 5> normal;
+    Acts::ActsVector<5> rhs;
+    /// Change of rhs when the fit is centered 1 mm further along the beam
+    Acts::ActsVector<5> shift;
+
+    SeedFitSums& operator+=(const SeedFitSums& other) {
+      normal += other.normal;
+      rhs += other.rhs;
+      shift += other.shift;
+      return *this;
+    }
+  };
+
+  /// Hit of a seeding layer, reduced to the bending plane
+  struct SeedHit {
+    /// Position along the beam
+    double x;
+    /// Bending coordinate at the center of the strip
+    double y;
+    /// Half range of the bending coordinate along the strip
+    double dy;
+    /// The measurement of the hit
+    const ldmx::Measurement* meas;
+    /// Contribution of the hit to the seed fit
+    SeedFitSums fit;
+  };
+
+  /// Hits of a layer of the strategy, sorted by bending coordinate
+  struct SeedLayer {
+    /// Range of the positions of the hits along the beam
+    double xmin;
+    double xmax;
+    /// Largest half range of the hits
+    double dymax;
+    std::vector<SeedHit> hits;
+  };
 
-  void FindSeedsFromMap(std::vector<ldmx::Track>& seeds);
+  /**
+   * The state of the seeding with one strategy. Each strategy has its own,
+   * so the strategies of an event can run in parallel.
+   */
+  struct SeedStrategy {
+    /// The layers of the strategy
+    std::vector<int> layers;
+
+    // The measurements groups
+    std::map<int, std::vector<const ldmx::Measurement*>> groups_map;
+    std::vector<SeedLayer> seed_layers;
+    /// Position along the beam the seed fit contributions are centered at
+    double seed_origin{0.};
+
+    /// The seeds found and their measurements, sorted along the beam
+    std::vector<ldmx::Track> seeds;
+    std::vector<std::array<const ldmx::Measurement*, 5>> seed_hits;
+
+    std::vector<float> xhit;
+    std::vector<float> yhit;
+    std::vector<float> zhit;
+
+    std::vector<float> b0;
+    std::vector<float> b1;
+    std::vector<float> b2;
+    std::vector<float> b3;
+    std::vector<float> b4;
+
+    // Check failures
+    long nmissing{0};
+    long nfailpmin{0};
+    long nfailpmax{0};
+    long nfaild0min{0};
+    long nfaild0max{0};
+    long nfailz0max{0};
+    long nfits{0};
+
+    /// Reset the per-event state, keeping the layers
+    void clear();
+  };
+
+  /// Group the measurements on the layers of the strategy, skipping the
+  /// used hits if given
+  bool GroupStrips(const geo::TrackersTrackingGeometry& tg,
+                   const std::vector<ldmx::Measurement>& measurements,
+                   const tracking::sim::HitMask* used_hits,
+                   SeedStrategy& strategy);
 
- private:
-  ldmx::Track SeedTracker(const std::vector<ldmx::Measurement>& vmeas,
-                          double xOrigin,
+  /**
+   * Find the seeds of a strategy. The strategies run on worker threads, so
+   * the conditions are fetched before and passed down.
+   *
+   * @param tg The tracking geometry
+   * @param gctx The geometry context
+   * @param strategy The strategy, with its grouped measurements
+   */
+  void FindSeedsFromMap(const geo::TrackersTrackingGeometry& tg,
+                        const Acts::GeometryContext& gctx,
+                        SeedStrategy& strategy);
+
+  /**
+   * Build the seeding layers from the grouped measurements, ordered along
+   * the beam.
+   */
+  void BuildSeedLayers(const geo::TrackersTrackingGeometry& tg,
+                       SeedStrategy& strategy);
+
+  /// Contribution of a measurement to the seed fit, centered at origin
+  SeedFitSums SeedFitContribution(const geo::TrackersTrackingGeometry& tg,
+                                  const ldmx::Measurement& meas,
+                                  double origin) const;
+
+  /**
+   * Add the compatible hits of layer k to the partial seed and go on to the
+   * next layer. The normal equations of the hits already chosen are carried
+   * along, and the complete combinations are fitted.
+   */
+  void ExtendSeed(const Acts::GeometryContext& gctx, SeedStrategy& strategy,
+                  std::size_t k,
+                  std::array<const SeedHit*, 5>& chosen,
+                  const SeedFitSums& sums);
+
+  /**
+   * Check that a helix passing the pmin/pmax and d0 cuts can go through
+   * the three hits, within their ranges and the window tolerance.
+   */
+  bool Compatible(const SeedHit& h0, const SeedHit& h1,
+                  const SeedHit& h2) const;
+
+  /// Fit a complete combination of hits and keep the seed if it passes the
+  /// cuts
+  void FitSeed(const Acts::GeometryContext& gctx, SeedStrategy& strategy,
+               const std::array<const SeedHit*, 5>& chosen,
+               const SeedFitSums& sums);
+
+  ldmx::Track SeedTracker(const Acts::GeometryContext& gctx,
+                          const Acts::ActsVector<5>& B, double xOrigin,
                           const Acts::Vector3& perigee_location);
 
   void LineParabolaToHelix(const Acts::ActsVector<5> parameters,
@@ -123,7 +259,24 @@ class SeedFinderProcessor : public TrackingGeometryUser {
   double z0max_{60.};
   /// List of stragies for seed finding.
   std::vector<std::string> strategies_{};
+  /// The seeding state of each strategy
+  std::vector<SeedStrategy> seed_strategies_;
+  /// Seeds sharing more measurements than this with a seed of a previous
+  /// strategy are dropped
+  int max_shared_hits_{1};
+  /// Number of threads running the strategies of an event
+  int n_threads_{1};
+  /// Track collections of the previous passes. The hits of their good tracks
+  /// are not used for seeding.
+  std::vector<std::string> used_hit_tracks_{};
+  /// The hits used by the previous passes in the current event
+  tracking::sim::HitMask hit_mask_;
   double bfield_{1.5};
+  /// Tolerance added to the compatibility windows of the seeding, in mm.
+  double window_tolerance_{2.};
+  /// Bounds on the curvature of the seeds from pmin and pmax
+  double max_curvature_{0.};
+  double min_curvature_{0.};
 
   TFile* outputFile_;
   TTree* outputTree_;
@@ -146,11 +299,8 @@ class SeedFinderProcessor : public TrackingGeometryUser {
   long nfaild0min_{0};
   long nfaild0max_{0};
   long nfailz0max_{0};
-
-  // The measurements groups
-
-  std::map<int, std::vector<const ldmx::Measurement*>> groups_map;
-  std::array<const ldmx::Measurement*, 5> groups_array;
+  long nfits_{0};
+  long nduplicates_{0};
 
   // Truth Matching tool
   std::shared_ptr<tracking::sim::TruthMatchingTool> truthMatchingTool_ = nullptr;
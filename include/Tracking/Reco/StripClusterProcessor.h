@@ -0,0 +1,110 @@
+#pragma once
+
+//--- Framework ---//
+#include "Framework/Configure/Parameters.h"
+#include "Framework/EventProcessor.h"
+
+//--- Tracking ---//
+#include "Tracking/Event/Measurement.h"
+#include "Tracking/Event/RawSiStripHit.h"
+#include "Tracking/Event/RawSiStripHitColumns.h"
+#include "Tracking/Reco/StripPulseFitter.h"
+#include "Tracking/Reco/TrackingGeometryUser.h"
+
+//--- C++ ---//
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Reconstruction of the strip hits into measurements.
+ *
+ * The pulses of all the strips of the event are fitted together for their
+ * amplitude and start time, see StripPulseFitter. The strips of each sensor
+ * are then clustered: a cluster is a run of adjacent strips above the
+ * neighbour threshold with at least one strip above the seed threshold. The
+ * thresholds are in units of the noise of the fitted amplitude of each
+ * strip, the noise of a sample over sqrt(Sff) at its fitted start time.
+ * Strips whose fit has a chi2 per degree of freedom above a maximum are not
+ * clustered. The position of a cluster is the amplitude weighted centroid of
+ * its strips, corrected for the Lorentz shift, and its time the amplitude
+ * weighted start time. Each cluster is added to the event as a 1D
+ * measurement on its sensor.
+ */
+class StripClusterProcessor : public TrackingGeometryUser {
+ public:
+  StripClusterProcessor(const std::string& name, framework::Process& process);
+  ~StripClusterProcessor() = default;
+
+  void onProcessStart() final override;
+
+  void configure(framework::config::Parameters& parameters) final override;
+
+  void produce(framework::Event& event) final override;
+
+  void onProcessEnd() final override;
+
+ private:
+  /**
+   * Make the measurement of a cluster.
+   *
+   * @param raw_hits The strip hits of the event
+   * @param begin Start of the cluster in the sorted strip order
+   * @param end End of the cluster in the sorted strip order
+   * @param[out] measurements The measurement is appended to it
+   */
+  void makeMeasurement(const ldmx::RawSiStripHitColumns& raw_hits,
+                       std::size_t begin, std::size_t end,
+                       std::vector<ldmx::Measurement>& measurements);
+
+  /// Input strip hit collection
+  std::string raw_hit_collection_{"RawSiStripHits"};
+  /// The input hits have their samples packed in one buffer
+  bool packed_raw_hits_{false};
+  /// Output measurement collection
+  std::string out_collection_{"StripMeasurements"};
+  /// Number of strips of a sensor along its local u axis
+  int n_strips_{640};
+  /// Tangent of the Lorentz angle
+  double lorentz_tan_{0.01};
+  /// Noise of a sample, in ADC counts
+  double noise_adc_{1000. / 15.};
+  /// Pedestal of the samples, in ADC counts
+  double pedestal_{4000.};
+  /// Thresholds on the fitted amplitude, in units of the noise of the
+  /// amplitude of each strip
+  double seed_threshold_{4.};
+  double neighbour_threshold_{2.};
+  /// Largest chi2 per degree of freedom of the pulse fit of a clustered
+  /// strip, with the noise of a sample as error
+  double max_chi2_ndf_{10.};
+
+  /// Configuration of the pulse fit
+  StripPulseFitter::Config fit_cfg_;
+  std::unique_ptr<StripPulseFitter> fitter_;
+
+  /// Input hits of the event packed, when they are not already
+  ldmx::RawSiStripHitColumns columns_;
+  /// Pedestal subtracted samples of the event, sample-major
+  std::vector<float> samples_;
+  /// Fit results of each strip hit
+  std::vector<float> amplitude_;
+  std::vector<float> t0_;
+  std::vector<float> chi2_;
+  /// Noise of the amplitudes, in units of noise_adc_
+  std::vector<float> amplitude_noise_;
+  /// Strip hits ordered by sensor and strip
+  std::vector<std::size_t> order_;
+
+  /// Totals for the report at the end of the processing
+  long n_events_{0};
+  long n_strips_fitted_{0};
+  long n_strips_bad_chi2_{0};
+  long n_clusters_{0};
+  double fit_time_{0.};
+};
+
+}  // namespace tracking::reco
@@ -0,0 +1,87 @@
+#pragma once
+
+//--- C++ ---//
+#include <cstddef>
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Fit of the amplitude and start time of the CR-RC pulses of many strips.
+ *
+ * The pulse of a strip is A * f(t - t0), with f(t) = t / tau * exp(1 - t /
+ * tau) for t > 0, sampled at fixed times. For a given t0 the best amplitude
+ * is linear, A = Syf / Sff, and the chi2 is Syy - Syf^2 / Sff, so the fit
+ * scans a grid of t0 shared by all strips: the pulse shapes of the grid are
+ * computed once, and the sums Syf of all the strips for all the grid points
+ * are a single matrix product of the shapes with the samples. The best grid
+ * point of each strip is refined with a parabola through its neighbours.
+ *
+ * The samples are given sample-major, the i-th samples of all strips next to
+ * each other, so the inner loops run over strips with unit stride and no
+ * branches, and the compiler vectorizes them.
+ */
+class StripPulseFitter {
+ public:
+  struct Config {
+    /// Shaping time of the CR-RC pulse, the time from its start to its peak
+    /// (ns)
+    double shaping_time{50.};
+    /// Time of the first sample with respect to the event (ns)
+    double first_sample_time{0.};
+    /// Time between samples (ns)
+    double sample_spacing{25.};
+    /// Number of samples per strip
+    int n_samples{6};
+    /// Range and spacing of the grid of start times (ns)
+    double t0_min{-50.};
+    double t0_max{100.};
+    double t0_step{1.};
+  };
+
+  explicit StripPulseFitter(const Config& cfg);
+
+  /**
+   * Fit the pulses of n strips.
+   *
+   * @param samples The pedestal subtracted samples, sample i of strip s at
+   *    samples[i * n + s]
+   * @param n The number of strips
+   * @param[out] amplitude The fitted amplitudes, 0 if there is no positive
+   *    pulse, n entries
+   * @param[out] t0 The fitted start times in ns, n entries
+   * @param[out] chi2 The sum of the squared residuals, in the units of the
+   *    samples squared, n entries
+   * @param[out] amplitude_noise The noise of the amplitude in units of the
+   *    noise of a sample, 1 / sqrt(Sff) at the fitted start time, infinite
+   *    if no sample is on the pulse, n entries
+   */
+  void fit(const float* samples, std::size_t n, float* amplitude, float* t0,
+           float* chi2, float* amplitude_noise);
+
+  /// @return The configuration
+  const Config& config() const { return cfg_; }
+
+ private:
+  /// Unit pulse started at t0 at sample i
+  float pulse(int i, float t0) const;
+
+  Config cfg_;
+
+  /// Start times of the grid
+  std::vector<float> grid_;
+  /// Pulse shapes of the grid, n_samples per grid point
+  std::vector<float> shapes_;
+  /// Sff of each grid point
+  std::vector<float> shape_norms_;
+
+  /// Work arrays of the fit, reused between events
+  std::vector<float> syy_;
+  std::vector<float> scores_;
+  std::vector<float> best_score_;
+  std::vector<int> best_index_;
+  std::vector<float> syf_;
+  std::vector<float> sff_;
+};
+
+}  // namespace tracking::reco
@@ -0,0 +1,248 @@
+#pragma once
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/Definitions/Common.hpp"
+#include "Acts/Geometry/GeometryContext.hpp"
+#include "Acts/Geometry/GeometryIdentifier.hpp"
+#include "Acts/Geometry/TrackingGeometry.hpp"
+#include "Acts/Geometry/TrackingVolume.hpp"
+#include "Acts/Material/IVolumeMaterial.hpp"
+#include "Acts/Surfaces/Surface.hpp"
+#include "Acts/Utilities/Intersection.hpp"
+
+//--- Tracking ---//
+#include "Tracking/geo/TrackingGeometry.h"
+
+//--- C++ ---//
+#include <memory>
+#include <vector>
+
+namespace tracking::reco {
+
+/**
+ * Navigator specialised for the telescope geometry of the LDMX trackers.
+ *
+ * The trackers are a fixed sequence of sensor planes along x, so instead of
+ * resolving volumes, layers and boundaries at every step as Acts::Navigator
+ * does, this navigator walks the planes precomputed by the tracking geometry
+ * in order: it aims the stepper at the next plane, and once on it sets the
+ * sensor containing the track, if any, as the current surface. Sensors
+ * carry all the material of the trackers, and the volumes are vacuum.
+ *
+ * When the planes are exhausted the end of the world is reached, unless the
+ * propagation has a target surface, which the aborter of the propagator
+ * takes care of. The planes behind the target are not visited.
+ *
+ * It has the interface of Acts::Navigator and can be used in its place in
+ * an Acts::Propagator.
+ */
+class TelescopeNavigator {
+ public:
+  struct Config {
+    /// The tracking geometry, for the world volume
+    std::shared_ptr<const Acts::TrackingGeometry> tracking_geometry;
+    /// The planes of sensors, in increasing x
+    std::vector<geo::TrackingGeometry::TelescopePlane> planes;
+  };
+
+  struct State {
+    const Acts::Surface* startSurface{nullptr};
+    const Acts::Surface* currentSurface{nullptr};
+    const Acts::Surface* targetSurface{nullptr};
+    /// The world volume, nullptr once the end of the world is reached
+    const Acts::TrackingVolume* currentVolume{nullptr};
+
+    /// Index of the next plane to cross, out of range if there is none
+    int nextPlane{-1};
+    /// Direction along x of the propagation, +1 or -1
+    int xDirection{1};
+    /// Position of the target surface along x
+    double targetX{0.};
+
+    bool targetReached{false};
+    bool navigationBreak{false};
+  };
+
+  /**
+   * Build the navigator from the planes of the trackers
+   *
+   * @param geometry the tracking geometry of the trackers
+   */
+  explicit TelescopeNavigator(const geo::TrackingGeometry& geometry)
+      : TelescopeNavigator(Config{geometry.getTG(),
+                                  geometry.getTelescopePlanes()}) {}
+
+  explicit TelescopeNavigator(Config cfg) : cfg_{std::move(cfg)} {}
+
+  State makeState(const Acts::Surface* startSurface,
+                  const Acts::Surface* targetSurface) const {
+    State state;
+    state.startSurface = startSurface;
+    state.targetSurface = targetSurface;
+    state.currentVolume = cfg_.tracking_geometry->highestTrackingVolume();
+    return state;
+  }
+
+  State& resetState(State& state, const Acts::GeometryContext& geoContext,
+                    const Acts::Vector3& pos, const Acts::Vector3& dir,
+                    const Acts::Surface* ss, const Acts::Surface* ts) const {
+    state = makeState(ss, ts);
+    state.currentSurface = ss;
+    if (ts) state.targetX = ts->center(geoContext)(0);
+    findNextPlane(state, pos, dir);
+    return state;
+  }
+
+  const Acts::Surface* currentSurface(const State& state) const {
+    return state.currentSurface;
+  }
+
+  const Acts::TrackingVolume* currentVolume(const State& state) const {
+    return state.currentVolume;
+  }
+
+  /// The tracker volumes are vacuum
+  const Acts::IVolumeMaterial* currentVolumeMaterial(
+      const State& /*state*/) const {
+    return nullptr;
+  }
+
+  const Acts::Surface* startSurface(const State& state) const {
+    return state.startSurface;
+  }
+
+  const Acts::Surface* targetSurface(const State& state) const {
+    return state.targetSurface;
+  }
+
+  bool targetReached(const State& state) const { return state.targetReached; }
+
+  bool endOfWorldReached(const State& state) const {
+    return state.currentVolume == nullptr;
+  }
+
+  bool navigationBreak(const State& state) const {
+    return state.navigationBreak;
+  }
+
+  void currentSurface(State& state, const Acts::Surface* surface) const {
+    state.currentSurface = surface;
+  }
+
+  void targetReached(State& state, bool targetReached) const {
+    state.targetReached = targetReached;
+  }
+
+  void navigationBreak(State& state, bool navigationBreak) const {
+    state.navigationBreak = navigationBreak;
+  }
+
+  /// All the sensors are already visited
+  void insertExternalSurface(State& /*state*/,
+                             Acts::GeometryIdentifier /*geoid*/) const {}
+
+  template <typename propagator_state_t, typename stepper_t>
+  void initialize(propagator_state_t& state, const stepper_t& stepper) const {
+    auto& nav = state.navigation;
+    nav.currentSurface = nav.startSurface;
+    nav.currentVolume = cfg_.tracking_geometry->highestTrackingVolume();
+    if (nav.targetSurface)
+      nav.targetX = nav.targetSurface->center(state.geoContext)(0);
+    findNextPlane(nav, stepper.position(state.stepping),
+                  direction(state, stepper));
+  }
+
+  template <typename propagator_state_t, typename stepper_t>
+  void preStep(propagator_state_t& state, const stepper_t& stepper) const {
+    auto& nav = state.navigation;
+    nav.currentSurface = nullptr;
+    if (nav.targetReached || nav.navigationBreak) return;
+
+    // A looper can turn back along x
+    Acts::Vector3 dir = direction(state, stepper);
+    if (dir(0) * nav.xDirection < 0.)
+      findNextPlane(nav, stepper.position(state.stepping), dir);
+
+    // Aim at the next reachable plane
+    while (const auto* plane = nextPlane(nav)) {
+      auto status = stepper.updateSurfaceStatus(
+          state.stepping, *plane->sensors.front(), false);
+      if (status == Acts::Intersection3D::Status::reachable) return;
+      nav.nextPlane += nav.xDirection;
+    }
+
+    stepper.releaseStepSize(state.stepping);
+    if (!nav.targetSurface) nav.currentVolume = nullptr;
+  }
+
+  template <typename propagator_state_t, typename stepper_t>
+  void postStep(propagator_state_t& state, const stepper_t& stepper) const {
+    auto& nav = state.navigation;
+    const auto* plane = nextPlane(nav);
+    if (!plane) return;
+
+    auto status = stepper.updateSurfaceStatus(state.stepping,
+                                              *plane->sensors.front(), false);
+    if (status != Acts::Intersection3D::Status::onSurface) return;
+
+    // The sensor the track is in, if it isn't in a gap between sensors
+    Acts::Vector3 pos = stepper.position(state.stepping);
+    Acts::Vector3 dir = direction(state, stepper);
+    for (const auto* sensor : plane->sensors) {
+      if (sensor->isOnSurface(state.geoContext, pos, dir, true)) {
+        nav.currentSurface = sensor;
+        break;
+      }
+    }
+    nav.nextPlane += nav.xDirection;
+  }
+
+ private:
+  /// Direction of the propagation
+  template <typename propagator_state_t, typename stepper_t>
+  static Acts::Vector3 direction(const propagator_state_t& state,
+                                 const stepper_t& stepper) {
+    double sign =
+        state.options.direction == Acts::NavigationDirection::Forward ? 1.
+                                                                      : -1.;
+    return sign * stepper.direction(state.stepping);
+  }
+
+  /// Find the first plane ahead of a position
+  void findNextPlane(State& state, const Acts::Vector3& pos,
+                     const Acts::Vector3& dir) const {
+    const auto& planes = cfg_.planes;
+    int n = static_cast<int>(planes.size());
+    state.xDirection = dir(0) < 0. ? -1 : 1;
+    if (state.xDirection > 0) {
+      int i = 0;
+      while (i < n && planes[i].x <= pos(0) + kOnPlaneTolerance) i++;
+      state.nextPlane = i;
+    } else {
+      int i = n - 1;
+      while (i >= 0 && planes[i].x >= pos(0) - kOnPlaneTolerance) i--;
+      state.nextPlane = i;
+    }
+  }
+
+  /// The next plane to cross, nullptr if there is none before the target
+  const geo::TrackingGeometry::TelescopePlane* nextPlane(
+      const State& state) const {
+    if (state.nextPlane < 0 ||
+        state.nextPlane >= static_cast<int>(cfg_.planes.size()))
+      return nullptr;
+    const auto& plane = cfg_.planes[state.nextPlane];
+    if (state.targetSurface &&
+        (plane.x - state.targetX) * state.xDirection > kOnPlaneTolerance)
+      return nullptr;
+    return &plane;
+  }
+
+  /// Distance along x below which a position is on a plane
+  static constexpr double kOnPlaneTolerance = 1e-4;
+
+  Config cfg_;
+};
+
+}  // namespace tracking::reco
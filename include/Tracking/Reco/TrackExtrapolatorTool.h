@@ -10,14 +10,21 @@
 #include "Acts/Propagator/ActionList.hpp"
 #include "Acts/Propagator/detail/SteppingLogger.hpp"
 #include "Acts/Propagator/MaterialInteractor.hpp"
+#include "Acts/Utilities/Intersection.hpp"
+#include "Acts/Utilities/Logger.hpp"
 
 
 #include "Tracking/Event/Track.h"
 #include "Tracking/Sim/TrackingUtils.h"
 
+#include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 
 using ActionList = Acts::ActionList<Acts::detail::SteppingLogger, Acts::MaterialInteractor>;
@@ -26,6 +33,47 @@ using AbortList = Acts::AbortList<Acts::EndOfWorldReached>;
 namespace tracking{
 namespace reco{
 
+/**
+ * Propagation actor recording the bound parameters on surfaces that aren't
+ * part of the tracking geometry.
+ *
+ * Before the first step the surfaces are handed to the navigator as
+ * external surfaces, in the order the propagation reaches them. The
+ * navigator stops on each of them, see tracking::sim::InstrumentedNavigator,
+ * and the parameters are recorded there. Surfaces that aren't reached are
+ * left empty.
+ */
+struct UnboundSurfaceCollector {
+  /// The surfaces in propagation order
+  std::vector<const Acts::Surface*> surfaces;
+
+  struct this_result {
+    /// The parameters on each surface, if it was reached
+    std::vector<std::optional<Acts::BoundTrackParameters>> parameters;
+  };
+  using result_type = this_result;
+
+  template <typename propagator_state_t, typename stepper_t,
+            typename navigator_t>
+  void operator()(propagator_state_t& state, const stepper_t& stepper,
+                  const navigator_t& navigator, result_type& result,
+                  const Acts::Logger& /*logger*/) const {
+    if (result.parameters.size() != surfaces.size()) {
+      result.parameters.resize(surfaces.size());
+      for (const auto* surface : surfaces)
+        navigator.insertExternalSurface(state.navigation, surface);
+    }
+
+    const auto* surface = navigator.currentUnboundSurface(state.navigation);
+    if (!surface) return;
+    auto it = std::find(surfaces.begin(), surfaces.end(), surface);
+    if (it == surfaces.end()) return;
+    auto bound = stepper.boundState(state.stepping, *surface);
+    if (bound.ok())
+      result.parameters[it - surfaces.begin()] = std::get<0>(*bound);
+  }
+};
+
 template <class propagator_t>
 class TrackExtrapolatorTool {
   
@@ -89,55 +137,56 @@ public:
   std::optional<Acts::BoundTrackParameters> extrapolate(track_t track,
                                                         const std::shared_ptr<Acts::Surface>& target_surface) {
     
-    // get first and last track state on surface
-    size_t nstates = track.nTrackStates();
-    auto& tsc       = track.container().trackStateContainer();
-    //auto  ts_first  = tsc.getTrackState(0);
-    //auto  ts_last   = tsc.getTrackState(nstates-1);
-    auto  outermost = *(track.trackStates().begin());
-    auto  begin  = track.trackStates().begin();
-    std::advance(begin, track.nTrackStates() - 1 );
-    auto  innermost  = *begin;
-    
-    // I'm checking which track state is closer to the origin of the target surface to decide
-    // from where to start the extrapolation to the surface. I use the coordinate along the beam axis.
-    
-    double first_dis =  std::abs(innermost.referenceSurface().transform(gctx_).translation()(0)
-                                 - target_surface->transform(gctx_).translation()(0));
-    
-    double last_dis =  std::abs(outermost.referenceSurface().transform(gctx_).translation()(0)
-                                - target_surface->transform(gctx_).translation()(0));
+    auto [innermost, outermost] = innerOuterStates(track);
+    return extrapolate(closest(innermost, outermost, *target_surface),
+                       target_surface);
     
+  }
 
-    //This is the track state to use for the extrapolation
-    
-    const auto& ts = first_dis < last_dis ? innermost : outermost;
 
-    //std::cout<<"Selected track state for extrapolation"<<std::endl;
-    
-    //Get the BoundTrackStateParameters
-    
-    const auto& surface  = ts.referenceSurface();
-    const auto& smoothed = ts.smoothed();
-    bool hasSmoothed = ts.hasSmoothed();
-    const auto& filtered = ts.filtered();
-    const auto& cov      = ts.smoothedCovariance();
+  /** Method to extrapolate to several surfaces at once given a set of BoundTrackParameters
+   * The surfaces in the same direction from the parameters are reached in one propagation, see
+   * the extrapolation of a track to several surfaces.
+   @param Bound Track Parameters
+   @param The target surfaces, in any order
+   @return optional containing the bound track parameters on each surface, in the order of the
+           surfaces.
+   **/
 
-    //std::cout<<"Surface::"<<     surface.transform(gctx_).translation()<<std::endl;
-    //std::cout<<"Smoothed::"<<    smoothed.transpose()<<std::endl;
-    //std::cout<<"HasSmoothed::"<< hasSmoothed<<std::endl;
-    //std::cout<<"Filtered::"<<    filtered.transpose()<<std::endl;
-    
-    Acts::ActsScalar q = smoothed[Acts::eBoundQOverP] > 0 ? 1 * Acts::UnitConstants::e
-                         : -1 * Acts::UnitConstants::e;
-    
-    Acts::BoundTrackParameters sp(surface.getSharedPtr(),
-                                  smoothed,
-                                  q,
-                                  cov);
-    
-    return extrapolate(sp,target_surface);
-    
+  std::vector<std::optional<Acts::BoundTrackParameters>> extrapolate(
+      const Acts::BoundTrackParameters& pars,
+      const std::vector<std::shared_ptr<Acts::Surface>>& target_surfaces) {
+    Legs legs;
+    for (std::size_t i = 0; i < target_surfaces.size(); i++)
+      addToLeg(legs, pars, *target_surfaces[i], i);
+    return propagateLegs(legs, target_surfaces);
+  }
+
+
+  /** Method to extrapolate a track to several surfaces at once
+   * Each surface is extrapolated to from the innermost or the outermost track state, whichever
+   * is closer along the beam axis, as in extrapolate. The surfaces extrapolated to from the same
+   * track state in the same direction are reached in a single propagation: the furthest one is
+   * its target, and the others are handed to the navigator as external surfaces, on which the
+   * parameters are recorded as the track crosses them.
+   @param An Acts::Track
+   @param The target surfaces, in any order
+   @return optional containing the bound track parameters on each surface, in the order of the
+           surfaces.
+   **/
+
+  template <class track_t>
+  std::vector<std::optional<Acts::BoundTrackParameters>> extrapolate(
+      track_t track,
+      const std::vector<std::shared_ptr<Acts::Surface>>& target_surfaces) {
+    if (target_surfaces.empty()) return {};
+
+    auto [innermost, outermost] = innerOuterStates(track);
+    Legs legs;
+    for (std::size_t i = 0; i < target_surfaces.size(); i++)
+      addToLeg(legs, closest(innermost, outermost, *target_surfaces[i]),
+               *target_surfaces[i], i);
+    return propagateLegs(legs, target_surfaces);
   }
   
   
@@ -204,31 +253,158 @@ public:
 
     auto opt_pars = extrapolate(track,target_surface);
     if (opt_pars) {
-      
-      //Reference point
-      Acts::Vector3 surf_loc = target_surface->transform(gctx_).translation();
-      ts.refX = surf_loc(0);
-      ts.refY = surf_loc(1);
-      ts.refZ = surf_loc(2);
-      
-      //Parameters
-      ts.params = tracking::sim::utils::convertActsToLdmxPars((*opt_pars).parameters());
-
-      //Covariance
-      const Acts::BoundMatrix& trk_cov = *((*opt_pars).covariance());
-      tracking::sim::utils::flatCov(trk_cov,ts.cov);
-      
-      ts.ts_type = type;
+      fillTrackState(*opt_pars, *target_surface, ts, type);
       return true;
     }
     else {
       return false;
     }
   }
+
+
+  /** Create the ldmx::TrackStates at several surfaces, stepping along each direction once
+   @param Acts::Track
+   @param extrapolation surfaces and the type of the track state on each of them
+   @return the track states on the surfaces that were reached, in the order of the surfaces
+   */
+
+  template <class track_t>
+  std::vector<ldmx::Track::TrackState> TrackStatesAtSurfaces(
+      track_t track,
+      const std::vector<std::pair<std::shared_ptr<Acts::Surface>,
+                                  ldmx::TrackStateType>>& targets) {
+
+    std::vector<std::shared_ptr<Acts::Surface>> surfaces;
+    for (const auto& target : targets) surfaces.push_back(target.first);
+    auto parameters = extrapolate(track, surfaces);
+
+    std::vector<ldmx::Track::TrackState> states;
+    for (std::size_t i = 0; i < targets.size(); i++) {
+      if (!parameters[i]) continue;
+      ldmx::Track::TrackState ts;
+      fillTrackState(*parameters[i], *targets[i].first, ts, targets[i].second);
+      states.push_back(ts);
+    }
+    return states;
+  }
   
   
   
  private:
+
+  /// The surfaces of each propagation: key is the start parameters and the
+  /// direction, values are the path length to each surface and its index
+  using Legs =
+      std::map<std::pair<const Acts::BoundTrackParameters*, bool>,
+               std::vector<std::pair<double, std::size_t>>>;
+
+  /// Add a surface to the propagation from the start parameters towards it
+  void addToLeg(Legs& legs, const Acts::BoundTrackParameters& start,
+                const Acts::Surface& surface, std::size_t index) const {
+    auto intersection = surface.intersect(gctx_, start.position(gctx_),
+                                          start.unitDirection(), false);
+    double path = intersection.intersection.pathLength;
+    legs[{&start, path >= 0}].emplace_back(std::abs(path), index);
+  }
+
+  /// Propagate each leg once, recording the parameters on its surfaces
+  std::vector<std::optional<Acts::BoundTrackParameters>> propagateLegs(
+      Legs& legs,
+      const std::vector<std::shared_ptr<Acts::Surface>>& target_surfaces) {
+    std::vector<std::optional<Acts::BoundTrackParameters>> parameters(
+        target_surfaces.size());
+
+    using LegActionList =
+        Acts::ActionList<UnboundSurfaceCollector, Acts::MaterialInteractor>;
+    for (auto& [leg, targets] : legs) {
+      std::sort(targets.begin(), targets.end());
+
+      Acts::PropagatorOptions<LegActionList, AbortList> pOptions(gctx_, mctx_);
+      pOptions.direction = leg.second ? Acts::NavigationDirection::Forward
+                                      : Acts::NavigationDirection::Backward;
+
+      // The furthest surface is the target, the others are crossed on the way
+      auto& collector =
+          pOptions.actionList.template get<UnboundSurfaceCollector>();
+      for (std::size_t k = 0; k + 1 < targets.size(); k++)
+        collector.surfaces.push_back(
+            target_surfaces[targets[k].second].get());
+
+      auto result = propagator_.propagate(
+          *leg.first, *target_surfaces[targets.back().second], pOptions);
+      if (!result.ok()) continue;
+
+      const auto& collected =
+          result.value().template get<UnboundSurfaceCollector::result_type>();
+      for (std::size_t k = 0; k < collected.parameters.size(); k++)
+        parameters[targets[k].second] = collected.parameters[k];
+      if (result.value().endParameters)
+        parameters[targets.back().second] = *result.value().endParameters;
+    }
+
+    return parameters;
+  }
+
+  /// Bound parameters of the innermost and the outermost track states, in a
+  /// single pass over the track states
+  template <class track_t>
+  std::pair<Acts::BoundTrackParameters, Acts::BoundTrackParameters>
+  innerOuterStates(track_t track) const {
+    // The track states are iterated from the outermost
+    auto& tsc = track.container().trackStateContainer();
+    auto outermost_index = track.tipIndex();
+    auto innermost_index = outermost_index;
+    for (const auto& ts : track.trackStates()) innermost_index = ts.index();
+
+    return {boundParameters(tsc.getTrackState(innermost_index)),
+            boundParameters(tsc.getTrackState(outermost_index))};
+  }
+
+  /// Smoothed bound parameters of a track state
+  template <class track_state_t>
+  static Acts::BoundTrackParameters boundParameters(const track_state_t& ts) {
+    const auto& smoothed = ts.smoothed();
+    Acts::ActsScalar q = smoothed[Acts::eBoundQOverP] > 0 ? 1 * Acts::UnitConstants::e
+                         : -1 * Acts::UnitConstants::e;
+    return Acts::BoundTrackParameters(ts.referenceSurface().getSharedPtr(),
+                                      smoothed, q, ts.smoothedCovariance());
+  }
+
+  // I'm checking which track state is closer to the origin of the target surface to decide
+  // from where to start the extrapolation to the surface. I use the coordinate along the beam axis.
+  const Acts::BoundTrackParameters& closest(
+      const Acts::BoundTrackParameters& innermost,
+      const Acts::BoundTrackParameters& outermost,
+      const Acts::Surface& target_surface) const {
+    double target_x = target_surface.transform(gctx_).translation()(0);
+    double first_dis = std::abs(
+        innermost.referenceSurface().transform(gctx_).translation()(0) - target_x);
+    double last_dis = std::abs(
+        outermost.referenceSurface().transform(gctx_).translation()(0) - target_x);
+    return first_dis < last_dis ? innermost : outermost;
+  }
+
+  /// Fill an ldmx::TrackState from the parameters on a surface
+  void fillTrackState(const Acts::BoundTrackParameters& pars,
+                      const Acts::Surface& surface,
+                      ldmx::Track::TrackState& ts,
+                      ldmx::TrackStateType type) const {
+    //Reference point
+    Acts::Vector3 surf_loc = surface.transform(gctx_).translation();
+    ts.refX = surf_loc(0);
+    ts.refY = surf_loc(1);
+    ts.refZ = surf_loc(2);
+
+    //Parameters
+    ts.params = tracking::sim::utils::convertActsToLdmxPars(pars.parameters());
+
+    //Covariance
+    const Acts::BoundMatrix& trk_cov = *(pars.covariance());
+    tracking::sim::utils::flatCov(trk_cov,ts.cov);
+
+    ts.ts_type = type;
+  }
+  
   
   propagator_t propagator_;
   Acts::GeometryContext gctx_;
@@ -6,6 +6,7 @@
 #include "Tracking/geo/TrackersTrackingGeometry.h"
 #include "Tracking/geo/GeometryContext.h"
 #include "Tracking/geo/MagneticFieldContext.h"
+#include "Tracking/geo/MagneticFieldMap.h"
 #include "Tracking/geo/CalibrationContext.h"
 
 namespace tracking::reco {
@@ -22,6 +23,9 @@ class TrackingGeometryUser : public framework::Producer {
   const Acts::MagneticFieldContext& magnetic_field_context();
   const Acts::CalibrationContext& calibration_context();
   const geo::TrackersTrackingGeometry& geometry();
+  const geo::MagneticFieldMap& magnetic_field_map();
+  /// the shared interpolated field map in the tracking frame
+  std::shared_ptr<const Acts::MagneticFieldProvider> magnetic_field();
  private:
   /**
    * Templated condition access code for our conditions with static names.
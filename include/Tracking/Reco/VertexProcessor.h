@@ -7,7 +7,7 @@
 
 // --- Tracking --- //
 #include "Tracking/Event/Track.h"
-#include "Tracking/Sim/BFieldXYZUtils.h"
+#include "Tracking/Reco/TrackingGeometryUser.h"
 #include "Tracking/Sim/TrackingUtils.h"
 
 // --- ACTS --- //
@@ -45,7 +45,7 @@ namespace tracking {
 namespace reco {
 
 
-class VertexProcessor : public framework::Producer {
+class VertexProcessor : public TrackingGeometryUser {
  public:
 
   /**
@@ -65,6 +65,11 @@ class VertexProcessor : public framework::Producer {
    */
   void onProcessStart() final override;
 
+  /**
+   * Retrieve the shared interpolated bfield map from the conditions.
+   */
+  void onNewRun(const ldmx::RunHeader &rh) final override;
+
   /**
    *
    */
@@ -94,10 +99,7 @@ class VertexProcessor : public framework::Producer {
   int nevents_{0};
   
   //The interpolated bfield
-  std::shared_ptr<InterpolatedMagneticField3> sp_interpolated_bField_;
-  
-  /// Path to the magnetic field map.
-  std::string field_map_{""};
+  std::shared_ptr<const Acts::MagneticFieldProvider> sp_interpolated_bField_;
 
   //Track collection name
 
@@ -8,7 +8,7 @@
 
 // --- Tracking --- //
 #include "Tracking/Event/Track.h"
-#include "Tracking/Sim/BFieldXYZUtils.h"
+#include "Tracking/Reco/TrackingGeometryUser.h"
 #include "Tracking/Sim/TrackingUtils.h"
 
 // --- ACTS --- //
@@ -49,7 +49,7 @@ using VoidPropagator = Acts::Propagator<Acts::EigenStepper<>>;
 namespace tracking {
 namespace reco {
   
-class Vertexer : public framework::Producer {
+class Vertexer : public TrackingGeometryUser {
  public:
 
   Vertexer(const std::string &name, framework::Process &process);
@@ -57,6 +57,7 @@ class Vertexer : public framework::Producer {
   ~Vertexer();
 
   void onProcessStart() final override;
+  void onNewRun(const ldmx::RunHeader& rh) final override;
   void onProcessEnd() final override;
 
   void configure(framework::config::Parameters &parameters) final override ;
@@ -75,12 +76,9 @@ class Vertexer : public framework::Producer {
   int nevents_{0};
   int nvertices_{0};
   int nreconstructable_{0};
-  std::shared_ptr<InterpolatedMagneticField3> sp_interpolated_bField_;
+  std::shared_ptr<const Acts::MagneticFieldProvider> sp_interpolated_bField_;
   std::shared_ptr<Acts::ConstantBField> bField_;  
   
-  /// Path to the magnetic field map.
-  std::string field_map_;
-  
   std::string trk_c_name_1{"TaggerTracks"};
   std::string trk_c_name_2{"RecoilTracks"};
   std::shared_ptr<VoidPropagator> propagator_;
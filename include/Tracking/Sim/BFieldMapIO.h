@@ -0,0 +1,166 @@
+#pragma once
+
+//--- C++ ---//
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Header of the binary magnetic field map format.
+ *
+ * The binary map is a compact, already processed version of the ASCII field
+ * maps: the axes are sorted and deduplicated, units are converted to the ACTS
+ * native units and the field components are stored as three contiguous planes
+ * (Bx, By, Bz) in field-map space, so that the grid can be filled (or read in
+ * place) without any parsing. The layout of the file is
+ *
+ *   [header][padding up to data_offset][Bx plane][By plane][Bz plane]
+ *
+ * where each plane holds nbins[0]*nbins[1]*nbins[2] values of the stored
+ * precision, indexed as (ix * nbins[1] + iy) * nbins[2] + iz, i.e. the same
+ * ordering of localToGlobalBin_xyz. The file is written in the native byte
+ * order of the machine that produced it.
+ */
+struct BFieldMapHeader {
+  /// Magic string identifying the format
+  char magic[8];
+  /// Version of the format
+  std::uint32_t version;
+  /// Size in bytes of the stored field values (4 = float, 8 = double)
+  std::uint32_t precision;
+  /// Number of grid points along x, y and z (field-map frame)
+  std::uint64_t nbins[3];
+  /// Position of the first grid point along each axis (ACTS length units)
+  double min[3];
+  /// Upper edge of the last bin along each axis (ACTS length units)
+  double max[3];
+  /// Offset in bytes of the Bx plane from the start of the file
+  std::uint64_t data_offset;
+};
+
+/// Magic string at the start of each binary field map
+static constexpr char BFIELD_MAP_MAGIC[8] = {'L', 'D', 'M', 'X',
+                                             'B', 'M', 'A', 'P'};
+/// Current version of the binary field map format
+static constexpr std::uint32_t BFIELD_MAP_VERSION = 1;
+
+/**
+ * Check if a file is a binary field map by looking at its magic string.
+ *
+ * @param path The path to the file to check.
+ * @return true if the file exists and starts with the binary map magic.
+ */
+bool isBinaryFieldMap(const std::string& path);
+
+/**
+ * Path of the binary cache associated to an ASCII field map.
+ *
+ * loadDefaultBField looks for this file next to the ASCII map and uses it
+ * when present and not older than the ASCII map.
+ *
+ * @param text_path The path to the ASCII field map.
+ * @return The path of the binary cache.
+ */
+std::string binaryFieldMapCachePath(const std::string& text_path);
+
+/**
+ * Write a binary field map.
+ *
+ * The file is first written to a temporary file next to the destination and
+ * then renamed, so that concurrent jobs never see a partially written map.
+ *
+ * @param path Destination of the binary map.
+ * @param nbins Number of grid points along x, y and z.
+ * @param min Position of the first grid point along each axis.
+ * @param max Upper edge of the last bin along each axis.
+ * @param bx Bx values on the grid, in xyz ordering.
+ * @param by By values on the grid, in xyz ordering.
+ * @param bz Bz values on the grid, in xyz ordering.
+ * @param single_precision Store the field values as floats instead of doubles.
+ */
+void writeBinaryFieldMap(const std::string& path,
+                         const std::array<std::size_t, 3>& nbins,
+                         const std::array<double, 3>& min,
+                         const std::array<double, 3>& max,
+                         const std::vector<double>& bx,
+                         const std::vector<double>& by,
+                         const std::vector<double>& bz,
+                         bool single_precision = false);
+
+/**
+ * Read-only, memory mapped view of a binary field map.
+ *
+ * The file is mapped with MAP_SHARED and PROT_READ, so the pages holding the
+ * grid live in the page cache and are shared between all the processes
+ * running on the same node that map the same file. The view is move-only and
+ * unmaps the file when it goes out of scope.
+ */
+class BFieldMapFile {
+ public:
+  /**
+   * Map a binary field map in memory.
+   *
+   * @param path The path to the binary field map.
+   * @throws std::runtime_error if the file can't be mapped or is not a valid
+   *    binary field map.
+   */
+  explicit BFieldMapFile(const std::string& path);
+
+  /// Unmap the file
+  ~BFieldMapFile();
+
+  BFieldMapFile(const BFieldMapFile&) = delete;
+  BFieldMapFile& operator=(const BFieldMapFile&) = delete;
+  BFieldMapFile(BFieldMapFile&& other) noexcept;
+  BFieldMapFile& operator=(BFieldMapFile&& other) noexcept;
+
+  /// @return The header of the map
+  const BFieldMapHeader& header() const { return *header_; }
+
+  /// @return The total number of grid points
+  std::size_t size() const {
+    return header_->nbins[0] * header_->nbins[1] * header_->nbins[2];
+  }
+
+  /// @return true if the field values are stored as floats
+  bool isSinglePrecision() const { return header_->precision == sizeof(float); }
+
+  /**
+   * Raw pointer to a field component plane.
+   *
+   * @tparam T float or double, must match the stored precision.
+   * @param component 0, 1 or 2 for Bx, By and Bz.
+   */
+  template <typename T>
+  const T* plane(int component) const {
+    return reinterpret_cast<const T*>(data_ + header_->data_offset) +
+           component * size();
+  }
+
+  /**
+   * Field component at a grid point, converted to double.
+   *
+   * @param component 0, 1 or 2 for Bx, By and Bz.
+   * @param index The global index of the grid point in xyz ordering.
+   */
+  double value(int component, std::size_t index) const {
+    return isSinglePrecision() ? plane<float>(component)[index]
+                               : plane<double>(component)[index];
+  }
+
+ private:
+  /// Start of the mapped region
+  const char* data_{nullptr};
+  /// Size of the mapped region in bytes
+  std::size_t length_{0};
+  /// Header at the start of the mapped region
+  const BFieldMapHeader* header_{nullptr};
+};
+
+}  // namespace sim
+}  // namespace tracking
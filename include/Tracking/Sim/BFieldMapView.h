@@ -0,0 +1,238 @@
+#pragma once
+
+//--- C++ ---//
+#include <array>
+#include <memory>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/MagneticField/MagneticFieldContext.hpp"
+#include "Acts/MagneticField/MagneticFieldError.hpp"
+#include "Acts/MagneticField/MagneticFieldProvider.hpp"
+#include "Acts/Utilities/Result.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Default position transformation from the tracking frame to the field map
+ * frame: map (z,x,y) -> (x,y,z) and shift by DIPOLE_OFFSET.
+ */
+struct DefaultPosTransform {
+  Acts::Vector3 operator()(const Acts::Vector3& pos) const {
+    return Acts::Vector3(pos(1), pos(2), pos(0) + DIPOLE_OFFSET);
+  }
+};
+
+/**
+ * Default position transformation with an additional offset of the map,
+ * used for systematic studies of the map position.
+ */
+struct OffsetPosTransform {
+  /// Offset of the map, in the field map frame
+  Acts::Vector3 offset{Acts::Vector3::Zero()};
+
+  Acts::Vector3 operator()(const Acts::Vector3& pos) const {
+    return Acts::Vector3(pos(1) + offset(0), pos(2) + offset(1),
+                         pos(0) + DIPOLE_OFFSET + offset(2));
+  }
+};
+
+/**
+ * Default field transformation from the field map frame to the tracking
+ * frame: map (Bx,By,Bz) -> (Bz,Bx,By).
+ */
+struct DefaultFieldTransform {
+  Acts::Vector3 operator()(const Acts::Vector3& field) const {
+    return Acts::Vector3(field(2), field(0), field(1));
+  }
+};
+
+/**
+ * Default field transformation followed by a scaled rotation of the field,
+ * used for systematic studies of the field.
+ */
+struct RotatedFieldTransform {
+  /// Rotation of the field in the tracking frame, already scaled
+  Acts::RotationMatrix3 rotation{Acts::RotationMatrix3::Identity()};
+
+  Acts::Vector3 operator()(const Acts::Vector3& field) const {
+    return rotation * Acts::Vector3(field(2), field(0), field(1));
+  }
+};
+
+/**
+ * Lightweight magnetic field provider over a shared field grid.
+ *
+ * The grid is stored in the field map frame and is shared between all the
+ * views, so building a view doesn't copy it. The transformations between the
+ * tracking frame and the field map frame are plain functors known at compile
+ * time, so they are inlined in the lookup instead of going through
+ * std::function as in Acts::InterpolatedBFieldMap. The field is interpolated
+ * trilinearly directly on the grid values: the lookup doesn't allocate and
+ * doesn't need any per-call state.
+ *
+ * As for Acts::InterpolatedBFieldMap, positions outside the map return
+ * MagneticFieldError::OutOfBounds and the field is interpolated towards zero
+ * in the last bin of each axis.
+ *
+ * @tparam pos_transform_t Functor mapping a position from the tracking
+ *    frame to the field map frame.
+ * @tparam field_transform_t Functor mapping a field value from the field map
+ *    frame to the tracking frame.
+ */
+template <typename pos_transform_t = DefaultPosTransform,
+          typename field_transform_t = DefaultFieldTransform>
+class BFieldMapView : public Acts::MagneticFieldProvider {
+ public:
+  /// The view doesn't need any per-call state
+  struct Cache {
+    Cache(const Acts::MagneticFieldContext& /*mctx*/) {}
+  };
+
+  /**
+   * Constructor
+   *
+   * @param grid The shared field grid in the field map frame.
+   * @param transform_pos Transformation of the positions to the map frame.
+   * @param transform_field Transformation of the field to the tracking frame.
+   */
+  BFieldMapView(std::shared_ptr<const MagneticFieldGrid3> grid,
+                pos_transform_t transform_pos = pos_transform_t(),
+                field_transform_t transform_field = field_transform_t())
+      : grid_(std::move(grid)),
+        transform_pos_(std::move(transform_pos)),
+        transform_field_(std::move(transform_field)) {
+    auto min = grid_->minPosition();
+    auto max = grid_->maxPosition();
+    auto nbins = grid_->numLocalBins();
+
+    // The strides are taken from the grid itself so that they don't depend
+    // on the internal ordering of the global bins
+    std::size_t origin = grid_->globalBinFromLocalBins({{0, 0, 0}});
+    stride_[0] = grid_->globalBinFromLocalBins({{1, 0, 0}}) - origin;
+    stride_[1] = grid_->globalBinFromLocalBins({{0, 1, 0}}) - origin;
+    stride_[2] = grid_->globalBinFromLocalBins({{0, 0, 1}}) - origin;
+
+    for (int i = 0; i < 3; i++) {
+      min_[i] = min[i];
+      nbins_[i] = nbins[i];
+      inv_step_[i] = nbins[i] / (max[i] - min[i]);
+    }
+
+    // Values of the first bin inside the map (local bins start at 1)
+    values_ = &grid_->at(grid_->globalBinFromLocalBins({{1, 1, 1}}));
+  }
+
+  /// Transform a position from the tracking frame to the field map frame
+  Acts::Vector3 toFieldFrame(const Acts::Vector3& position) const {
+    return transform_pos_(position);
+  }
+
+  /// Transform a field value from the field map frame to the tracking frame
+  Acts::Vector3 toTrackingFrame(const Acts::Vector3& field) const {
+    return transform_field_(field);
+  }
+
+  /// Check if a position in the tracking frame is covered by the map
+  bool isInside(const Acts::Vector3& position) const {
+    Acts::Vector3 map_pos = transform_pos_(position);
+    for (int i = 0; i < 3; i++) {
+      double u = (map_pos(i) - min_[i]) * inv_step_[i];
+      if (!(u >= 0. && u < nbins_[i])) return false;
+    }
+    return true;
+  }
+
+  /// Get the field at a position in the tracking frame, without a cache
+  Acts::Result<Acts::Vector3> getField(const Acts::Vector3& position) const {
+    Acts::Vector3 map_pos = transform_pos_(position);
+
+    std::size_t index = 0;
+    std::array<double, 3> t;
+    for (int i = 0; i < 3; i++) {
+      double u = (map_pos(i) - min_[i]) * inv_step_[i];
+      // Also rejects NaNs
+      if (!(u >= 0. && u < nbins_[i]))
+        return Acts::MagneticFieldError::OutOfBounds;
+      std::size_t bin = static_cast<std::size_t>(u);
+      t[i] = u - bin;
+      index += bin * stride_[i];
+    }
+
+    // Corners of the cell, the upper ones can be in the overflow bins
+    const Acts::Vector3* v = values_ + index;
+    const std::size_t sx = stride_[0], sy = stride_[1], sz = stride_[2];
+
+    Acts::Vector3 c00 = v[0] + t[0] * (v[sx] - v[0]);
+    Acts::Vector3 c01 = v[sz] + t[0] * (v[sx + sz] - v[sz]);
+    Acts::Vector3 c10 = v[sy] + t[0] * (v[sx + sy] - v[sy]);
+    Acts::Vector3 c11 = v[sy + sz] + t[0] * (v[sx + sy + sz] - v[sy + sz]);
+
+    Acts::Vector3 c0 = c00 + t[1] * (c10 - c00);
+    Acts::Vector3 c1 = c01 + t[1] * (c11 - c01);
+
+    return Acts::Result<Acts::Vector3>::success(
+        transform_field_(c0 + t[2] * (c1 - c0)));
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::makeCache
+  Acts::MagneticFieldProvider::Cache makeCache(
+      const Acts::MagneticFieldContext& mctx) const override {
+    return Acts::MagneticFieldProvider::Cache(std::in_place_type<Cache>, mctx);
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::getField
+  Acts::Result<Acts::Vector3> getField(
+      const Acts::Vector3& position,
+      Acts::MagneticFieldProvider::Cache& /*cache*/) const override {
+    return getField(position);
+  }
+
+  /**
+   * @copydoc Acts::MagneticFieldProvider::getFieldGradient
+   *
+   * @note The gradient is not calculated, as for Acts::InterpolatedBFieldMap.
+   */
+  Acts::Result<Acts::Vector3> getFieldGradient(
+      const Acts::Vector3& position, Acts::ActsMatrix<3, 3>& /*derivative*/,
+      Acts::MagneticFieldProvider::Cache& /*cache*/) const override {
+    return getField(position);
+  }
+
+  /// @return The shared field grid
+  const MagneticFieldGrid3& grid() const { return *grid_; }
+
+ private:
+  /// The shared field grid, in the field map frame
+  std::shared_ptr<const MagneticFieldGrid3> grid_;
+  /// Transformation of the positions to the field map frame
+  pos_transform_t transform_pos_;
+  /// Transformation of the field to the tracking frame
+  field_transform_t transform_field_;
+
+  /// Lower edge of the map along each axis
+  std::array<double, 3> min_;
+  /// Inverse of the bin width along each axis
+  std::array<double, 3> inv_step_;
+  /// Number of bins along each axis, without under/overflow
+  std::array<double, 3> nbins_;
+  /// Distance between neighbouring bins along each axis
+  std::array<std::size_t, 3> stride_;
+  /// Grid values at the first bin inside the map
+  const Acts::Vector3* values_{nullptr};
+};
+
+/// View with the default transformations
+using DefaultBFieldMapView =
+    BFieldMapView<DefaultPosTransform, DefaultFieldTransform>;
+
+/// View with an offset of the map and a scaled rotation of the field
+using SystematicBFieldMapView =
+    BFieldMapView<OffsetPosTransform, RotatedFieldTransform>;
+
+}  // namespace sim
+}  // namespace tracking
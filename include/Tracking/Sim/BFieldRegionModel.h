@@ -0,0 +1,248 @@
+#pragma once
+
+//--- C++ ---//
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/Definitions/Units.hpp"
+#include "Acts/MagneticField/MagneticFieldContext.hpp"
+#include "Acts/MagneticField/MagneticFieldProvider.hpp"
+#include "Acts/Utilities/Result.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Sim/BFieldMapView.h"
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Linear model of the field over a box of cells of the field map.
+ *
+ * Everything is expressed in the field map frame.
+ */
+struct BFieldRegion {
+  /// First cell of the box along each axis
+  std::array<std::int32_t, 3> lo;
+  /// One past the last cell of the box along each axis
+  std::array<std::int32_t, 3> hi;
+  /// Center of the box
+  Acts::Vector3 center;
+  /// Field at the center of the box
+  Acts::Vector3 value;
+  /// Gradient of the field, d B_row / d x_col
+  Acts::ActsMatrix<3, 3> gradient;
+  /// Largest deviation of any field component from the interpolated map
+  double max_deviation;
+
+  /// Evaluate the model at a position inside the box
+  Acts::Vector3 eval(const Acts::Vector3& pos) const {
+    return value + gradient * (pos - center);
+  }
+};
+
+/**
+ * Piecewise linear (or constant) model of the field map.
+ *
+ * The map is recursively split into boxes of whole cells, each one fitted
+ * with a linear (order 1) or constant (order 0) model, until the model
+ * deviates from the interpolated map by less than the tolerance. Boxes that
+ * can't reach the tolerance before getting smaller than a minimum number of
+ * cells are left uncovered, and the field there has to be taken from the map.
+ *
+ * Within a cell both the trilinear interpolation of the map and the model
+ * are multilinear functions of the position, and so is their difference: its
+ * extrema are on the corners of the cell. The deviation evaluated on the grid
+ * points of a box is then the exact largest deviation of each field
+ * component over the whole box, and the tolerance is guaranteed everywhere
+ * in the covered regions.
+ *
+ * The model is meant to be fitted offline (see ldmx-fit-fieldmap) and stored
+ * in a text file next to the map.
+ */
+class BFieldRegionModel {
+ public:
+  /// Configuration of the fit
+  struct Config {
+    /// Largest deviation allowed for each field component
+    double tolerance{1e-3 * Acts::UnitConstants::T};
+    /// Order of the model, 0 (constant) or 1 (linear)
+    int order{1};
+    /// Boxes are not split below this number of cells along an axis
+    int min_cells{2};
+  };
+
+  /**
+   * Fit the model on a field grid in the field map frame.
+   *
+   * @param grid The field grid, as built by makeFieldGridXYZ.
+   * @param cfg The configuration of the fit.
+   * @return The fitted model.
+   */
+  static BFieldRegionModel fit(const MagneticFieldGrid3& grid,
+                               const Config& cfg);
+
+  /**
+   * Read a model written by write.
+   *
+   * @param path The path to the model file.
+   * @throws std::runtime_error if the file can't be read.
+   */
+  static BFieldRegionModel read(const std::string& path);
+
+  /**
+   * Write the model in text format. Lengths are in mm and fields in T.
+   *
+   * @param path The path to the model file.
+   * @throws std::runtime_error if the file can't be written.
+   */
+  void write(const std::string& path) const;
+
+  /// @return true if the model was fitted on a grid with the same binning
+  bool matches(const MagneticFieldGrid3& grid) const;
+
+  /**
+   * Find the region covering a position in the field map frame.
+   *
+   * @param pos The position in the field map frame.
+   * @return The region, or nullptr if the position is not covered by the
+   *    model.
+   */
+  const BFieldRegion* find(const Acts::Vector3& pos) const {
+    std::int32_t cell = 0;
+    for (int i = 0; i < 3; i++) {
+      double u = (pos(i) - min_[i]) * inv_step_[i];
+      // Also rejects NaNs
+      if (!(u >= 0. && u < nbins_[i])) return nullptr;
+      cell = cell * nbins_[i] + static_cast<std::int32_t>(u);
+    }
+    std::int32_t region = cell_region_[cell];
+    return region < 0 ? nullptr : &regions_[region];
+  }
+
+  /// @return The regions of the model
+  const std::vector<BFieldRegion>& regions() const { return regions_; }
+
+  /// @return The fraction of the cells of the map covered by the model
+  double coverage() const;
+
+  /// @return The tolerance the model was fitted with
+  double tolerance() const { return tolerance_; }
+
+ private:
+  /// Empty model over the binning of a field map
+  BFieldRegionModel(const std::array<double, 3>& min,
+                    const std::array<double, 3>& max,
+                    const std::array<std::int32_t, 3>& nbins, double tolerance);
+
+  /// Add a region and mark its cells as covered
+  void addRegion(const BFieldRegion& region);
+
+  /// Lower edge of the map along each axis
+  std::array<double, 3> min_;
+  /// Upper edge of the map along each axis
+  std::array<double, 3> max_;
+  /// Inverse of the bin width along each axis
+  std::array<double, 3> inv_step_;
+  /// Number of cells along each axis
+  std::array<std::int32_t, 3> nbins_;
+  /// Largest deviation allowed for each field component
+  double tolerance_;
+  /// The regions of the model
+  std::vector<BFieldRegion> regions_;
+  /// Index of the region covering each cell, -1 if not covered
+  std::vector<std::int32_t> cell_region_;
+};
+
+/**
+ * Magnetic field provider using the region model where it is available and
+ * the interpolated map elsewhere.
+ *
+ * The lookup of a covered position costs one table lookup and a 3x3
+ * matrix-vector product instead of the eight corners of the interpolation.
+ *
+ * @tparam pos_transform_t Functor mapping a position from the tracking
+ *    frame to the field map frame.
+ * @tparam field_transform_t Functor mapping a field value from the field map
+ *    frame to the tracking frame.
+ */
+template <typename pos_transform_t = DefaultPosTransform,
+          typename field_transform_t = DefaultFieldTransform>
+class BFieldHybridMap : public Acts::MagneticFieldProvider {
+ public:
+  /// The provider doesn't need any per-call state
+  struct Cache {
+    Cache(const Acts::MagneticFieldContext& /*mctx*/) {}
+  };
+
+  /**
+   * Constructor
+   *
+   * @param grid The shared field grid in the field map frame.
+   * @param model The region model fitted on the grid.
+   * @param transform_pos Transformation of the positions to the map frame.
+   * @param transform_field Transformation of the field to the tracking frame.
+   */
+  BFieldHybridMap(std::shared_ptr<const MagneticFieldGrid3> grid,
+                  std::shared_ptr<const BFieldRegionModel> model,
+                  pos_transform_t transform_pos = pos_transform_t(),
+                  field_transform_t transform_field = field_transform_t())
+      : map_(std::move(grid), std::move(transform_pos),
+             std::move(transform_field)),
+        model_(std::move(model)) {}
+
+  /// Get the field at a position in the tracking frame, without a cache
+  Acts::Result<Acts::Vector3> getField(const Acts::Vector3& position) const {
+    Acts::Vector3 map_pos = map_.toFieldFrame(position);
+    const BFieldRegion* region = model_->find(map_pos);
+    if (region == nullptr) return map_.getField(position);
+    return Acts::Result<Acts::Vector3>::success(
+        map_.toTrackingFrame(region->eval(map_pos)));
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::makeCache
+  Acts::MagneticFieldProvider::Cache makeCache(
+      const Acts::MagneticFieldContext& mctx) const override {
+    return Acts::MagneticFieldProvider::Cache(std::in_place_type<Cache>, mctx);
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::getField
+  Acts::Result<Acts::Vector3> getField(
+      const Acts::Vector3& position,
+      Acts::MagneticFieldProvider::Cache& /*cache*/) const override {
+    return getField(position);
+  }
+
+  /**
+   * @copydoc Acts::MagneticFieldProvider::getFieldGradient
+   *
+   * @note The gradient is not calculated, as for Acts::InterpolatedBFieldMap.
+   */
+  Acts::Result<Acts::Vector3> getFieldGradient(
+      const Acts::Vector3& position, Acts::ActsMatrix<3, 3>& /*derivative*/,
+      Acts::MagneticFieldProvider::Cache& /*cache*/) const override {
+    return getField(position);
+  }
+
+ private:
+  /// The interpolated map, used outside of the regions of the model
+  BFieldMapView<pos_transform_t, field_transform_t> map_;
+  /// The region model, in the field map frame
+  std::shared_ptr<const BFieldRegionModel> model_;
+};
+
+/// Hybrid map with the default transformations
+using DefaultBFieldHybridMap =
+    BFieldHybridMap<DefaultPosTransform, DefaultFieldTransform>;
+
+/// Hybrid map with an offset of the map and a scaled rotation of the field
+using SystematicBFieldHybridMap =
+    BFieldHybridMap<OffsetPosTransform, RotatedFieldTransform>;
+
+}  // namespace sim
+}  // namespace tracking
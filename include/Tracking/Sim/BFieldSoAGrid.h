@@ -0,0 +1,229 @@
+#pragma once
+
+//--- C++ ---//
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/MagneticField/MagneticFieldContext.hpp"
+#include "Acts/MagneticField/MagneticFieldError.hpp"
+#include "Acts/MagneticField/MagneticFieldProvider.hpp"
+#include "Acts/Utilities/Result.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Sim/BFieldMapView.h"
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Field grid in structure-of-arrays layout.
+ *
+ * The field components are stored in three separate planes (Bx, By, Bz) in
+ * the field map frame, so that the eight corners of a cell needed by the
+ * trilinear interpolation are gathered from contiguous memory, one component
+ * at a time. The planes have one extra layer of zeros at the upper edge of
+ * each axis, which plays the role of the overflow bins of the Acts grid, so
+ * the interpolation matches Acts::InterpolatedBFieldMap everywhere.
+ *
+ * The batched interpolation is vectorized with AVX-512 or AVX2 when the
+ * library is compiled for a target supporting them (see the
+ * TRACKING_NATIVE_ARCH cmake option), and falls back to a scalar loop
+ * otherwise.
+ *
+ * @tparam T The storage type of the field values, float or double. The
+ *    interpolation is always done in double precision.
+ */
+template <typename T>
+class BFieldSoAGrid {
+ public:
+  /**
+   * Build the planes from a field grid in the field map frame.
+   *
+   * @param grid The field grid, as built by makeFieldGridXYZ.
+   * @throws std::runtime_error if the grid is too large to be indexed with
+   *    32 bit integers.
+   */
+  explicit BFieldSoAGrid(const MagneticFieldGrid3& grid);
+
+  /**
+   * Interpolate the field at a single position in the field map frame.
+   *
+   * @param[in] pos The position in the field map frame.
+   * @param[out] field The interpolated field in the field map frame.
+   * @return false if the position is outside of the map.
+   */
+  bool interpolate(const Acts::Vector3& pos, Acts::Vector3& field) const;
+
+  /**
+   * Interpolate the field at a batch of positions in the field map frame.
+   *
+   * Inputs and outputs are in structure-of-arrays layout. The field at
+   * positions outside of the map is set to zero.
+   *
+   * @param[in] x, y, z The coordinates of the positions.
+   * @param[out] bx, by, bz The components of the interpolated field.
+   * @param[out] inside Set to 1 if the position is inside the map, 0
+   *    otherwise.
+   * @param[in] n The number of positions.
+   * @return The number of positions inside the map.
+   */
+  std::size_t interpolate(const double* x, const double* y, const double* z,
+                          double* bx, double* by, double* bz,
+                          std::uint8_t* inside, std::size_t n) const;
+
+  /// @return The name of the batched kernel compiled in
+  static const char* kernel();
+
+  /// @return The memory used by the planes in bytes
+  std::size_t memory() const { return 3 * planes_[0].size() * sizeof(T); }
+
+ private:
+  /// Lower edge of the map along each axis
+  std::array<double, 3> min_;
+  /// Inverse of the bin width along each axis
+  std::array<double, 3> inv_step_;
+  /// Number of bins along each axis
+  std::array<double, 3> nbins_;
+  /// Distance between neighbouring grid points along each axis
+  std::array<std::int32_t, 3> stride_;
+  /// The Bx, By and Bz planes
+  std::array<std::vector<T>, 3> planes_;
+};
+
+extern template class BFieldSoAGrid<float>;
+extern template class BFieldSoAGrid<double>;
+
+/**
+ * Magnetic field provider over a shared structure-of-arrays field grid.
+ *
+ * Same transformations as BFieldMapView, with an additional batched lookup
+ * that evaluates many positions in one call, e.g. the four RK4 stage points
+ * or the points of an extrapolation.
+ *
+ * @tparam pos_transform_t Functor mapping a position from the tracking
+ *    frame to the field map frame.
+ * @tparam field_transform_t Functor mapping a field value from the field map
+ *    frame to the tracking frame.
+ * @tparam T The storage type of the field values, float or double.
+ */
+template <typename pos_transform_t = DefaultPosTransform,
+          typename field_transform_t = DefaultFieldTransform,
+          typename T = double>
+class BFieldSoAMap : public Acts::MagneticFieldProvider {
+ public:
+  /// The provider doesn't need any per-call state
+  struct Cache {
+    Cache(const Acts::MagneticFieldContext& /*mctx*/) {}
+  };
+
+  /**
+   * Constructor
+   *
+   * @param grid The shared SoA field grid in the field map frame.
+   * @param transform_pos Transformation of the positions to the map frame.
+   * @param transform_field Transformation of the field to the tracking frame.
+   */
+  BFieldSoAMap(std::shared_ptr<const BFieldSoAGrid<T>> grid,
+               pos_transform_t transform_pos = pos_transform_t(),
+               field_transform_t transform_field = field_transform_t())
+      : grid_(std::move(grid)),
+        transform_pos_(std::move(transform_pos)),
+        transform_field_(std::move(transform_field)) {}
+
+  /// Get the field at a position in the tracking frame, without a cache
+  Acts::Result<Acts::Vector3> getField(const Acts::Vector3& position) const {
+    Acts::Vector3 field;
+    if (!grid_->interpolate(transform_pos_(position), field))
+      return Acts::MagneticFieldError::OutOfBounds;
+    return Acts::Result<Acts::Vector3>::success(transform_field_(field));
+  }
+
+  /**
+   * Get the field at a batch of positions in the tracking frame
+   *
+   * @param[in] positions The positions in the tracking frame.
+   * @param[out] fields The field at each position, zero outside of the map.
+   * @param[in] n The number of positions.
+   * @param[out] inside Optional, set to 1 if the position is inside the map
+   *    and to 0 otherwise.
+   * @return The number of positions inside the map.
+   */
+  std::size_t getField(const Acts::Vector3* positions, Acts::Vector3* fields,
+                       std::size_t n, std::uint8_t* inside = nullptr) const {
+    // Positions are transformed and evaluated in chunks kept on the stack
+    constexpr std::size_t kChunk = 64;
+    double x[kChunk], y[kChunk], z[kChunk];
+    double bx[kChunk], by[kChunk], bz[kChunk];
+    std::uint8_t in[kChunk];
+
+    std::size_t n_inside = 0;
+    for (std::size_t start = 0; start < n; start += kChunk) {
+      std::size_t m = std::min(kChunk, n - start);
+      for (std::size_t i = 0; i < m; i++) {
+        Acts::Vector3 map_pos = transform_pos_(positions[start + i]);
+        x[i] = map_pos(0);
+        y[i] = map_pos(1);
+        z[i] = map_pos(2);
+      }
+
+      n_inside += grid_->interpolate(x, y, z, bx, by, bz, in, m);
+
+      for (std::size_t i = 0; i < m; i++) {
+        fields[start + i] = in[i]
+                                ? transform_field_(Acts::Vector3(bx[i], by[i], bz[i]))
+                                : Acts::Vector3::Zero();
+        if (inside) inside[start + i] = in[i];
+      }
+    }
+    return n_inside;
+  }
+
+  /// @copydoc getField(const Acts::Vector3*, Acts::Vector3*, std::size_t, std::uint8_t*) const
+  std::size_t getField(const std::vector<Acts::Vector3>& positions,
+                       std::vector<Acts::Vector3>& fields) const {
+    fields.resize(positions.size());
+    return getField(positions.data(), fields.data(), positions.size());
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::makeCache
+  Acts::MagneticFieldProvider::Cache makeCache(
+      const Acts::MagneticFieldContext& mctx) const override {
+    return Acts::MagneticFieldProvider::Cache(std::in_place_type<Cache>, mctx);
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::getField
+  Acts::Result<Acts::Vector3> getField(
+      const Acts::Vector3& position,
+      Acts::MagneticFieldProvider::Cache& /*cache*/) const override {
+    return getField(position);
+  }
+
+  /**
+   * @copydoc Acts::MagneticFieldProvider::getFieldGradient
+   *
+   * @note The gradient is not calculated, as for Acts::InterpolatedBFieldMap.
+   */
+  Acts::Result<Acts::Vector3> getFieldGradient(
+      const Acts::Vector3& position, Acts::ActsMatrix<3, 3>& /*derivative*/,
+      Acts::MagneticFieldProvider::Cache& /*cache*/) const override {
+    return getField(position);
+  }
+
+ private:
+  /// The shared SoA field grid, in the field map frame
+  std::shared_ptr<const BFieldSoAGrid<T>> grid_;
+  /// Transformation of the positions to the field map frame
+  pos_transform_t transform_pos_;
+  /// Transformation of the field to the tracking frame
+  field_transform_t transform_field_;
+};
+
+}  // namespace sim
+}  // namespace tracking
@@ -8,16 +8,20 @@
 #include "Acts/Utilities/Result.hpp"
 #include "Acts/Utilities/detail/Grid.hpp"
 
+#include "Tracking/Sim/BFieldMapIO.h"
+
 #include <functional>
 #include <fstream>
 #include <iostream>
 
 static const double DIPOLE_OFFSET  = 400.; //400 mm
 
+using MagneticFieldGrid3 =
+  Acts::detail::Grid<Acts::Vector3, Acts::detail::EquidistantAxis,
+                     Acts::detail::EquidistantAxis, Acts::detail::EquidistantAxis>;
+
 using InterpolatedMagneticField3 =
-  Acts::InterpolatedBFieldMap<Acts::detail::Grid<
-  Acts::Vector3, Acts::detail::EquidistantAxis,
-  Acts::detail::EquidistantAxis, Acts::detail::EquidistantAxis>>;
+  Acts::InterpolatedBFieldMap<MagneticFieldGrid3>;
 
 using GenericTransformPos = std::function<Acts::Vector3(const Acts::Vector3&)>;
 using GenericTransformBField = std::function<Acts::Vector3(const Acts::Vector3&,
@@ -48,15 +52,30 @@ Acts::Vector3 default_transformBField(const Acts::Vector3& field,
 
 size_t localToGlobalBin_xyz(std::array<size_t, 3> bins, std::array<size_t, 3> sizes);
 
-inline InterpolatedMagneticField3 rotateFieldMapXYZ(const std::function<size_t(std::array<size_t, 3> binsXYZ,
-                                                    std::array<size_t, 3> nBinsXYZ)>&
-                                                    localToGlobalBin,
-                                                    std::vector<double> xPos, std::vector<double> yPos,
-                                                    std::vector<double> zPos, std::vector<Acts::Vector3> bField,
-                                                    double lengthUnit, double BFieldUnit, bool firstOctant,
-                                                    GenericTransformPos transformPosition,
-                                                    GenericTransformBField transformMagneticField
-                                                    ){
+/**
+ * Read the grid points and field values of an ASCII field map.
+ * Lines before the one containing the word 'Header' are skipped, as well as
+ * empty lines and lines starting with '%', '#' or a space.
+ * Values are returned as they are in the file, without any unit conversion.
+ */
+
+void readFieldMapText(const std::string& fieldMapFile,
+                      std::vector<double>& xPos, std::vector<double>& yPos,
+                      std::vector<double>& zPos,
+                      std::vector<Acts::Vector3>& bField);
+
+/**
+ * Build the field grid in the field map frame
+ * The axes are sorted and deduplicated and the values are converted to the ACTS units.
+ * No transformation to the tracking frame is applied.
+ */
+
+inline MagneticFieldGrid3 makeFieldGridXYZ(const std::function<size_t(std::array<size_t, 3> binsXYZ,
+                                           std::array<size_t, 3> nBinsXYZ)>&
+                                           localToGlobalBin,
+                                           std::vector<double> xPos, std::vector<double> yPos,
+                                           std::vector<double> zPos, const std::vector<Acts::Vector3>& bField,
+                                           double lengthUnit, double BFieldUnit, bool firstOctant) {
   
   // [1] Create Grid
   // Sort the values
@@ -115,10 +134,7 @@ inline InterpolatedMagneticField3 rotateFieldMapXYZ(const std::function<size_t(s
   Acts::detail::EquidistantAxis zAxis(zMin * lengthUnit, zMax * lengthUnit,
                                       nBinsZ);
   // Create the grid
-  using Grid_t =
-      Acts::detail::Grid<Acts::Vector3, Acts::detail::EquidistantAxis,
-                         Acts::detail::EquidistantAxis,
-                         Acts::detail::EquidistantAxis>;
+  using Grid_t = MagneticFieldGrid3;
   Grid_t grid(
       std::make_tuple(std::move(xAxis), std::move(yAxis), std::move(zAxis)));
 
@@ -155,6 +171,24 @@ inline InterpolatedMagneticField3 rotateFieldMapXYZ(const std::function<size_t(s
   }
   grid.setExteriorBins(Acts::Vector3::Zero());
 
+  return grid;
+}
+
+inline InterpolatedMagneticField3 rotateFieldMapXYZ(const std::function<size_t(std::array<size_t, 3> binsXYZ,
+                                                    std::array<size_t, 3> nBinsXYZ)>&
+                                                    localToGlobalBin,
+                                                    std::vector<double> xPos, std::vector<double> yPos,
+                                                    std::vector<double> zPos, std::vector<Acts::Vector3> bField,
+                                                    double lengthUnit, double BFieldUnit, bool firstOctant,
+                                                    GenericTransformPos transformPosition,
+                                                    GenericTransformBField transformMagneticField
+                                                    ){
+
+  // [1] - [2] Create the grid and set the bField values
+  auto grid = makeFieldGridXYZ(localToGlobalBin, std::move(xPos), std::move(yPos),
+                               std::move(zPos), bField, lengthUnit, BFieldUnit,
+                               firstOctant);
+
   // [3] Create the transformation for the position
   // map (z,x,y) -> (x,y,z)
 
@@ -190,7 +224,7 @@ inline InterpolatedMagneticField3 rotateFieldMapXYZ(const std::function<size_t(s
   
   // [5] Create the mapper and BField Service
   // with the transformations passed from main producer
-  return Acts::InterpolatedBFieldMap<Grid_t>(
+  return InterpolatedMagneticField3(
       {transformPosition, transformMagneticField, std::move(grid)});
   
   
@@ -215,46 +249,8 @@ inline InterpolatedMagneticField3 makeMagneticFieldMapXyzFromText(std::function<
   std::vector<double> zPos;
   // components of magnetic field on grid points
   std::vector<Acts::Vector3> bField;
-  
-  constexpr size_t kDefaultSize = 1 << 15;
-  // reserve estimated size
-  xPos.reserve(kDefaultSize);
-  yPos.reserve(kDefaultSize);
-  zPos.reserve(kDefaultSize);
-  bField.reserve(kDefaultSize);
-  // [1] Read in file and fill values
-  std::ifstream map_file(fieldMapFile.c_str(), std::ios::in);
-  std::string line;
-  double x = 0., y = 0., z = 0.;
-  double bx = 0., by = 0., bz = 0.;
-
-  bool headerFound = false;
-  
-  while (std::getline(map_file, line)) {
-    if (line.empty() || line[0] == '%' || line[0] == '#' || line[0] == ' ' ||
-        line.find_first_not_of(' ') == std::string::npos    || !headerFound) {
-      if (line.find("Header") != std::string::npos)
-        headerFound = true;
-      continue;
-    }
-    std::istringstream tmp(line);
-    tmp >> x >> y >> z >> bx >> by >> bz;
-    
-    xPos.push_back(x);
-    yPos.push_back(y);
-    zPos.push_back(z);
-    bField.push_back(Acts::Vector3(bx, by, bz));
-  }
-  map_file.close();
 
-  if (!headerFound) {
-    std::cout<<"MAP LOADING ERROR:: line containing the word 'Header' not found in the BMap."<<std::endl;
-  }
-  
-  xPos.shrink_to_fit();
-  yPos.shrink_to_fit();
-  zPos.shrink_to_fit();
-  bField.shrink_to_fit();
+  readFieldMapText(fieldMapFile, xPos, yPos, zPos, bField);
 
   if (rotateAxes) {
     return rotateFieldMapXYZ(localToGlobalBin, xPos, yPos, zPos, bField,
@@ -267,12 +263,63 @@ inline InterpolatedMagneticField3 makeMagneticFieldMapXyzFromText(std::function<
   
 }
 
+/**
+ * Convert an ASCII field map to the binary format of BFieldMapIO.h.
+ * The axes are sorted and deduplicated and the units are converted as done
+ * by rotateFieldMapXYZ, so the binary map can be loaded without any further
+ * processing. The default units are the ones used by loadDefaultBField.
+ */
+
+void convertFieldMapToBinary(const std::string& fieldMapFile,
+                             const std::string& binaryFile,
+                             Acts::ActsScalar lengthUnit = 1. * Acts::UnitConstants::mm,
+                             Acts::ActsScalar BFieldUnit = 1000. * Acts::UnitConstants::T,
+                             bool singlePrecision = false);
+
+/**
+ * Build the field grid from a memory mapped binary map.
+ * The grid values are copied directly from the mapped field planes.
+ */
+
+MagneticFieldGrid3 makeFieldGridFromBinary(const tracking::sim::BFieldMapFile& fieldMap);
+
+/**
+ * Build the interpolated field map from a memory mapped binary map.
+ */
+
+InterpolatedMagneticField3 makeMagneticFieldMapXyzFromBinary(const tracking::sim::BFieldMapFile& fieldMap,
+                                                             GenericTransformPos transformPosition,
+                                                             GenericTransformBField transformMagneticField);
+
+/**
+ * Find the binary version of a field map.
+ * Returns the path itself if it is a binary map, the path of its binary cache
+ * if that exists and is not older than the ASCII map, or an empty string.
+ */
+
+std::string findBinaryFieldMap(const std::string& fieldMapFile);
+
+/**
+ * Load the default field map as a grid in the field map frame.
+ * The binary version of the map is used when available.
+ */
+
+MagneticFieldGrid3 loadDefaultBFieldGrid(const std::string& fieldMapFile);
+
 inline InterpolatedMagneticField3 loadDefaultBField(const std::string& fieldMapFile,
                                                     GenericTransformPos transformPosition,
                                                     GenericTransformBField transformMagneticField) {
   //std::function<Acts::Vector3(const Acts::Vector3&, float)> transformPosition,
   //std::function<Acts::Vector3(const Acts::Vector3&,const Acts::Vector3&)> transformMagneticField
 
+  // Skip the parsing of the ASCII map if a binary version is available
+  std::string binaryFile = findBinaryFieldMap(fieldMapFile);
+  if (!binaryFile.empty()) {
+    return makeMagneticFieldMapXyzFromBinary(tracking::sim::BFieldMapFile(binaryFile),
+                                             transformPosition,
+                                             transformMagneticField);
+  }
+
   return makeMagneticFieldMapXyzFromText(
       std::move(localToGlobalBin_xyz),
       transformPosition,
@@ -0,0 +1,73 @@
+#pragma once
+
+//--- C++ ---//
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace tracking {
+namespace sim {
+namespace fastmath {
+
+/**
+ * Single precision math functions for the vectorized loops.
+ *
+ * The calls to std::exp and std::erf are not vectorized by the compiler
+ * without -ffast-math, since the vector versions from libmvec are only
+ * declared then. These are polynomial or rational approximations written as
+ * straight code, without calls or branches, so the loops using them are
+ * vectorized, and they give the same result in vector and scalar code.
+ * The clamping of the arguments needs -fno-trapping-math to be vectorized,
+ * see the Tracking CMakeLists.txt.
+ */
+
+/**
+ * Exponential, with the reduction and polynomial of the Cephes expf,
+ * within 2 ulp. The argument is clamped to [-87, 88].
+ */
+inline float exp(float x) {
+  x = std::min(std::max(x, -87.f), 88.f);
+  // x = n ln2 + r, with |r| <= ln2 / 2. Adding and subtracting 1.5 * 2^23
+  // rounds to the nearest integer without a conversion or a branch.
+  float n = (x * 1.44269504088896341f + 12582912.f) - 12582912.f;
+  float r = x - n * 0.693359375f + n * 2.12194440e-4f;
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  float y = p * r * r + r + 1.f;
+  // Scale by 2^n
+  std::uint32_t bits = std::uint32_t(std::int32_t(n) + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return y * scale;
+}
+
+/**
+ * Error function, with the rational approximation of Eigen's
+ * generic_fast_erf_float, within 4e-7. The argument is clamped to
+ * [-4, 4], outside of which erf is +-1 in single precision.
+ */
+inline float erf(float x) {
+  x = std::min(std::max(x, -4.f), 4.f);
+  float x2 = x * x;
+  float p = -2.72614225801306e-10f;
+  p = p * x2 + 2.77068142495902e-08f;
+  p = p * x2 - 2.10102402082508e-06f;
+  p = p * x2 - 5.69250639462346e-05f;
+  p = p * x2 - 7.34990630326855e-04f;
+  p = p * x2 - 2.95459980854025e-03f;
+  p = p * x2 - 1.60960333262415e-02f;
+  float q = -1.45660718464996e-05f;
+  q = q * x2 - 2.13374055278905e-04f;
+  q = q * x2 - 1.68282697438203e-03f;
+  q = q * x2 - 7.37332916720468e-03f;
+  q = q * x2 - 1.42647390514189e-02f;
+  return x * p / q;
+}
+
+}  // namespace fastmath
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,72 @@
+#pragma once
+
+//--- C++ ---//
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//--- Tracking ---//
+#include "Tracking/Event/Track.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Bitset over the measurement indices of an event, flagging the hits already
+ * used by the good tracks of a previous tracking pass.
+ *
+ * The mask is rebuilt for every event from the track collections of the
+ * previous passes, which hold the indices of their measurements. The seed
+ * finder and the CKF of the next pass build it with the same cuts, so both
+ * only see the unused hits.
+ */
+class HitMask {
+ public:
+  /// Quality cuts on the tracks whose hits are masked
+  struct Config {
+    /// Minimum number of hits on the track
+    int min_nhits{7};
+    /// Maximum chi2 / ndf of the track
+    double max_chi2_ndf{5.};
+  };
+
+  HitMask() = default;
+  explicit HitMask(const Config& cfg) : cfg_(cfg) {}
+
+  /**
+   * Clear the mask for a new event
+   *
+   * @param n_measurements number of measurements in the event
+   */
+  void reset(std::size_t n_measurements) {
+    n_measurements_ = n_measurements;
+    words_.assign((n_measurements + 63) / 64, 0);
+  }
+
+  /**
+   * Mask the hits of the tracks passing the quality cuts
+   *
+   * @param tracks the tracks of a previous pass, on the same measurements
+   * @return the number of tracks whose hits were masked
+   */
+  std::size_t mask(const std::vector<ldmx::Track>& tracks);
+
+  /// @return true if the measurement is used by a good track
+  bool used(std::size_t index) const {
+    return index < n_measurements_ &&
+           (words_[index >> 6] >> (index & 63)) & std::uint64_t{1};
+  }
+
+  /// @return the number of masked measurements
+  std::size_t count() const;
+
+ private:
+  Config cfg_;
+  /// Number of measurements of the event
+  std::size_t n_measurements_{0};
+  /// One bit per measurement
+  std::vector<std::uint64_t> words_;
+};
+
+}  // namespace sim
+}  // namespace tracking
@@ -1,6 +1,8 @@
 #ifndef LDMXMEASUREMENTCALIBRATOR_H_
 #define LDMXMEASUREMENTCALIBRATOR_H_
 
+#include <cassert>
+#include <cstddef>
 #include <vector>
 #include "Tracking/Sim/LdmxSpacePoint.h"
 #include "Acts/EventData/MultiTrajectory.hpp"
@@ -29,6 +31,37 @@
 
 namespace tracking {
 namespace sim {
+
+  /// Compact copy of the local measurements of an event, as used by the
+  /// calibration. Built once per event so that the calibration, which is
+  /// called for every candidate measurement on every CKF branch, reads
+  /// 16 bytes per measurement instead of a full ldmx::Measurement.
+  struct MeasurementCalibrationView {
+    std::vector<float> u;
+    std::vector<float> v;
+    std::vector<float> cov_uu;
+    std::vector<float> cov_vv;
+
+    /// Fill the view from the measurements of an event. The memory of the
+    /// previous event is reused.
+    void fill(const std::vector<ldmx::Measurement>& measurements) {
+      const std::size_t n = measurements.size();
+      u.resize(n);
+      v.resize(n);
+      cov_uu.resize(n);
+      cov_vv.resize(n);
+      for (std::size_t i = 0; i < n; i++) {
+        const auto local_pos = measurements[i].getLocalPosition();
+        const auto local_cov = measurements[i].getLocalCovariance();
+        u[i] = local_pos[0];
+        v[i] = local_pos[1];
+        cov_uu[i] = local_cov[0];
+        cov_vv[i] = local_cov[1];
+      }
+    }
+
+    std::size_t size() const { return u.size(); }
+  };
     
   class LdmxMeasurementCalibrator {
 
@@ -41,6 +74,11 @@ namespace sim {
     LdmxMeasurementCalibrator(const std::vector<ldmx::Measurement>& measurements) {
       m_measurements = &measurements;
     }
+
+      //Calibrate from the compact view of the measurements of the event
+    LdmxMeasurementCalibrator(const MeasurementCalibrationView& view) {
+      m_view = &view;
+    }
       
       /// Find the measurement corresponding to the source link. Uses a 2D measurement, cov-matrix and projection
       ///
@@ -53,32 +91,23 @@ namespace sim {
         ActsExamples::IndexSourceLink sourceLink =
             trackState.getUncalibratedSourceLink().get<ActsExamples::IndexSourceLink>();
         
-        assert(m_measurements and
-               "Undefined measurement container in LdmxMeasurementCalibrator");
-        assert((sourceLink.index() < m_measurements->size()) and
-               "Source link index is outside the container bounds in LdmxMeasurementCalibrator");
-
-        auto meas = m_measurements->at(sourceLink.index());
+        float u, v, cov_uu, cov_vv;
+        local(sourceLink.index(), u, v, cov_uu, cov_vv);
         
         trackState.calibrated<2>().setZero();
 
-        Acts::Vector2 local_pos{meas.getLocalPosition()[0], meas.getLocalPosition()[1]};
+        Acts::Vector2 local_pos{u, v};
         trackState.calibrated<2>().head<2>() = local_pos;
         //trackState.data().measdim = 2;
         trackState.calibratedCovariance<2>().setZero();
 
         Acts::SymMatrix2 local_cov;
         local_cov.setZero();
-        local_cov(0,0) = meas.getLocalCovariance()[0];
-        local_cov(1,1) = meas.getLocalCovariance()[1];
+        local_cov(0,0) = cov_uu;
+        local_cov(1,1) = cov_vv;
         trackState.calibratedCovariance<2>().block<2,2>(0,0) = local_cov;
 
-        Acts::ActsMatrix<2,6> projector;
-        projector.setZero();
-        projector(0,0) = 1.;
-        projector(1,1) = 1.;
-        
-        trackState.setProjector(projector);
+        trackState.setProjector(projector());
         
       }
 
@@ -95,27 +124,17 @@ namespace sim {
         ActsExamples::IndexSourceLink sourceLink =
             trackState.getUncalibratedSourceLink().get<ActsExamples::IndexSourceLink>();
         
-        assert(m_measurements and
-               "Undefined measurement container in LdmxMeasurementCalibrator");
-        assert((sourceLink.index() < m_measurements->size()) and
-               "Source link index is outside the container bounds in LdmxMeasurementCalibrator");
-
-
-        //std::cout<<"calibrate_1d ==> NMeasurements available=" << m_measurements->size()<<std::endl;
-        auto meas = m_measurements->at(sourceLink.index());
+        float u, v, cov_uu, cov_vv;
+        local(sourceLink.index(), u, v, cov_uu, cov_vv);
 
         //You need to explicitly allocate measurements here
         trackState.allocateCalibrated(1);
         trackState.calibrated<1>().setZero();
-        trackState.calibrated<1>()(0) = (meas.getLocalPosition())[0];
+        trackState.calibrated<1>()(0) = u;
         trackState.calibratedCovariance<1>().setZero();
-        trackState.calibratedCovariance<1>()(0,0) = (meas.getLocalCovariance())[0];
+        trackState.calibratedCovariance<1>()(0,0) = cov_uu;
         
-        Acts::ActsMatrix<2,6> projector;
-        projector.setZero();
-        projector(0,0) = 1.;
-        projector(1,1) = 1.;
-        trackState.setProjector(projector.row(0));
+        trackState.setProjector(projector().row(0));
                 
       }
 
@@ -125,7 +144,7 @@ namespace sim {
                 const ActsExamples::IndexSourceLink& sourceLink) const {
 
         
-        auto meas = m_measurements->at(sourceLink.index());
+        const ldmx::Measurement& meas = m_measurements->at(sourceLink.index());
         //get the measurement
         std::cout<<"Measurement layer::\n"<<meas.getLayer()<<std::endl;
 
@@ -143,8 +162,49 @@ namespace sim {
     
    private:
 
+      /// Local position and covariance of a measurement, from the view if
+      /// there is one. The measurement is never copied.
+      void local(std::size_t index, float& u, float& v, float& cov_uu,
+                 float& cov_vv) const {
+        if (m_view) {
+          assert((index < m_view->size()) and
+                 "Source link index is outside the view bounds in LdmxMeasurementCalibrator");
+          u = m_view->u[index];
+          v = m_view->v[index];
+          cov_uu = m_view->cov_uu[index];
+          cov_vv = m_view->cov_vv[index];
+          return;
+        }
+
+        assert(m_measurements and
+               "Undefined measurement container in LdmxMeasurementCalibrator");
+        assert((index < m_measurements->size()) and
+               "Source link index is outside the container bounds in LdmxMeasurementCalibrator");
+
+        const ldmx::Measurement& meas = (*m_measurements)[index];
+        const auto local_pos = meas.getLocalPosition();
+        const auto local_cov = meas.getLocalCovariance();
+        u = local_pos[0];
+        v = local_pos[1];
+        cov_uu = local_cov[0];
+        cov_vv = local_cov[1];
+      }
+
+      /// Projection on the local coordinates (u, v)
+      static const Acts::ActsMatrix<2,6>& projector() {
+        static const Acts::ActsMatrix<2,6> proj = [] {
+          Acts::ActsMatrix<2,6> p;
+          p.setZero();
+          p(0,0) = 1.;
+          p(1,1) = 1.;
+          return p;
+        }();
+        return proj;
+      }
+
       // use pointer so the calibrator is copyable and default constructible.
       const std::vector<ldmx::Measurement>* m_measurements = nullptr;
+      const MeasurementCalibrationView* m_view = nullptr;
     };
 
   
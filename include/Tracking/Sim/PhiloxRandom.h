@@ -0,0 +1,102 @@
+#pragma once
+
+//--- C++ ---//
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Counter-based random numbers, Philox4x32-10 of Salmon et al., "Parallel
+ * random numbers: as easy as 1, 2, 3", SC11.
+ *
+ * The numbers are a function of a 128 bit counter and a 64 bit key, with no
+ * state, so the numbers of a hit depend only on the counter it is given and
+ * not on the order in which the hits or the events are processed. The key
+ * comes from the seed of the processor and the run, and the counters used
+ * by the tracking are {block, index, sensor, event}, see counter().
+ *
+ * The batches of counters are done in two passes over chunks of them: the
+ * Philox rounds on the four words of the counters stored as separate arrays,
+ * then the Box-Muller transform with a polynomial log, sine and cosine. Both
+ * loops are straight code on arrays that the compiler vectorizes, and the
+ * numbers don't depend on the vector width.
+ */
+class PhiloxRandom {
+ public:
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+
+  /// Numbers of a block, the output of one counter
+  static constexpr std::size_t kBlockSize = 4;
+
+  PhiloxRandom() = default;
+
+  /**
+   * @param seed The seed of the processor, from the RandomNumberSeedService
+   * @param run The run number, mixed in the key
+   */
+  PhiloxRandom(std::uint64_t seed, int run);
+
+  /// @return The 4 random words of a counter with a key
+  static Counter generate(Counter counter, Key key);
+
+  /**
+   * The counter of a block of numbers of a hit.
+   *
+   * @param event The event number
+   * @param sensor The ID of the sensor of the hit
+   * @param index The index of the hit, or the strip, in the sensor or the
+   *    collection
+   * @param block The block of 4 numbers of the hit
+   */
+  static Counter counter(int event, int sensor, int index, int block = 0) {
+    return {static_cast<std::uint32_t>(block),
+            static_cast<std::uint32_t>(index),
+            static_cast<std::uint32_t>(sensor),
+            static_cast<std::uint32_t>(event)};
+  }
+
+  /// @return The 4 random words of a counter
+  Counter operator()(const Counter& counter) const {
+    return generate(counter, key_);
+  }
+
+  /**
+   * The random words of a batch of counters.
+   *
+   * @param counters The counters
+   * @param n The number of counters
+   * @param[out] out The 4 random words of each counter, n entries
+   */
+  void generate(const Counter* counters, std::size_t n, Counter* out) const;
+
+  /**
+   * Standard normal numbers of a batch of counters.
+   *
+   * @param counters The counters
+   * @param n The number of counters
+   * @param[out] out The kBlockSize numbers of each counter, kBlockSize * n
+   *    entries
+   */
+  void normal(const Counter* counters, std::size_t n, float* out) const;
+
+  /// @return The key
+  const Key& key() const { return key_; }
+
+  /**
+   * Check the generator, single and batched, against the known answers of
+   * Philox4x32-10 published with Random123.
+   *
+   * @return true if all the answers are reproduced
+   */
+  static bool checkKnownAnswers();
+
+ private:
+  Key key_{0, 0};
+};
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,244 @@
+#pragma once
+
+//--- C++ ---//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/Definitions/Common.hpp"
+#include "Acts/MagneticField/MagneticFieldContext.hpp"
+#include "Acts/MagneticField/MagneticFieldProvider.hpp"
+#include "Acts/Propagator/ConstrainedStep.hpp"
+#include "Acts/Surfaces/Surface.hpp"
+#include "Acts/Utilities/Result.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Sim/StepSizeMap.h"
+
+namespace tracking {
+namespace sim {
+
+/// Cost of the propagations of a track
+struct PropagationCounters {
+  /// Steps of the stepper
+  std::uint64_t steps{0};
+  /// Steps shortened by the error control of the stepper: the step taken
+  /// was shorter than the user and actor limits of the step
+  std::uint64_t accuracy_limited_steps{0};
+  /// Evaluations of the magnetic field
+  std::uint64_t field_evaluations{0};
+  /// Surfaces reached by the navigator
+  std::uint64_t surfaces{0};
+
+  PropagationCounters& operator+=(const PropagationCounters& other) {
+    steps += other.steps;
+    accuracy_limited_steps += other.accuracy_limited_steps;
+    field_evaluations += other.field_evaluations;
+    surfaces += other.surfaces;
+    return *this;
+  }
+};
+
+/**
+ * Counters of the propagations running on the current thread, nullptr when
+ * they are not counted. The Acts track finding doesn't take user actors, so
+ * the navigator and the field provider count through this pointer, which
+ * each thread points to the counters of the track it processes.
+ */
+inline PropagationCounters*& activePropagationCounters() {
+  thread_local PropagationCounters* counters{nullptr};
+  return counters;
+}
+
+/**
+ * Magnetic field provider counting the field evaluations of another one in
+ * the active propagation counters.
+ */
+class CountingBField : public Acts::MagneticFieldProvider {
+ public:
+  explicit CountingBField(std::shared_ptr<const Acts::MagneticFieldProvider> field)
+      : field_(std::move(field)) {}
+
+  /// @copydoc Acts::MagneticFieldProvider::makeCache
+  Acts::MagneticFieldProvider::Cache makeCache(
+      const Acts::MagneticFieldContext& mctx) const override {
+    return field_->makeCache(mctx);
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::getField
+  Acts::Result<Acts::Vector3> getField(
+      const Acts::Vector3& position,
+      Acts::MagneticFieldProvider::Cache& cache) const override {
+    if (auto* counters = activePropagationCounters())
+      counters->field_evaluations++;
+    return field_->getField(position, cache);
+  }
+
+  /// @copydoc Acts::MagneticFieldProvider::getFieldGradient
+  Acts::Result<Acts::Vector3> getFieldGradient(
+      const Acts::Vector3& position, Acts::ActsMatrix<3, 3>& derivative,
+      Acts::MagneticFieldProvider::Cache& cache) const override {
+    if (auto* counters = activePropagationCounters())
+      counters->field_evaluations++;
+    return field_->getFieldGradient(position, derivative, cache);
+  }
+
+ private:
+  std::shared_ptr<const Acts::MagneticFieldProvider> field_;
+};
+
+/**
+ * Navigator adding the step statistics, the adaptive step size and the
+ * unbound external surfaces to another navigator.
+ *
+ * After each step the active propagation counters, if any, are updated.
+ * With a step size map, the largest step is set before each step from the
+ * region of the field the track is in, never above the maximum step of the
+ * propagation.
+ *
+ * External surfaces given by pointer don't need to be part of the tracking
+ * geometry, unlike the ones given by geometry identifier to Acts::Navigator.
+ * They are reached in the order they were inserted: each step is limited so
+ * that it stops on the next one, on top of the limits of the navigator, and
+ * once there it is the current unbound surface until the next step.
+ *
+ * @tparam navigator_t The navigator doing the navigation.
+ */
+template <typename navigator_t>
+class InstrumentedNavigator : public navigator_t {
+ public:
+  /// The state of the navigator, with the unbound external surfaces
+  struct State : navigator_t::State {
+    /// The unbound surfaces, in the order they are reached
+    std::vector<const Acts::Surface*> unboundSurfaces;
+    /// Index of the next unbound surface to reach
+    std::size_t nextUnboundSurface{0};
+    /// The unbound surface reached by the last step, if any
+    const Acts::Surface* currentUnboundSurface{nullptr};
+    /// Path length at the start of the step and limit of the step set by
+    /// the user and the actors, for the counters
+    double stepStartPath{0.};
+    double stepLimit{0.};
+  };
+
+  /**
+   * @param navigator The navigator doing the navigation
+   * @param step_sizes The largest step in each region of the field, nullptr
+   *    to keep the maximum step of the propagation
+   */
+  explicit InstrumentedNavigator(
+      navigator_t navigator,
+      std::shared_ptr<const StepSizeMap> step_sizes = nullptr)
+      : navigator_t(std::move(navigator)), step_sizes_(std::move(step_sizes)) {}
+
+  State makeState(const Acts::Surface* startSurface,
+                  const Acts::Surface* targetSurface) const {
+    State state;
+    static_cast<typename navigator_t::State&>(state) =
+        navigator_t::makeState(startSurface, targetSurface);
+    return state;
+  }
+
+  using navigator_t::insertExternalSurface;
+
+  /// Add an unbound surface, after those already added
+  void insertExternalSurface(State& state, const Acts::Surface* surface) const {
+    state.unboundSurfaces.push_back(surface);
+  }
+
+  const Acts::Surface* currentUnboundSurface(const State& state) const {
+    return state.currentUnboundSurface;
+  }
+
+  template <typename propagator_state_t, typename stepper_t>
+  void preStep(propagator_state_t& state, const stepper_t& stepper) const {
+    if (step_sizes_) {
+      double h = std::min(
+          step_sizes_->maxStepSize(stepper.position(state.stepping)),
+          std::abs(state.options.maxStepSize));
+      stepper.setStepSize(state.stepping, sign(state) * h,
+                          Acts::ConstrainedStep::user);
+    }
+    navigator_t::preStep(state, stepper);
+
+    // Aim at the next unbound surface ahead, if it is closer than the
+    // target of the navigator. The surfaces left behind are skipped.
+    auto& nav = state.navigation;
+    nav.currentUnboundSurface = nullptr;
+    while (nav.nextUnboundSurface < nav.unboundSurfaces.size()) {
+      double path = pathLength(
+          state, stepper, *nav.unboundSurfaces[nav.nextUnboundSurface]);
+      if (path > stepper.overstepLimit(state.stepping)) {
+        stepper.setStepSize(state.stepping, sign(state) * path,
+                            Acts::ConstrainedStep::actor, false);
+        break;
+      }
+      nav.nextUnboundSurface++;
+    }
+
+    if (activePropagationCounters()) {
+      const auto& step_size = state.stepping.stepSize;
+      nav.stepStartPath = state.stepping.pathAccumulated;
+      nav.stepLimit =
+          std::min(std::abs(step_size.value(Acts::ConstrainedStep::user)),
+                   std::abs(step_size.value(Acts::ConstrainedStep::actor)));
+    }
+  }
+
+  template <typename propagator_state_t, typename stepper_t>
+  void postStep(propagator_state_t& state, const stepper_t& stepper) const {
+    navigator_t::postStep(state, stepper);
+
+    auto& nav = state.navigation;
+    if (nav.nextUnboundSurface < nav.unboundSurfaces.size()) {
+      const auto* surface = nav.unboundSurfaces[nav.nextUnboundSurface];
+      if (std::abs(pathLength(state, stepper, *surface)) <
+          Acts::s_onSurfaceTolerance) {
+        nav.currentUnboundSurface = surface;
+        nav.nextUnboundSurface++;
+      }
+    }
+
+    if (auto* counters = activePropagationCounters()) {
+      counters->steps++;
+      // The accuracy constraint is already updated for the next step, the
+      // step taken is compared with its limits instead
+      double step = std::abs(state.stepping.pathAccumulated - nav.stepStartPath);
+      if (step < nav.stepLimit * (1. - kStepLimitTolerance))
+        counters->accuracy_limited_steps++;
+      if (this->currentSurface(state.navigation)) counters->surfaces++;
+    }
+  }
+
+ private:
+  /// Sign of the steps, +1 forward and -1 backward
+  template <typename propagator_state_t>
+  static double sign(const propagator_state_t& state) {
+    return state.options.direction == Acts::NavigationDirection::Forward ? 1.
+                                                                         : -1.;
+  }
+
+  /// Path length along the propagation to a surface, without boundary check
+  template <typename propagator_state_t, typename stepper_t>
+  static double pathLength(const propagator_state_t& state,
+                           const stepper_t& stepper,
+                           const Acts::Surface& surface) {
+    return surface
+        .intersect(state.geoContext, stepper.position(state.stepping),
+                   sign(state) * stepper.direction(state.stepping), false)
+        .intersection.pathLength;
+  }
+
+  /// Relative difference below which a step is at its limit
+  static constexpr double kStepLimitTolerance = 1e-6;
+
+  std::shared_ptr<const StepSizeMap> step_sizes_;
+};
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,77 @@
+#pragma once
+
+//--- C++ ---//
+#include <array>
+#include <cstdint>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/Definitions/Units.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Sim/BFieldMapView.h"
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Largest propagation step in each region of the field map.
+ *
+ * The field map is divided in boxes of cells. In each box the step is the
+ * one over which the field changes by at most a tolerance given the largest
+ * gradient of the field in the box and its neighbours, clamped to a range:
+ * the steps are long in the uniform field of the dipole and short in the
+ * fringe field. Outside of the map the largest step is used.
+ */
+class StepSizeMap {
+ public:
+  struct Config {
+    /// Largest change of any field component over a step
+    double field_tolerance{0.05 * Acts::UnitConstants::T};
+    /// Range of the step sizes
+    double min_step{5. * Acts::UnitConstants::mm};
+    double max_step{200. * Acts::UnitConstants::mm};
+    /// Size of the boxes along each axis, in cells of the map
+    int region_cells{4};
+  };
+
+  /**
+   * Build the step sizes from a field grid in the field map frame, placed in
+   * the tracking frame with the default position transformation.
+   */
+  StepSizeMap(const MagneticFieldGrid3& grid, const Config& cfg);
+
+  /// Largest step at a position in the tracking frame
+  double maxStepSize(const Acts::Vector3& position) const {
+    Acts::Vector3 map_pos = transform_pos_(position);
+    std::int32_t region = 0;
+    for (int i = 0; i < 3; i++) {
+      double u = (map_pos(i) - min_[i]) * inv_size_[i];
+      // Also rejects NaNs
+      if (!(u >= 0. && u < nregions_[i])) return max_step_;
+      region = region * nregions_[i] + static_cast<std::int32_t>(u);
+    }
+    return steps_[region];
+  }
+
+  /// @return The step sizes of the regions
+  const std::vector<float>& steps() const { return steps_; }
+
+ private:
+  DefaultPosTransform transform_pos_;
+  /// Lower edge of the map along each axis
+  std::array<double, 3> min_;
+  /// Inverse of the size of the regions along each axis
+  std::array<double, 3> inv_size_;
+  /// Number of regions along each axis
+  std::array<std::int32_t, 3> nregions_;
+  /// Step used outside of the map
+  double max_step_;
+  /// Largest step in each region
+  std::vector<float> steps_;
+};
+
+}  // namespace sim
+}  // namespace tracking
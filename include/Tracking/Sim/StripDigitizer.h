@@ -0,0 +1,252 @@
+#pragma once
+
+//--- C++ ---//
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+
+//--- LDMX ---//
+#include "Tracking/Event/RawSiStripHit.h"
+#include "Tracking/Event/RawSiStripHitColumns.h"
+#include "Tracking/Sim/PhiloxRandom.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Strip level digitization of the silicon sensors.
+ *
+ * The energy deposited along the path of a particle in a sensor is turned
+ * into charge carriers in a number of segments. Each segment drifts to the
+ * readout side of the sensor, shifted by the Lorentz angle and spread by
+ * diffusion, and its charge is shared between the strips it covers. At
+ * readout each strip with charge produces an APV25-style pulse, sampled a
+ * fixed number of times, with noise, and is kept if its largest sample is
+ * above threshold.
+ *
+ * The work of an event is done in stages over flat arrays: the segments of
+ * all the deposits are collected first, drifted together and then shared
+ * over the strips, and the strips of the touched sensors are read out in
+ * one pass. The loops over segments and strips are branch free so that the
+ * compiler can vectorize them: the error function at the strip edges is
+ * evaluated edge by edge for all the segments at once, and the pulse shape
+ * and error function are the approximations of FastMath.h. Noise is only generated for the strips with
+ * charge, as for a zero suppressed readout, in one batch of counter-based
+ * random numbers.
+ */
+class StripDigitizer {
+ public:
+  struct Config {
+    /// Number of strips along the local u axis of a sensor
+    int n_strips{640};
+    /// Number of segments each deposit is divided in along its path
+    int n_segments{10};
+    /// Energy needed to create an electron-hole pair (MeV)
+    double pair_energy{3.62e-6};
+    /// Tangent of the Lorentz angle
+    double lorentz_tan{0.01};
+    /// Width of the diffusion of charge drifting across the full thickness
+    /// (mm)
+    double diffusion{0.006};
+    /// Side where the charge is collected: -1 at local w = -thickness / 2,
+    /// +1 at w = thickness / 2
+    int readout_side{-1};
+    /// Noise of a sample, in electrons
+    double noise{1000.};
+    /// Electrons per ADC count
+    double electrons_per_adc{15.};
+    /// Pedestal of the samples, in ADC counts
+    double pedestal{4000.};
+    /// Largest ADC value
+    double adc_max{16383.};
+    /// Shaping time of the CR-RC pulse, the time from its start to its peak
+    /// (ns)
+    double shaping_time{50.};
+    /// Time of the first sample with respect to the event (ns)
+    double first_sample_time{0.};
+    /// Time between samples (ns)
+    double sample_spacing{25.};
+    /// Number of samples per strip
+    int n_samples{6};
+    /// Threshold on the largest sample above pedestal, in units of noise
+    double threshold{3.};
+  };
+
+  explicit StripDigitizer(const Config& cfg);
+
+  /// Remove the deposits of the previous event
+  void clear();
+
+  /**
+   * Deposit the energy of a particle crossing a sensor.
+   *
+   * The path is clipped to the thickness of the sensor.
+   *
+   * @param sensor_id The id of the sensor
+   * @param half_length_u Half length of the sensor along u in mm, the
+   *    strips cover [-half_length_u, half_length_u]
+   * @param thickness Thickness of the sensor in mm
+   * @param entry Start of the path in the local frame of the sensor
+   * @param exit End of the path in the local frame of the sensor
+   * @param edep Deposited energy in MeV
+   * @param time Time of the deposit in ns
+   */
+  void deposit(int sensor_id, double half_length_u, double thickness,
+               const Acts::Vector3& entry, const Acts::Vector3& exit,
+               double edep, double time);
+
+  /**
+   * Drift and share the charge of the deposits, then read the strips out.
+   *
+   * The noise of a strip is drawn from the counters of its event, sensor
+   * and strip, so it doesn't depend on the other strips or events.
+   *
+   * @param random The generator of the noise
+   * @param event The event number
+   * @param[out] hits The strips above threshold are appended to it, by
+   *    sensor in the order of their first deposit and by strip
+   */
+  void readout(const PhiloxRandom& random, int event,
+               std::vector<ldmx::RawSiStripHit>& hits) {
+    readStrips(random, event,
+               [&hits](int sensor_id, int strip, long time,
+                       const std::vector<short>& samples) {
+                 hits.emplace_back(samples, time);
+                 hits.back().setSensorID(sensor_id);
+                 hits.back().setStrip(strip);
+               });
+  }
+
+  /**
+   * Same as above, with the samples of the strips packed in one buffer.
+   *
+   * @param random The generator of the noise
+   * @param event The event number
+   * @param[out] hits The strips above threshold are appended to it
+   */
+  void readout(const PhiloxRandom& random, int event,
+               ldmx::RawSiStripHitColumns& hits) {
+    readStrips(random, event,
+               [&hits](int sensor_id, int strip, long time,
+                       const std::vector<short>& samples) {
+                 hits.push_back(sensor_id, strip, time, samples.data(),
+                                samples.size());
+               });
+  }
+
+  /// @return The configuration
+  const Config& config() const { return cfg_; }
+
+ private:
+  /// Index of the strips of a sensor in the charge arrays
+  std::size_t slot(int sensor_id, double half_length_u);
+
+  /**
+   * Drift, share and sample the charge.
+   *
+   * @param random The generator of the noise
+   * @param event The event number
+   * @param add Called with the sensor, strip, time and samples of each strip
+   *    above threshold
+   */
+  template <typename add_t>
+  void readStrips(const PhiloxRandom& random, int event, add_t&& add) {
+    drift();
+    share();
+    noise(random, event);
+
+    const float noise_adc = cfg_.noise / cfg_.electrons_per_adc;
+    const float threshold_adc = cfg_.threshold * noise_adc;
+    const std::size_t n_noise = noise_blocks() * PhiloxRandom::kBlockSize;
+    std::vector<short> samples(cfg_.n_samples);
+    std::vector<float> pulse(cfg_.n_samples);
+
+    for (std::size_t j = 0; j < strips_.size(); j++) {
+      std::size_t k = strips_[j];
+      std::size_t s = k / cfg_.n_strips;
+      int strip = k % cfg_.n_strips;
+
+      float amplitude = charge_[k] / cfg_.electrons_per_adc;
+      float t0 = charge_time_[k] / charge_[k];
+      pulseShape(t0, pulse);
+
+      const float* normal = noise_.data() + j * n_noise;
+      float max_signal = -noise_adc * 1e3f;
+      for (int i = 0; i < cfg_.n_samples; i++) {
+        float signal = amplitude * pulse[i] + noise_adc * normal[i];
+        max_signal = std::max(max_signal, signal);
+        samples[i] = static_cast<short>(std::clamp<float>(
+            std::round(cfg_.pedestal + signal), 0.f, cfg_.adc_max));
+      }
+      if (max_signal < threshold_adc) continue;
+
+      add(slot_sensor_[s], strip, std::lround(t0), samples);
+    }
+  }
+
+  /// Blocks of random numbers needed for the samples of a strip
+  std::size_t noise_blocks() const {
+    return (cfg_.n_samples + PhiloxRandom::kBlockSize - 1) /
+           PhiloxRandom::kBlockSize;
+  }
+
+  /// List the strips with charge and draw the noise of their samples
+  void noise(const PhiloxRandom& random, int event);
+
+  /// Drift the segments to the readout side
+  void drift();
+
+  /// Share the charge of the segments between the strips
+  void share();
+
+  /// CR-RC pulse of unit height started at t0, at the sample times
+  void pulseShape(float t0, std::vector<float>& pulse) const;
+
+  Config cfg_;
+
+  /// Sensors with deposits in the event and their slot
+  std::unordered_map<int, std::size_t> slots_;
+  std::vector<int> slot_sensor_;
+  std::vector<float> slot_half_u_;
+
+  /// Segments of the deposits. After the drift seg_u_ is the position on
+  /// the readout side and seg_sigma_ the width of the charge cloud.
+  std::vector<std::size_t> seg_slot_;
+  std::vector<float> seg_u_;
+  std::vector<float> seg_w_;
+  std::vector<float> seg_thickness_;
+  std::vector<float> seg_half_u_;
+  std::vector<float> seg_sigma_;
+  std::vector<float> seg_charge_;
+  std::vector<float> seg_time_;
+
+  /// Segments in units of strips, their position, width, the inverse of
+  /// their width times sqrt(2), and the strips [lo, hi) they share charge
+  /// with
+  std::vector<float> seg_x_;
+  std::vector<float> seg_width_;
+  std::vector<float> seg_inv_width_;
+  std::vector<int> seg_lo_;
+  std::vector<int> seg_hi_;
+
+  /// Charge and charge weighted time of each strip, n_strips per slot
+  std::vector<float> charge_;
+  std::vector<float> charge_time_;
+
+  /// Error function at the strip edges covered by the segments
+  std::vector<float> edges_;
+
+  /// Strips with charge, as indices in the charge arrays, and the noise of
+  /// their samples, noise_blocks() blocks per strip
+  std::vector<std::size_t> strips_;
+  std::vector<PhiloxRandom::Counter> counters_;
+  std::vector<float> noise_;
+};
+
+}  // namespace sim
+}  // namespace tracking
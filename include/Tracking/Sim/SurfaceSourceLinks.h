@@ -0,0 +1,88 @@
+#pragma once
+
+//--- C++ ---//
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Geometry/GeometryIdentifier.hpp"
+#include "Acts/Surfaces/Surface.hpp"
+
+//--- Tracking ---//
+#include "Tracking/Event/Measurement.h"
+#include "Tracking/Sim/HitMask.h"
+#include "Tracking/Sim/IndexSourceLink.h"
+
+namespace tracking {
+namespace sim {
+
+/**
+ * Flat index of the source links of an event, grouped by surface.
+ *
+ * The table of the sensitive surfaces is built once from the geometry: each
+ * surface gets a slot, in geometry identifier order. For every event the
+ * measurements are counting-sorted by slot into one contiguous array of
+ * source links, with an offset table giving the range of each surface. The
+ * lookup of the source links of a surface is a binary search in the (small)
+ * surface table, and the memory of the arrays is reused from event to event.
+ */
+class SurfaceSourceLinks {
+ public:
+  using Iterator = std::vector<ActsExamples::IndexSourceLink>::const_iterator;
+
+  /**
+   * Build the surface table
+   *
+   * @param layer_surfaces map between the layer id of the measurements and
+   *    the surfaces, as in geo::TrackingGeometry
+   */
+  void setSurfaces(
+      const std::unordered_map<unsigned int, const Acts::Surface*>&
+          layer_surfaces);
+
+  /**
+   * Index the measurements of an event. The source link of a measurement
+   * holds its index in the measurement collection.
+   *
+   * @param measurements the measurements of the event
+   * @param used_hits if given, the measurements it flags are skipped
+   * @return the number of measurements on a layer without a surface, which
+   *    are skipped
+   */
+  std::size_t fill(const std::vector<ldmx::Measurement>& measurements,
+                   const HitMask* used_hits = nullptr);
+
+  /// Range of the source links on a surface, empty if there are none
+  std::pair<Iterator, Iterator> range(const Acts::Surface& surface) const {
+    std::int32_t slot = findSlot(surface.geometryId());
+    if (slot < 0) return {links_.end(), links_.end()};
+    return {links_.begin() + offsets_[slot],
+            links_.begin() + offsets_[slot + 1]};
+  }
+
+  /// Number of indexed source links
+  std::size_t size() const { return links_.size(); }
+
+ private:
+  /// Slot of a surface, -1 if the surface is not in the table
+  std::int32_t findSlot(Acts::GeometryIdentifier geo_id) const;
+
+  /// Geometry identifiers of the surfaces, sorted. The position is the slot.
+  std::vector<Acts::GeometryIdentifier::Value> geo_ids_;
+  /// Layer id of the measurements and slot of their surface, sorted by layer
+  std::vector<std::pair<unsigned int, std::int32_t>> layer_slots_;
+
+  /// Slot of each measurement of the event, -1 if without surface
+  std::vector<std::int32_t> measurement_slots_;
+  /// Start of the source links of each slot, plus the total at the end
+  std::vector<std::uint32_t> offsets_;
+  /// Insertion position of each slot while filling
+  std::vector<std::uint32_t> cursors_;
+  /// The source links of the event, grouped by slot
+  std::vector<ActsExamples::IndexSourceLink> links_;
+};
+
+}  // namespace sim
+}  // namespace tracking
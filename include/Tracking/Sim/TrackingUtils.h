@@ -136,7 +136,9 @@ inline void flatCov(Acts::BoundSymMatrix cov, std::vector<double>& v_cov) {
       v_cov.push_back(cov(i,j));
 }
 
-inline Acts::BoundSymMatrix unpackCov(const std::vector<double>& v_cov) {
+//The covariance can be a std::vector or a std::array of 21 elements
+template <class cov_t>
+inline Acts::BoundSymMatrix unpackCov(const cov_t& v_cov) {
   
   Acts::BoundSymMatrix cov;
   int e{0};
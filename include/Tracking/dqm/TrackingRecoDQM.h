@@ -68,6 +68,10 @@ namespace tracking::dqm {
     std::vector<ldmx::Track> uniqueTracks;     // real tracks (truth_prob > cut), unique
     std::vector<ldmx::Track> duplicateTracks;  // real tracks (truth_prob > cut), duplicated
     std::vector<ldmx::Track> fakeTracks;       // fake tracks (truth_prob < cut)
+
+    // Time spent in analyze, reported at the end of the processing
+    double processing_time_{0.};
+    long nevents_{0};
   
    
     
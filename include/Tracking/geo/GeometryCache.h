@@ -0,0 +1,99 @@
+#pragma once
+
+//--- C++ ---//
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//--- ACTS ---//
+#include "Acts/Definitions/Algebra.hpp"
+#include "Acts/Geometry/CuboidVolumeBuilder.hpp"
+#include "Acts/Geometry/GeometryContext.hpp"
+#include "Acts/Material/Material.hpp"
+
+namespace tracking::geo {
+
+/**
+ * Serialized description of the tracker volumes, from which the Acts
+ * tracking geometry can be rebuilt without parsing the GDML with Geant4.
+ *
+ * The cache holds what the CuboidVolumeBuilder needs: the placement and size
+ * of each volume and, for each layer, its envelope and the transform, the
+ * rectangular bounds and the material slab of its sensors. It is stored in a
+ * text file named after a hash of the detector GDML, so that a change of the
+ * detector description never picks up a stale cache.
+ */
+struct GeometryCache {
+  /// A sensor: a plane surface with rectangular bounds and a material slab
+  struct Sensor {
+    /// Placement of the sensor in the tracking frame
+    Acts::Transform3 transform;
+    /// Half lengths of the rectangular bounds
+    double half_x{0.};
+    double half_y{0.};
+    /// Material of the sensor
+    Acts::Material material;
+    /// Thickness of the material slab
+    double thickness{0.};
+  };
+
+  /// A layer of sensors and its envelope along the x axis
+  struct Layer {
+    std::array<double, 2> envelope_x{0., 0.};
+    std::vector<Sensor> sensors;
+  };
+
+  /// A cuboid volume containing layers of sensors
+  struct Volume {
+    std::string name;
+    Acts::Vector3 position;
+    Acts::Vector3 length;
+    std::vector<Layer> layers;
+  };
+
+  /// Hash of the detector GDML the cache was built from
+  std::uint64_t gdml_hash{0};
+  /// The volumes of the geometry, in the order they are built
+  std::vector<Volume> volumes;
+
+  /**
+   * Describe a volume configuration. Its surfaces must be plane surfaces
+   * with rectangular bounds and homogeneous material.
+   *
+   * @throws std::runtime_error if a surface can't be described
+   */
+  static Volume describe(const Acts::CuboidVolumeBuilder::VolumeConfig& cfg,
+                         const Acts::GeometryContext& gctx);
+
+  /// Rebuild the configuration of a volume, with new surfaces
+  static Acts::CuboidVolumeBuilder::VolumeConfig build(const Volume& volume);
+
+  /**
+   * Hash the detector description: the GDML file and the other GDML files of
+   * its directory, which it may include.
+   *
+   * @throws std::runtime_error if the GDML can't be read
+   */
+  static std::uint64_t hashGDML(const std::string& gdml);
+
+  /// Path of the cache of a geometry with the given hash in a directory
+  static std::string path(const std::string& dir, std::uint64_t gdml_hash);
+
+  /**
+   * Read a cache written by write.
+   *
+   * @throws std::runtime_error if the file can't be read or is invalid
+   */
+  static GeometryCache read(const std::string& path);
+
+  /**
+   * Write the cache. The file is written next to its destination and moved in
+   * place once complete, so that concurrent jobs never read a partial cache.
+   *
+   * @throws std::runtime_error if the file can't be written
+   */
+  void write(const std::string& path) const;
+};
+
+}  // namespace tracking::geo
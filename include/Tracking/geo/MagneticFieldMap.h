@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+
+#include <Acts/Definitions/Algebra.hpp>
+#include <Acts/MagneticField/MagneticFieldProvider.hpp>
+
+#include "Framework/ConditionsObject.h"
+
+#include "Tracking/Sim/BFieldRegionModel.h"
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+namespace tracking::geo {
+
+/// class name of provider
+class MagneticFieldMapProvider;
+
+/**
+ * The interpolated magnetic field map
+ *
+ * This connects the field map to our conditions system so that
+ * the grid is loaded only once and shared between all the processors
+ * that need the magnetic field. The grid is held in the field map frame
+ * and is immutable, the processors get lightweight views over it that
+ * apply the transformation to the tracking frame.
+ */
+class MagneticFieldMap : public framework::ConditionsObject {
+ public:
+  /// Conditions object name
+  static const std::string NAME;
+
+  /**
+   * get the field in the tracking frame using the default transformation
+   * between the tracking and the field map frames
+   */
+  std::shared_ptr<const Acts::MagneticFieldProvider> get() const;
+
+  /**
+   * make a new view over the shared grid with a systematic variation
+   * of the map applied. The grid is not copied.
+   *
+   * @param[in] offset offset of the map in the field map frame
+   * @param[in] rotation rotation of the field in the tracking frame
+   * @param[in] scale scale factor of the field
+   */
+  std::shared_ptr<const Acts::MagneticFieldProvider> makeView(
+      const Acts::Vector3& offset,
+      const Acts::RotationMatrix3& rotation = Acts::RotationMatrix3::Identity(),
+      double scale = 1.) const;
+
+  /**
+   * make a new hybrid view over the shared grid, using the region model
+   * of the map where it is available and the interpolated map elsewhere.
+   * The systematic variations are the same as for makeView.
+   *
+   * @throws std::runtime_error if no region model was loaded
+   */
+  std::shared_ptr<const Acts::MagneticFieldProvider> makeHybridView(
+      const Acts::Vector3& offset,
+      const Acts::RotationMatrix3& rotation = Acts::RotationMatrix3::Identity(),
+      double scale = 1.) const;
+
+  /// get the shared grid in the field map frame
+  std::shared_ptr<const MagneticFieldGrid3> grid() const { return grid_; }
+
+  /// get the region model of the map, null if none was loaded
+  std::shared_ptr<const tracking::sim::BFieldRegionModel> model() const {
+    return model_;
+  }
+
+ private:
+  /// the provider is a friend and so it can make one
+  friend class MagneticFieldMapProvider;
+  /**
+   * Load the field map. Only the provider can make a new one.
+   *
+   * @param[in] field_map path to the field map (ASCII or binary)
+   * @param[in] field_model path to the region model of the map, can be empty
+   */
+  MagneticFieldMap(const std::string& field_map,
+                   const std::string& field_model);
+
+  /// the field grid shared with all the views
+  std::shared_ptr<const MagneticFieldGrid3> grid_;
+
+  /// the default view over the grid
+  std::shared_ptr<const Acts::MagneticFieldProvider> field_;
+
+  /// the region model fitted on the grid, if any
+  std::shared_ptr<const tracking::sim::BFieldRegionModel> model_;
+};
+
+}
@@ -65,10 +65,21 @@ class TrackersTrackingGeometry : public TrackingGeometry {
   
  private:
   friend TrackersTrackingGeometryProvider;
-  TrackersTrackingGeometry(const Acts::GeometryContext& gctx, const std::string& gdml, bool debug);
-
-  G4VPhysicalVolume* Tagger_;
-  G4VPhysicalVolume* Recoil_;
+  /**
+   * @param[in] gctx the geometry context for this geometry
+   * @param[in] gdml the path to the detector GDML
+   * @param[in] debug whether to print extra information
+   * @param[in] cache_dir directory of the geometry caches, see GeometryCache.
+   *    If a cache of the detector is there the GDML is not parsed, otherwise
+   *    one is written. Empty to always build from the GDML.
+   */
+  TrackersTrackingGeometry(const Acts::GeometryContext& gctx,
+                           const std::string& gdml, bool debug,
+                           const std::string& cache_dir = "");
+
+  // Only set when the geometry is built from the GDML
+  G4VPhysicalVolume* Tagger_{nullptr};
+  G4VPhysicalVolume* Recoil_{nullptr};
 
   // I store the layout as a map to distinguish layers/sides
   // They are not too many modules, so it should be ok to use this data structure
@@ -26,7 +26,10 @@
 #include <G4Polyhedra.hh>
 #include <G4Material.hh>
 
+#include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
 
 
@@ -51,6 +54,47 @@ namespace tracking::geo {
 class TrackingGeometry : public framework::ConditionsObject {
  public:
   /**
+   * Data of a sensor, computed once when the geometry is built so that the
+   * per-hit code doesn't have to go through the surface.
+   */
+  struct Sensor {
+    /// The surface of the sensor
+    const Acts::Surface* surface{nullptr};
+    /// Geometry identifier of the surface
+    Acts::GeometryIdentifier geometry_id;
+    /// Local to global transformation
+    Acts::Transform3 transform;
+    /// Global to local transformation
+    Acts::Transform3 inverse;
+    /// Global to local rotation
+    Acts::RotationMatrix3 rotation;
+    /// Center of the sensor
+    Acts::Vector3 translation;
+    /// Normal to the sensor, the local w axis
+    Acts::Vector3 normal;
+    /// Half lengths of the sensor along the local u and v axes
+    double half_length_u{0.};
+    double half_length_v{0.};
+    /// Thickness of the sensor material
+    double thickness{0.};
+  };
+
+  /**
+   * A plane of sensors orthogonal to the x axis. The trackers are a sequence
+   * of such planes along the beam, which the telescope navigator crosses in
+   * order.
+   */
+  struct TelescopePlane {
+    /// Position of the plane along x
+    double x{0.};
+    /// The sensors of the plane
+    std::vector<const Acts::Surface*> sensors;
+  };
+
+  /**
+   * The GDML is not parsed here, the derived classes call parseGDML when
+   * they need the Geant4 volumes.
+   *
    * @param[in] name the name of this geometry condition object
    * @param[in] gctx the geometry context for this geometry
    * @param[in] gdml the path to the detector GDML to load
@@ -87,13 +131,35 @@ class TrackingGeometry : public framework::ConditionsObject {
   void getSurfaces(std::vector<const Acts::Surface*>& surfaces) const;
 
   const Acts::Surface* getSurface(int layerid) const {
-    return layer_surface_map_.at(layerid);
+    const Sensor* sensor = getSensor(layerid);
+    if (!sensor) throw std::out_of_range("TrackingGeometry::getSurface");
+    return sensor->surface;
+  }
+
+  /**
+   * Look up a sensor by its id, vol * 1000 + layer * 100 + sensor.
+   *
+   * @return the sensor, or nullptr if there is no sensor with this id
+   */
+  const Sensor* getSensor(int layerid) const {
+    if (layerid < 0 || static_cast<std::size_t>(layerid) >= sensor_index_.size())
+      return nullptr;
+    std::int32_t index = sensor_index_[layerid];
+    return index < 0 ? nullptr : &sensors_[index];
+  }
+
+  /// The planes of sensors, in increasing x
+  const std::vector<TelescopePlane>& getTelescopePlanes() const {
+    return telescope_planes_;
   }
   
   
   std::unordered_map<unsigned int, const Acts::Surface*> layer_surface_map_;
 
  protected:
+  /// Parse the detector GDML and set the world volume
+  void parseGDML();
+
   const Acts::GeometryContext& gctx_;
   std::string gdml_{""};
   bool debug_{false};
@@ -101,6 +167,17 @@ class TrackingGeometry : public framework::ConditionsObject {
   Acts::RotationMatrix3 x_rot_, y_rot_;
   std::shared_ptr<const Acts::TrackingGeometry> tGeometry_{nullptr};
   G4VPhysicalVolume* fWorldPhysVol_{nullptr};
+
+ private:
+  /// Fill the sensor table from the layer surfaces map
+  void makeSensorTable();
+
+  /// The sensors, in the order of their ids
+  std::vector<Sensor> sensors_;
+  /// Position of each sensor id in sensors_, -1 if there is no such sensor
+  std::vector<std::int32_t> sensor_index_;
+  /// The sensors grouped in planes along x
+  std::vector<TelescopePlane> telescope_planes_;
   
 };
 }  // namespace tracking::geo
@@ -14,6 +14,15 @@ class TrackersTrackingGeometryProvider(ldmxcfg.ConditionsObjectProvider):
         trackgeo.get_instance().setDetector('ldmx-det-v12')
 
     The default detector is 'ldmx-det-v14'.
+
+    Attributes
+    ----------
+    geometry_cache : str
+        Directory of the tracking geometry caches. The geometry of a detector
+        is read from its cache there if there is one, without parsing the
+        GDML, and a cache is written otherwise. Caches are named after a hash
+        of the detector GDML. Empty (the default) to always build the geometry
+        from the GDML.
     """
 
     __instance = None
@@ -46,6 +55,7 @@ class TrackersTrackingGeometryProvider(ldmxcfg.ConditionsObjectProvider):
         else: 
             super().__init__('TrackersTrackingGeometry', 'tracking::geo::TrackersTrackingGeometryProvider', 'Tracking')
             self.debug = False
+            self.geometry_cache = ''
             self.setDetector('ldmx-det-v14')
             TrackersTrackingGeometryProvider.__instance = self
 
@@ -65,6 +75,30 @@ class MagneticFieldContextProvider(ldmxcfg.ConditionsObjectProvider):
 
 magfield_context = MagneticFieldContextProvider()
 
+class MagneticFieldMapProvider(ldmxcfg.ConditionsObjectProvider):
+    """provider of the interpolated magnetic field map condition
+
+    The map is loaded once and shared by all the processors that
+    need the magnetic field. The map is loaded from its binary
+    version if one is available next to the ASCII map.
+
+    Attributes
+    ----------
+    field_map : str
+        The path to the magnetic field map.
+    field_model : str
+        The path to the region model of the field map, fitted offline with
+        ldmx-fit-fieldmap. Needed by the processors using the hybrid field,
+        empty by default.
+    """
+    def __init__(self):
+        super().__init__('MagneticFieldMap', 'tracking::geo::MagneticFieldMapProvider', 'Tracking')
+        from LDMX.Tracking.make_path import makeFieldMapPath
+        self.field_map = makeFieldMapPath()
+        self.field_model = ''
+
+magfield_map = MagneticFieldMapProvider()
+
 class CalibrationContextProvider(ldmxcfg.ConditionsObjectProvider):
     """provider of the calibration context condition"""
     def __init__(self):
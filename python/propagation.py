@@ -1,4 +1,6 @@
 from LDMX.Framework.ldmxcfg import Producer
+# the magnetic field map is shared through the tracking conditions
+from LDMX.Tracking import geo
 
 
 
@@ -9,8 +11,6 @@ class CustomStatePropagator(Producer):
 
     Parameters
     ----------
-    field_map : string
-        The field map
     surf_location : double 
         The downstream location of the surface to where to propagate the states
     nstates : int
@@ -34,3 +34,40 @@ class CustomStatePropagator(Producer):
         self.thetarange    = [0., 1.57079632679]
         self.phirange      = [0., 6.28]
         
+
+class FieldMapBenchmark(Producer):
+    """ Micro-benchmark of the interpolated magnetic field lookups.
+
+    Compares the lookups per second of the shared field map from the
+    conditions with the field map built with std::function transformations,
+    on the same random positions, and checks that they agree. If the field
+    map provider has a region model (field_model), the hybrid field is timed
+    as well and its deviation from the map is checked against the tolerance
+    of the model.
+    The benchmark runs once at the start of the run.
+
+    Parameters
+    ----------
+    field_map : string
+        The field map used for the std::function reference
+    n_lookups : int
+        Number of field lookups per benchmark
+    n_repeat : int
+        Number of repetitions, the fastest one is reported
+    x_range : vector<double> [min,max]
+        Range of the random positions along x, in the tracking frame [mm]
+    y_range : vector<double> [min,max]
+        Range of the random positions along y, in the tracking frame [mm]
+    z_range : vector<double> [min,max]
+        Range of the random positions along z, in the tracking frame [mm]
+    """
+
+    def __init__(self, instance_name="FieldMapBenchmark"):
+        super().__init__(instance_name,"tracking::reco::FieldMapBenchmark","Tracking")
+        from LDMX.Tracking.make_path import makeFieldMapPath
+        self.field_map     = makeFieldMapPath()
+        self.n_lookups     = 1000000
+        self.n_repeat      = 5
+        self.x_range       = [-800., 400.]
+        self.y_range       = [-200., 200.]
+        self.z_range       = [-100., 100.]
@@ -1,11 +1,14 @@
 from LDMX.Framework.ldmxcfg import Producer
-from LDMX.Tracking.make_path import makeFieldMapPath
 from LDMX.Tracking.make_path import makeDetectorPath
 
 
 class DigitizationProcessor(Producer):
     """ Producer that smears simulated tracker hits.
 
+    The smearing and the strip noise are drawn from counter-based random
+    numbers keyed by the seeds of the RandomNumberSeedService and the run,
+    so the numbers of a hit only depend on its event, sensor and index.
+
     Parameters
     ----------
     instance_name : str
@@ -31,6 +34,38 @@ class DigitizationProcessor(Producer):
         Input hit collection to be smeared
     out_collection : string
         Output hit collection to be stored
+    strip_digitization : bool
+        Also digitize the strips of the sensors into RawSiStripHits: charge
+        deposition along the path in the sensor, drift with Lorentz angle
+        and diffusion, charge sharing between strips and sampling of the
+        APV25 pulses, with noise.
+    raw_hit_collection : string
+        Output collection of the RawSiStripHits.
+    packed_raw_hits : bool
+        Store the RawSiStripHits as one ldmx::RawSiStripHitColumns, with
+        the samples of all the strips packed in one buffer, instead of a
+        collection of RawSiStripHit. It is smaller on disk and faster to
+        write and read.
+    n_strips : int
+        Number of strips of a sensor along its sensitive direction.
+    lorentz_tan : float
+        Tangent of the Lorentz angle.
+    diffusion : float
+        Width of the diffusion of the charge drifting across the full
+        thickness of the sensor, in mm.
+    strip_noise : float
+        Noise of a sample, in electrons.
+    strip_threshold : float
+        Threshold on the largest sample of a strip above pedestal, in units
+        of noise.
+    electrons_per_adc : float
+        Gain of the readout, in electrons per ADC count.
+    pedestal : float
+        Pedestal of the samples, in ADC counts.
+    shaping_time : float
+        Peaking time of the CR-RC pulse, in ns.
+    first_sample_time : float
+        Time of the first of the 6 samples with respect to the event, in ns.
     detector: string
         The path to the GDML description of the detector.
     """
@@ -45,8 +80,97 @@ class DigitizationProcessor(Producer):
         self.min_e_dep = 0.05
         self.hit_collection = 'TaggerSimHits'
         self.out_collection = 'OutputMeasurements'
+        self.strip_digitization = False
+        self.raw_hit_collection = 'RawSiStripHits'
+        self.packed_raw_hits = False
+        self.n_strips = 640
+        self.lorentz_tan = 0.01
+        self.diffusion = 0.006
+        self.strip_noise = 1000.
+        self.strip_threshold = 3.
+        self.electrons_per_adc = 15.
+        self.pedestal = 4000.
+        self.shaping_time = 50.
+        self.first_sample_time = 0.
         self.detector = makeDetectorPath('ldmx-det-v14')
 
+class StripClusterProcessor(Producer):
+    """ Producer that reconstructs the strip hits into measurements.
+
+    The pulses of all the strips of the event are fitted together for their
+    amplitude and start time, then the adjacent strips of each sensor are
+    clustered with a seed and a neighbour threshold on the amplitude. Each
+    cluster gives a 1D measurement at its amplitude weighted centroid,
+    corrected for the Lorentz shift. The time of the fit is reported at the
+    end of the processing.
+
+    Parameters
+    ----------
+    instance_name : str
+        Unique name for this instance.
+
+    Attributes
+    ----------
+    raw_hit_collection : string
+        Input collection of RawSiStripHits.
+    packed_raw_hits : bool
+        The input RawSiStripHits are stored as one
+        ldmx::RawSiStripHitColumns, see DigitizationProcessor.
+    out_collection : string
+        Output measurement collection.
+    n_strips : int
+        Number of strips of a sensor along its sensitive direction.
+    lorentz_tan : float
+        Tangent of the Lorentz angle.
+    strip_noise : float
+        Noise of a sample, in electrons. The noise of the fitted amplitude
+        of a strip is this over sqrt(Sff), the sum of the squared pulse
+        shape at the samples for its fitted start time.
+    electrons_per_adc : float
+        Gain of the readout, in electrons per ADC count.
+    pedestal : float
+        Pedestal of the samples, in ADC counts.
+    seed_threshold : float
+        Threshold on the amplitude of the seed strip of a cluster, in units
+        of the noise of the fitted amplitude of the strip.
+    neighbour_threshold : float
+        Threshold on the amplitude of the other strips of a cluster, in
+        units of the noise of the fitted amplitude of the strip.
+    max_chi2_ndf : float
+        Largest chi2 per degree of freedom of the pulse fit of a strip for
+        it to be clustered, with the noise of a sample as error. The fit
+        of the 6 samples has 4 degrees of freedom.
+    shaping_time : float
+        Peaking time of the CR-RC pulse, in ns.
+    first_sample_time : float
+        Time of the first of the 6 samples with respect to the event, in ns.
+    t0_min : float
+        Earliest start time of the pulse fit, in ns.
+    t0_max : float
+        Latest start time of the pulse fit, in ns.
+    t0_step : float
+        Spacing of the start times scanned by the pulse fit, in ns.
+    """
+    def __init__(self, instance_name="StripClusterProcessor"):
+        super().__init__(instance_name,
+                         'tracking::reco::StripClusterProcessor', 'Tracking')
+        self.raw_hit_collection = 'RawSiStripHits'
+        self.packed_raw_hits = False
+        self.out_collection = 'StripMeasurements'
+        self.n_strips = 640
+        self.lorentz_tan = 0.01
+        self.strip_noise = 1000.
+        self.electrons_per_adc = 15.
+        self.pedestal = 4000.
+        self.seed_threshold = 4.
+        self.neighbour_threshold = 2.
+        self.max_chi2_ndf = 10.
+        self.shaping_time = 50.
+        self.first_sample_time = 0.
+        self.t0_min = -50.
+        self.t0_max = 100.
+        self.t0_step = 1.
+
 class SeedFinderProcessor(Producer):
     """ Producer to find Seeds for the KF-based track finding.
 
@@ -69,8 +193,27 @@ class SeedFinderProcessor(Producer):
         Maximum d0 allowed for the seeds. Computed at the perigee.
     z0max : float
         Maximum z0 allowed for the seeds. Computed at the perigee.
-    strategies : List[string] -- WORK IN PROGRESS AND NOT ACTIVE --- 
-        List of 5 hits (3 axial and 2 stereo) for seed finding.
+    window_tolerance : float
+        Tolerance (mm) added to the range of each hit when checking the
+        compatibility of the hits with the pmin/pmax and d0 cuts before the
+        seed fit. Hits further than that from a helix, e.g. from multiple
+        scattering, may not be combined.
+    strategies : List[string]
+        List of strategies for seed finding, each one the comma separated
+        list of the 5 layers (3 axial and 2 stereo) to use, e.g. '0,1,2,3,4'.
+    max_shared_hits : int
+        Seeds sharing more measurements than this with a seed of a previous
+        strategy are dropped as duplicates.
+    n_threads : int
+        Number of threads running the strategies of an event. The output
+        doesn't depend on the number of threads.
+    used_hit_tracks : List[string]
+        Track collections of the previous tracking passes. The hits of
+        their tracks passing the cuts below are not used in this pass.
+    used_hit_min_nhits : int
+        Minimum number of hits of a previous track to mask its hits.
+    used_hit_max_chi2ndf : float
+        Maximum chi2/ndf of a previous track to mask its hits.
     input_hits_collection : string
         The name of the input collection of hits to be used for seed finding.
     out_seed_collection : string
@@ -88,7 +231,13 @@ class SeedFinderProcessor(Producer):
         self.d0min = 20.
         self.d0max = 20.
         self.z0max = 60.
-        self.strategies = []
+        self.window_tolerance = 2.
+        self.strategies = ['0,1,2,3,4']
+        self.max_shared_hits = 1
+        self.n_threads = 1
+        self.used_hit_tracks = []
+        self.used_hit_min_nhits = 7
+        self.used_hit_max_chi2ndf = 5.
         self.input_hits_collection = 'TaggerSimHits'
         self.out_seed_collection = 'SeedTracks'
         self.detector = makeDetectorPath('ldmx-det-v14')
@@ -128,12 +277,35 @@ class CKFProcessor(Producer):
     const_b_field : bool
         <functionality to be removed>
         Activate the usage of constant magnetic field.
-    field_map_ : string
-        Path to the location of the magnetic field map.
+    hybrid_b_field : bool
+        Use the region model of the field map where it is within its
+        tolerance and the interpolated map elsewhere. Requires the
+        field_model of the MagneticFieldMapProvider (see LDMX.Tracking.geo).
+        Ignored if const_b_field is set.
+    map_offset_ : list[double]
+        Offset of the magnetic field map, for systematic studies. The map
+        itself is shared through the conditions (see LDMX.Tracking.geo).
+    telescope_navigator : bool
+        Navigate the trackers as the fixed sequence of sensor planes they
+        are instead of with the general Acts navigator, in the track
+        finding and in the extrapolations to the target and the ECal.
     propagator_step_size : float
         Size of each RK propagator step.
     propagator_maxSteps : int
         Maximum number of steps for the propagator
+    adaptive_step_size : bool
+        Limit the step size in each region of the field map from the
+        gradient of the field, up to propagator_step_size. Ignored if
+        const_b_field is set.
+    adaptive_step_field_tolerance : float
+        Largest change of the field over a step, in T.
+    adaptive_step_min : float
+        Smallest step size limit of the adaptive step size, in mm.
+    step_statistics : bool
+        Count the steps, the field evaluations and the surfaces reached
+        by the track finding for each seed and report them at the end.
+    step_statistics_file : string
+        ROOT file for the counters of each seed, not written if empty.
     perigee_location : list[double]
         DEPRECATED
     hit_collection : string
@@ -145,6 +317,16 @@ class CKFProcessor(Producer):
         Use single strip measurements and not 3D points.
     min_hits : int
         Minimum number of measurements on track to accept the trajectory.
+    n_threads : int
+        Number of threads running the track finding on the seeds of an
+        event. The output doesn't depend on the number of threads.
+    used_hit_tracks : List[string]
+        Track collections of the previous tracking passes. The hits of
+        their tracks passing the cuts below are not used in this pass.
+    used_hit_min_nhits : int
+        Minimum number of hits of a previous track to mask its hits.
+    used_hit_max_chi2ndf : float
+        Maximum chi2/ndf of a previous track to mask its hits.
     use_extrapolate_location : bool
         Activate the usage of extrapolate location for returning the track 
         parameters.
@@ -157,6 +339,10 @@ class CKFProcessor(Producer):
         Seed collection for initiate the track finding.
     out_trk_collection : string
         Name of the output Track collection.
+    columnar_output : bool
+        Also add the tracks stored by column (ldmx::TrackColumns) as
+        out_trk_collection + 'Columns'. They are smaller on disk and
+        faster to write and read.
     do_smearing : bool
        <functionality to be removed>
        Activate the hit smearing.
@@ -186,9 +372,15 @@ class CKFProcessor(Producer):
         self.pdg_id = 11
         self.bfield = 0.
         self.const_b_field = True
-        self.field_map = makeFieldMapPath()
+        self.hybrid_b_field = False
+        self.telescope_navigator = False
         self.propagator_step_size = 200.
         self.propagator_maxSteps = 10000
+        self.adaptive_step_size = False
+        self.adaptive_step_field_tolerance = 0.05
+        self.adaptive_step_min = 5.
+        self.step_statistics = False
+        self.step_statistics_file = ''
         self.hit_collection = 'RecoilSimHits'
         self.remove_stereo = False
         self.use_extrapolate_location = True
@@ -196,12 +388,17 @@ class CKFProcessor(Producer):
         self.use_seed_perigee = False
         self.seed_coll_name = 'SeedTracks'
         self.out_trk_collection = 'Tracks'
+        self.columnar_output = False
         self.do_smearing = False
         self.sigma_u = 0.01
         self.sigma_v = 0.
         self.kf_refit = False
         self.gsf_refit = False
         self.min_hits = 6
+        self.n_threads = 1
+        self.used_hit_tracks = []
+        self.used_hit_min_nhits = 7
+        self.used_hit_max_chi2ndf = 5.
         self.detector = makeDetectorPath('ldmx-det-v14')
 
 
@@ -259,3 +456,85 @@ class TruthSeedProcessor(Producer):
         self.p_cut = 0.  # MeV
         self.p_cut_max = 100000.  # MeV
         self.p_cut_ecal = -1.  # MeV
+
+class CalibrationBenchmark(Producer):
+    """ Micro-benchmark of the measurement calibration of the CKF.
+
+    Calibrates all the measurements of each event with the previous
+    calibration, copying each measurement, and with the calibration view
+    used by the CKF, and reports the calibrations per second of both at
+    the end of the processing. Nothing is added to the event.
+
+    Parameters
+    ----------
+    measurement_collection : string
+        The measurements to calibrate
+    n_repeat : int
+        Number of repetitions per event
+    use1Dmeasurements : bool
+        Benchmark the 1D calibration instead of the 2D one
+    """
+
+    def __init__(self, instance_name="CalibrationBenchmark"):
+        super().__init__(instance_name, 'tracking::reco::CalibrationBenchmark',
+                         'Tracking')
+        self.measurement_collection = 'TaggerMeasurements'
+        self.n_repeat = 10
+        self.use1Dmeasurements = True
+
+class NavigatorBenchmark(Producer):
+    """ Benchmark of the telescope navigator against the Acts navigator.
+
+    Propagates the tracks of a collection from their perigee through the
+    trackers with both navigators, up to the last plane of sensors in the
+    direction of the track, and reports the steps and the time per
+    track of each at the end of the processing, and the number of tracks
+    for which they didn't cross the same sensors. Nothing is added to the
+    event.
+
+    Parameters
+    ----------
+    track_collection : string
+        The tracks to propagate
+    propagator_step_size : float
+        Maximum size of each RK propagator step
+    propagator_maxSteps : int
+        Maximum number of steps of the propagator
+    """
+
+    def __init__(self, instance_name="NavigatorBenchmark"):
+        super().__init__(instance_name, 'tracking::reco::NavigatorBenchmark',
+                         'Tracking')
+        self.track_collection = 'TaggerTracks'
+        self.propagator_step_size = 200.
+        self.propagator_maxSteps = 10000
+
+class ExtrapolationBenchmark(Producer):
+    """ Benchmark of the extrapolation to several surfaces at once.
+
+    Extrapolates the tracks of a collection from their perigee to planes
+    along the beam, in a single propagation and with one propagation per
+    plane, and reports the time per track of each at the end of the
+    processing, and the number of planes where they differ. Nothing is
+    added to the event.
+
+    Parameters
+    ----------
+    track_collection : string
+        The tracks to extrapolate
+    planes : list[float]
+        Position along the beam, in mm, of the planes
+    tolerance : float
+        Largest distance, in mm, between the two positions on a plane
+    telescope_navigator : bool
+        Use the telescope navigator instead of the Acts navigator, as in
+        the CKF
+    """
+
+    def __init__(self, instance_name="ExtrapolationBenchmark"):
+        super().__init__(instance_name,
+                         'tracking::reco::ExtrapolationBenchmark', 'Tracking')
+        self.track_collection = 'RecoilTracks'
+        self.planes = [205., 220., 240.5]
+        self.tolerance = 0.001
+        self.telescope_navigator = False
@@ -1,6 +1,7 @@
 
 from LDMX.Framework.ldmxcfg import Producer
-from LDMX.Tracking.make_path import makeFieldMapPath
+# the magnetic field map is shared through the tracking conditions
+from LDMX.Tracking import geo
 
 class VertexProcessor(Producer) :
     """ Producer to form vertices from a track collection.
@@ -10,8 +11,6 @@ class VertexProcessor(Producer) :
 
     Attributes
     ----------
-    field_map : str
-        The path to the magnetic field map.
     trk_coll_name: str
         The name of the collection containing the tracks to vertex.
 
@@ -24,7 +23,6 @@ class VertexProcessor(Producer) :
     def __init__(self, name : str = "VertexProcessor"):
         super().__init__(name, 'tracking::reco::VertexProcessor','Tracking')
 
-        self.field_map = makeFieldMapPath()
         self.trk_coll_name = 'Tracks'
 
 class Vertexer(Producer) :
@@ -35,8 +33,6 @@ class Vertexer(Producer) :
     ----------
     debug : bool 
         Flag use to enable/disable printing of debug.
-    field_map : str
-        The path to the magnetic field map.
     trk_c_name_1 : str
         Name of a track collection to vertex.
     trk_c_name_2 : str
@@ -52,6 +48,5 @@ class Vertexer(Producer) :
         super().__init__(name,'tracking::reco::Vertexer','Tracking')
 
         self.debug = False
-        self.field_map = makeFieldMapPath()
         trk_c_name_1 = 'TaggerTracks'
         trk_c_name_2 = 'RecoilTracks'
@@ -1,14 +1,18 @@
 
 #include "Tracking/Event/RawSiStripHit.h"
 
+#include <utility>
+
 namespace ldmx {
 
 RawSiStripHit::RawSiStripHit(std::vector<short> samples, long time)
-    : samples_(samples), time_(time) {}
+    : samples_(std::move(samples)), time_(time) {}
 
 void RawSiStripHit::Clear() {
   samples_.clear();
   time_ = 0;
+  sensor_id_ = 0;
+  strip_ = 0;
 }
 
 std::ostream &operator<<(std::ostream &output, const RawSiStripHit &hit) {
@@ -16,7 +20,8 @@ std::ostream &operator<<(std::ostream &output, const RawSiStripHit &hit) {
   for (auto isample{0}; isample < (hit.samples_.size() - 1); ++isample)
     output << hit.samples_[isample] << ", ";
   output << hit.samples_[hit.samples_.size() - 1] << " } "
-         << "Time: " << hit.time_ << std::endl;
+         << "Time: " << hit.time_ << " Sensor: " << hit.sensor_id_
+         << " Strip: " << hit.strip_ << std::endl;
 
   return output;
 }
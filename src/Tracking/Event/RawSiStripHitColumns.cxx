@@ -0,0 +1,67 @@
+#include "Tracking/Event/RawSiStripHitColumns.h"
+
+ClassImp(ldmx::RawSiStripHitColumns)
+
+namespace ldmx {
+
+RawSiStripHitColumns::RawSiStripHitColumns(
+    const std::vector<RawSiStripHit>& hits) {
+  std::size_t n_samples{0};
+  for (const auto& hit : hits) n_samples += hit.getSamples().size();
+  reserve(hits.size(), n_samples);
+
+  for (const auto& hit : hits) push_back(hit);
+}
+
+void RawSiStripHitColumns::Clear() { *this = RawSiStripHitColumns(); }
+
+void RawSiStripHitColumns::Print() const { std::cout << *this << std::endl; }
+
+void RawSiStripHitColumns::reserve(std::size_t n_hits, std::size_t n_samples) {
+  sensor_id_.reserve(n_hits);
+  strip_.reserve(n_hits);
+  time_.reserve(n_hits);
+  sample_offsets_.reserve(n_hits + 1);
+  samples_.reserve(n_samples);
+}
+
+void RawSiStripHitColumns::push_back(const RawSiStripHit& hit) {
+  const auto& samples = hit.getSamples();
+  push_back(hit.getSensorID(), hit.getStrip(), hit.getTime(), samples.data(),
+            samples.size());
+}
+
+void RawSiStripHitColumns::push_back(int sensor_id, int strip, long time,
+                                     const short* samples,
+                                     std::size_t n_samples) {
+  sensor_id_.push_back(sensor_id);
+  strip_.push_back(strip);
+  time_.push_back(time);
+  samples_.insert(samples_.end(), samples, samples + n_samples);
+  sample_offsets_.push_back(samples_.size());
+}
+
+RawSiStripHit RawSiStripHitColumns::getHit(std::size_t i) const {
+  RawSiStripHit hit(
+      std::vector<short>(getSamples(i), getSamples(i) + getNSamples(i)),
+      time_[i]);
+  hit.setSensorID(sensor_id_[i]);
+  hit.setStrip(strip_[i]);
+  return hit;
+}
+
+std::vector<RawSiStripHit> RawSiStripHitColumns::getHits() const {
+  std::vector<RawSiStripHit> hits;
+  hits.reserve(size());
+  for (std::size_t i = 0; i < size(); i++) hits.push_back(getHit(i));
+  return hits;
+}
+
+std::ostream& operator<<(std::ostream& output,
+                         const RawSiStripHitColumns& hits) {
+  output << "[ RawSiStripHitColumns ]: " << hits.size() << " hits, "
+         << hits.samples_.size() << " samples";
+  return output;
+}
+
+}  // namespace ldmx
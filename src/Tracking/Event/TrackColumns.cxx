@@ -0,0 +1,137 @@
+#include "Tracking/Event/TrackColumns.h"
+
+#include <algorithm>
+
+ClassImp(ldmx::TrackColumns)
+
+namespace ldmx {
+
+namespace {
+
+/// Append exactly n values, padding with zeros
+template <class values_t>
+void append(std::vector<double>& column, const values_t& values,
+            std::size_t n) {
+  std::size_t ncopy = std::min(n, values.size());
+  column.insert(column.end(), values.begin(), values.begin() + ncopy);
+  column.resize(column.size() + n - ncopy, 0.);
+}
+
+}  // namespace
+
+TrackColumns::TrackColumns(const std::vector<Track>& tracks) {
+  n_hits_.reserve(tracks.size());
+  n_outliers_.reserve(tracks.size());
+  ndf_.reserve(tracks.size());
+  n_shared_hits_.reserve(tracks.size());
+  chi2_.reserve(tracks.size());
+  track_id_.reserve(tracks.size());
+  truth_prob_.reserve(tracks.size());
+  pdg_id_.reserve(tracks.size());
+  perigee_pars_.reserve(tracks.size() * kNParameters);
+  perigee_cov_.reserve(tracks.size() * kNCovariance);
+  perigee_.reserve(tracks.size() * 3);
+  position_.reserve(tracks.size() * 3);
+  momentum_.reserve(tracks.size() * 3);
+  meas_offsets_.reserve(tracks.size() + 1);
+  state_offsets_.reserve(tracks.size() + 1);
+
+  for (const auto& track : tracks) push_back(track);
+}
+
+void TrackColumns::Clear() { *this = TrackColumns(); }
+
+void TrackColumns::Print() const { std::cout << *this << std::endl; }
+
+void TrackColumns::push_back(const Track& track) {
+  n_hits_.push_back(track.getNhits());
+  n_outliers_.push_back(track.getNoutliers());
+  ndf_.push_back(track.getNdf());
+  n_shared_hits_.push_back(track.getNsharedHits());
+  chi2_.push_back(track.getChi2());
+  track_id_.push_back(track.getTrackID());
+  truth_prob_.push_back(track.getTruthProb());
+  pdg_id_.push_back(track.getPdgID());
+
+  append(perigee_pars_, track.getPerigeeParameters(), kNParameters);
+  append(perigee_cov_, track.getPerigeeCov(), kNCovariance);
+  append(perigee_, track.getPerigeeLocation(), 3);
+  append(position_, track.getPosition(), 3);
+  append(momentum_, track.getMomentum(), 3);
+
+  const auto& meas_idxs = track.getMeasurementsIdxs();
+  meas_idxs_.insert(meas_idxs_.end(), meas_idxs.begin(), meas_idxs.end());
+  meas_offsets_.push_back(meas_idxs_.size());
+
+  for (const auto& ts : track.getTrackStates()) {
+    state_ref_.insert(state_ref_.end(), {ts.refX, ts.refY, ts.refZ});
+    append(state_params_, ts.params, kNParameters);
+    append(state_cov_, ts.cov, kNCovariance);
+    state_type_.push_back(ts.ts_type);
+  }
+  state_offsets_.push_back(state_type_.size());
+}
+
+Track::TrackState TrackColumns::getTrackState(std::size_t i,
+                                              std::size_t j) const {
+  std::size_t k = state_offsets_[i] + j;
+  Track::TrackState ts;
+  ts.refX = state_ref_[3 * k];
+  ts.refY = state_ref_[3 * k + 1];
+  ts.refZ = state_ref_[3 * k + 2];
+  ts.params.assign(state_params_.begin() + k * kNParameters,
+                   state_params_.begin() + (k + 1) * kNParameters);
+  ts.cov.assign(state_cov_.begin() + k * kNCovariance,
+                state_cov_.begin() + (k + 1) * kNCovariance);
+  ts.ts_type = static_cast<TrackStateType>(state_type_[k]);
+  return ts;
+}
+
+Track TrackColumns::getTrack(std::size_t i) const {
+  Track track;
+  track.setNhits(n_hits_[i]);
+  track.setNoutliers(n_outliers_[i]);
+  track.setNdf(ndf_[i]);
+  track.setNsharedHits(n_shared_hits_[i]);
+  track.setChi2(chi2_[i]);
+  track.setTrackID(track_id_[i]);
+  track.setTruthProb(truth_prob_[i]);
+  track.setPdgID(pdg_id_[i]);
+
+  std::array<double, kNParameters> pars;
+  std::copy_n(getPerigeeParameters(i), kNParameters, pars.begin());
+  track.setPerigeeParameters(pars);
+  std::array<double, kNCovariance> cov;
+  std::copy_n(getPerigeeCov(i), kNCovariance, cov.begin());
+  track.setPerigeeCov(cov);
+  const double* perigee = getPerigeeLocation(i);
+  track.setPerigeeLocation(perigee[0], perigee[1], perigee[2]);
+  const double* pos = getPosition(i);
+  track.setPosition(pos[0], pos[1], pos[2]);
+  const double* mom = getMomentum(i);
+  track.setMomentum(mom[0], mom[1], mom[2]);
+
+  for (unsigned int k = meas_offsets_[i]; k < meas_offsets_[i + 1]; k++)
+    track.addMeasurementIndex(meas_idxs_[k]);
+
+  for (std::size_t j = 0; j < getNTrackStates(i); j++)
+    track.addTrackState(getTrackState(i, j));
+
+  return track;
+}
+
+std::vector<Track> TrackColumns::getTracks() const {
+  std::vector<Track> tracks;
+  tracks.reserve(size());
+  for (std::size_t i = 0; i < size(); i++) tracks.push_back(getTrack(i));
+  return tracks;
+}
+
+std::ostream& operator<<(std::ostream& output, const TrackColumns& tracks) {
+  output << "[ TrackColumns ]: " << tracks.size() << " tracks, "
+         << tracks.meas_idxs_.size() << " measurements, "
+         << tracks.state_type_.size() << " track states";
+  return output;
+}
+
+}  // namespace ldmx
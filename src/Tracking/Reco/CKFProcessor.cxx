@@ -4,10 +4,13 @@
 #include "Tracking/Sim/GeometryContainers.h"
 #include "Acts/EventData/TrackHelpers.hpp"
 #include "Tracking/Reco/TruthMatchingTool.h"
+#include "Tracking/Sim/StepSizeMap.h"
 
 //--- C++ StdLib ---//
 #include <algorithm>  //std::vector reverse
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 // eN files
 #include <fstream>
@@ -16,12 +19,23 @@ namespace tracking {
 namespace reco {
 
 CKFProcessor::CKFProcessor(const std::string& name, framework::Process& process)
-    : TrackingGeometryUser(name, process) {
-  normal_ = std::make_shared<std::normal_distribution<float>>(0., 1.);
-}
+    : TrackingGeometryUser(name, process) {}
 
 CKFProcessor::~CKFProcessor() {}
 
+void CKFProcessor::onProcessStart() {
+  if (!step_statistics_ || step_statistics_file_.empty()) return;
+
+  step_statistics_outfile_ = new TFile(step_statistics_file_.c_str(), "RECREATE");
+  step_statistics_tree_ = new TTree("steps", "steps");
+  step_statistics_tree_->Branch("steps", &seed_steps_);
+  step_statistics_tree_->Branch("accuracy_limited_steps",
+                                &seed_accuracy_limited_steps_);
+  step_statistics_tree_->Branch("field_evaluations", &seed_field_evaluations_);
+  step_statistics_tree_->Branch("surfaces", &seed_surfaces_);
+  step_statistics_tree_->Branch("time", &seed_time_);
+}
+
 void CKFProcessor::onNewRun(const ldmx::RunHeader& rh) {
   profiling_map_["setup"] = 0.;
   profiling_map_["hits"] = 0.;
@@ -30,95 +44,42 @@ void CKFProcessor::onNewRun(const ldmx::RunHeader& rh) {
   profiling_map_["ckf_run"] = 0.;
   profiling_map_["result_loop"] = 0.;
 
-  // Seed the generator
-  generator_.seed(1);
-
   // Generate a constant magnetic field
   Acts::Vector3 b_field(0., 0., bfield_ * Acts::UnitConstants::T);
 
   // Setup a constant magnetic field
   const auto constBField = std::make_shared<Acts::ConstantBField>(b_field);
   
-  // Custom transformation of the interpolated bfield map
-  bool debugTransform = false;
-  auto transformPos = [this,debugTransform](const Acts::Vector3& pos) {
-    
-    Acts::Vector3 rot_pos;
-    rot_pos(0)=pos(1);
-    rot_pos(1)=pos(2);
-    rot_pos(2)=pos(0) + DIPOLE_OFFSET;
-
-    // Systematic effect
-    rot_pos(0) += this->map_offset_[0];
-    rot_pos(1) += this->map_offset_[1];
-    rot_pos(2) += this->map_offset_[2];
-    
-    
-
-    
-    //Apply A rotation around the center of the magnet. (I guess offset first and then rotation)
-
-    if (debugTransform) {
-      std::cout<<"PF::DEFAULT3 TRANSFORM"<<std::endl;
-      std::cout<<"PF::Check:: transforming Pos"<<std::endl;
-      std::cout<<pos<<std::endl;
-      std::cout<<"TO"<<std::endl;
-      std::cout<<rot_pos<<std::endl;
-    }
-
-    return rot_pos;
-  };
-
-
-  Acts::RotationMatrix3 rotation = Acts::RotationMatrix3::Identity();
-  double scale = 1.;
-  
-  auto transformBField = [rotation, scale, debugTransform](const Acts::Vector3& field,
-                                           const Acts::Vector3& /*pos*/) {
-
-    //Rotate the field in tracking coordinates
-    Acts::Vector3 rot_field;
-    rot_field(0) = field(2);
-    rot_field(1) = field(0);
-    rot_field(2) = field(1);
-
-    
-    //Scale the field
-    rot_field = scale * rot_field;
-
-    //Rotate the field
-    rot_field = rotation * rot_field;
-
-    //A distortion scaled by position.
-    
-
-    if (debugTransform) {
-      std::cout<<"PF::DEFAULT3 TRANSFORM"<<std::endl;
-      std::cout<<"PF::Check:: transforming"<<std::endl;
-      std::cout<<field<<std::endl;
-      std::cout<<"TO"<<std::endl;
-      std::cout<<rot_field<<std::endl;
-    }
-    
-    return rot_field;
-  };
-  
   // Setup a interpolated bfield map
-  const auto map = std::make_shared<InterpolatedMagneticField3>(
-      loadDefaultBField(field_map_,
-                        //default_transformPos,
-                        //default_transformBField));
-                        transformPos,
-                        transformBField));
+  // The grid is shared with the other processors, only the systematic
+  // offset of the map is specific to this processor.
+  const auto map = magnetic_field_map().makeView(
+      Acts::Vector3(map_offset_[0], map_offset_[1], map_offset_[2]));
+
+  // Setup the hybrid field: region model of the map where it is within
+  // tolerance, interpolated map in the fringe regions
+  const auto hybrid_map =
+      hybrid_b_field_
+          ? magnetic_field_map().makeHybridView(
+                Acts::Vector3(map_offset_[0], map_offset_[1], map_offset_[2]))
+          : map;
 
 
   auto acts_loggingLevel = Acts::Logging::FATAL;
   if (debug_)
     acts_loggingLevel = Acts::Logging::VERBOSE;
     
+  // The field evaluations of the CKF are counted with the step statistics
+  auto ckf_field = [this](std::shared_ptr<const Acts::MagneticFieldProvider> field)
+      -> std::shared_ptr<const Acts::MagneticFieldProvider> {
+    if (!step_statistics_) return field;
+    return std::make_shared<tracking::sim::CountingBField>(std::move(field));
+  };
+
   // Setup the steppers
-  const auto stepper = Acts::EigenStepper<>{map};
-  const auto const_stepper = Acts::EigenStepper<>{constBField};
+  const auto stepper = Acts::EigenStepper<>{ckf_field(map)};
+  const auto const_stepper = Acts::EigenStepper<>{ckf_field(constBField)};
+  const auto hybrid_stepper = Acts::EigenStepper<>{ckf_field(hybrid_map)};
   const auto multi_stepper = Acts::MultiEigenStepperLoop{map};
 
   // Setup the navigator
@@ -127,12 +88,30 @@ void CKFProcessor::onNewRun(const ldmx::RunHeader& rh) {
   navCfg.resolvePassive = true;
   navCfg.resolveSensitive = true;
   navCfg.boundaryCheckLayerResolving = false;
-  const Acts::Navigator navigator(navCfg);
+
+  // Largest step in each region of the field map. The systematic offset of
+  // the map is small compared to the regions and is ignored.
+  std::shared_ptr<const tracking::sim::StepSizeMap> step_sizes;
+  if (adaptive_step_size_ && !const_b_field_) {
+    tracking::sim::StepSizeMap::Config step_cfg;
+    step_cfg.field_tolerance =
+        adaptive_step_field_tolerance_ * Acts::UnitConstants::T;
+    step_cfg.min_step = adaptive_step_min_ * Acts::UnitConstants::mm;
+    step_cfg.max_step = propagator_step_size_ * Acts::UnitConstants::mm;
+    step_sizes = std::make_shared<const tracking::sim::StepSizeMap>(
+        *magnetic_field_map().grid(), step_cfg);
+  }
+
+  const tracking::sim::InstrumentedNavigator<Acts::Navigator> navigator(
+      Acts::Navigator(navCfg), step_sizes);
 
   // Setup the propagators
-  propagator_ = const_b_field_
-                ? std::make_unique<CkfPropagator>(const_stepper, navigator)
-                : std::make_unique<CkfPropagator>(stepper, navigator, Acts::getDefaultLogger("ACTS_PROP",acts_loggingLevel));
+  if (const_b_field_)
+    propagator_ = std::make_unique<CkfPropagator>(const_stepper, navigator);
+  else if (hybrid_b_field_)
+    propagator_ = std::make_unique<CkfPropagator>(hybrid_stepper, navigator, Acts::getDefaultLogger("ACTS_PROP",acts_loggingLevel));
+  else
+    propagator_ = std::make_unique<CkfPropagator>(stepper, navigator, Acts::getDefaultLogger("ACTS_PROP",acts_loggingLevel));
   
   //auto gsf_propagator = GsfPropagator(multi_stepper, navigator);
   
@@ -144,40 +123,30 @@ void CKFProcessor::onNewRun(const ldmx::RunHeader& rh) {
                                                                        geometry_context(),
                                                                        magnetic_field_context());
 
+  // Same stepper, with the planes of the trackers precomputed by the geometry
+  if (telescope_navigator_) {
+    const auto& ckf_stepper =
+        const_b_field_ ? const_stepper : (hybrid_b_field_ ? hybrid_stepper : stepper);
+    telescope_propagator_ = std::make_unique<TelescopePropagator>(
+        ckf_stepper,
+        tracking::sim::InstrumentedNavigator<TelescopeNavigator>(
+            TelescopeNavigator(geometry()), step_sizes),
+        Acts::getDefaultLogger("ACTS_PROP", acts_loggingLevel));
+    telescope_ckf_ = std::make_unique<std::decay_t<decltype(*telescope_ckf_)>>(
+        *telescope_propagator_, Acts::getDefaultLogger("CKF", acts_loggingLevel));
+    telescope_trk_extrap_ =
+        std::make_shared<std::decay_t<decltype(*telescope_trk_extrap_)>>(
+            *telescope_propagator_, geometry_context(), magnetic_field_context());
+  }
+
   //gsf_ = std::make_unique<std::decay_t<decltype(*gsf_)>>(
   //    std::move(gsf_propagator));
 
-  // Setup the propagator steps writer
-  //tracking::sim::PropagatorStepWriter::Config cfg;
-  //cfg.filePath = steps_outfile_path_;
-
-  //writer_ = std::make_unique<tracking::sim::PropagatorStepWriter>(cfg);
-
-
-}
-
-void CKFProcessor::produce(framework::Event& event) {
-
-  eventnr_++;
-  // get the tracking geometry from conditions
-  auto tg{geometry()};
-
-  // TODO use global variable instead and call clear;
-
-  std::vector<ldmx::Track> tracks;
-  
-  auto start = std::chrono::high_resolution_clock::now();
+  // ============   Setup the CKF context  ============
+  // Everything that doesn't depend on the event is built once here,
+  // produce only points the calibrator and the source link accessor
+  // to the measurements of the event.
 
-  nevents_++;
-  if (nevents_ % 1000 == 0)
-    ldmx_log(info) << "events processed:" << nevents_;
-  
-  auto loggingLevel = Acts::Logging::DEBUG;
-  ACTS_LOCAL_LOGGER(
-      Acts::getDefaultLogger("LDMX Tracking Goemetry Maker", loggingLevel));
-
-
-  //Move this at the start of the producer
   Acts::PropagatorOptions<ActionList, AbortList> propagator_options(
       geometry_context(), magnetic_field_context()
       );
@@ -206,6 +175,120 @@ void CKFProcessor::produce(framework::Event& event) {
   // Electron hypothesis
   propagator_options.mass = 0.511 * Acts::UnitConstants::MeV;
 
+  // configuration for the measurement selector. Empty geometry identifier means
+  // applicable to all the detector elements
+
+  Acts::MeasurementSelector::Config measurementSelectorCfg = {
+      // global default: no chi2 cut, only one measurement per surface
+      {Acts::GeometryIdentifier(),
+       {{}, {outlier_pval_}, {1u}}},
+  };
+
+  meas_sel_ = std::make_unique<Acts::MeasurementSelector>(measurementSelectorCfg);
+
+  Acts::CombinatorialKalmanFilterExtensions<Acts::VectorMultiTrajectory> ckf_extensions;
+  
+  if (use1Dmeasurements_)
+    ckf_extensions.calibrator.connect<&tracking::sim::LdmxMeasurementCalibrator::calibrate_1d>(
+        &calibrator_);
+  
+  else
+    ckf_extensions.calibrator.connect<&tracking::sim::LdmxMeasurementCalibrator::calibrate>(
+        &calibrator_);
+  
+  ckf_extensions.updater.connect<
+    &Acts::GainMatrixUpdater::operator()<Acts::VectorMultiTrajectory>>(
+        &kf_updater_);
+  ckf_extensions.smoother.connect<
+    &Acts::GainMatrixSmoother::operator()<Acts::VectorMultiTrajectory>>(
+        &kf_smoother_);
+
+  ckf_extensions.measurementSelector
+      .connect<&Acts::MeasurementSelector::select<Acts::VectorMultiTrajectory>>(meas_sel_.get());
+
+  Acts::SourceLinkAccessorDelegate<SourceLinkAccIt> sourceLinkAccessorDelegate;
+  sourceLinkAccessorDelegate.connect<&SourceLinkAccessor::operator(),
+                                     SourceLinkAccessor>(
+                                         &source_link_accessor_);
+
+  // Table of the surfaces with measurements, the source links of each
+  // event are grouped according to it
+  source_links_.setSurfaces(geometry().layer_surface_map_);
+
+  // Surfaces
+  origin_surface_ = Acts::Surface::makeShared<Acts::PerigeeSurface>(
+      Acts::Vector3(0., 0., 0.));
+
+  tgt_surface_ = Acts::Surface::makeShared<Acts::PerigeeSurface>(
+      Acts::Vector3(extrapolate_location_[0], extrapolate_location_[1],
+                    extrapolate_location_[2]));
+
+  // The seed perigee surface is set for each event in produce
+  const Acts::Surface* extr_surface = use_extrapolate_location_
+                                      ? tgt_surface_.get()
+                                      : origin_surface_.get();
+
+  ckf_options_ = std::make_unique<std::decay_t<decltype(*ckf_options_)>>(
+      geometry_context(), 
+      magnetic_field_context(),
+      calibration_context(), 
+      sourceLinkAccessorDelegate, ckf_extensions,
+      propagator_options, extr_surface);
+
+  //Define the target surface - be careful:
+  // x - downstream
+  // y - left (when looking along x)
+  // z - up
+  // Passing identity here means that your target surface is oriented in the same way
+  Acts::RotationMatrix3 surf_rotation = Acts::RotationMatrix3::Zero();
+  //u direction along +Y
+  surf_rotation(1,0) = 1;
+  //v direction along +Z
+  surf_rotation(2,1) = 1;
+  //w direction along +X
+  surf_rotation(0,2) = 1;
+
+  const double ECAL_SCORING_PLANE  = 240.5;
+  Acts::Vector3 pos(ECAL_SCORING_PLANE, 0., 0.);
+  Acts::Translation3 surf_translation(pos);
+  Acts::Transform3 surf_transform(surf_translation * surf_rotation);
+  
+  //Unbounded surface
+  ecal_surface_ = Acts::Surface::makeShared<Acts::PlaneSurface>(surf_transform);
+  
+  Acts::Vector3 target_pos(0., 0., 0.);
+  Acts::Translation3 target_translation(target_pos);
+  Acts::Transform3 target_transform(target_translation * surf_rotation);
+  
+  //Unbounded surface
+  target_surface_ = Acts::Surface::makeShared<Acts::PlaneSurface>(target_transform);
+
+  extrapolation_targets_ = {{target_surface_, ldmx::TrackStateType::AtTarget},
+                            {ecal_surface_, ldmx::TrackStateType::AtECAL}};
+
+  // Setup the propagator steps writer
+  //tracking::sim::PropagatorStepWriter::Config cfg;
+  //cfg.filePath = steps_outfile_path_;
+
+  //writer_ = std::make_unique<tracking::sim::PropagatorStepWriter>(cfg);
+
+
+}
+
+void CKFProcessor::produce(framework::Event& event) {
+
+  eventnr_++;
+
+  // TODO use global variable instead and call clear;
+
+  std::vector<ldmx::Track> tracks;
+  
+  auto start = std::chrono::high_resolution_clock::now();
+
+  nevents_++;
+  if (nevents_ % 1000 == 0)
+    ldmx_log(info) << "events processed:" << nevents_;
+  
   // #######################//
   // Kalman Filter algorithm//
   // #######################//
@@ -231,9 +314,23 @@ void CKFProcessor::produce(framework::Event& event) {
     
   }
   
-  // The mapping between the geometry identifier
-  // and the IndexsourceLink that points to the hit
-  const auto geoId_sl_map = makeGeoIdSourceLinkMap(tg, measurements);
+  // Skip the hits already used by the good tracks of the previous passes
+  const tracking::sim::HitMask* used_hits = nullptr;
+  if (!used_hit_tracks_.empty()) {
+    hit_mask_.reset(measurements.size());
+    for (const auto& coll : used_hit_tracks_)
+      hit_mask_.mask(event.getCollection<ldmx::Track>(coll));
+    used_hits = &hit_mask_;
+    ldmx_log(debug) << hit_mask_.count() << " of " << measurements.size()
+                    << " measurements used by the previous passes";
+  }
+
+  // The source links pointing to the hits, grouped by surface
+  std::size_t n_missing = source_links_.fill(measurements, used_hits);
+  if (n_missing > 0)
+    ldmx_log(warn) << n_missing << " measurements are not associated to any surface";
+  ldmx_log(debug) << "Indexed " << source_links_.size() << " of "
+                  << measurements.size() << " measurements";
 
   auto hits = std::chrono::high_resolution_clock::now();
   profiling_map_["hits"] +=
@@ -283,6 +380,8 @@ void CKFProcessor::produce(framework::Event& event) {
   if (startParameters.size() < 1) {
     std::vector<ldmx::Track> empty;
     event.add(out_trk_collection_, empty);
+    if (columnar_output_)
+      event.add(out_trk_collection_ + "Columns", ldmx::TrackColumns());
     return;
   }
   
@@ -290,121 +389,17 @@ void CKFProcessor::produce(framework::Event& event) {
   profiling_map_["seeds"] +=
       std::chrono::duration<double, std::milli>(seeds - hits).count();
 
-  Acts::GainMatrixUpdater kfUpdater;
-  Acts::GainMatrixSmoother kfSmoother;
-
-  // configuration for the measurement selector. Empty geometry identifier means
-  // applicable to all the detector elements
-
-  Acts::MeasurementSelector::Config measurementSelectorCfg = {
-      // global default: no chi2 cut, only one measurement per surface
-      {Acts::GeometryIdentifier(),
-       {{}, {outlier_pval_}, {1u}}},
-  };
-
-  Acts::MeasurementSelector measSel{measurementSelectorCfg};
-  
-  tracking::sim::LdmxMeasurementCalibrator calibrator{measurements};
-
-  Acts::CombinatorialKalmanFilterExtensions<Acts::VectorMultiTrajectory> ckf_extensions;
-  
-  if (use1Dmeasurements_)
-    ckf_extensions.calibrator.connect<&tracking::sim::LdmxMeasurementCalibrator::calibrate_1d>(
-        &calibrator);
-  
-  else
-    ckf_extensions.calibrator.connect<&tracking::sim::LdmxMeasurementCalibrator::calibrate>(
-        &calibrator);
-  
-  ckf_extensions.updater.connect<
-    &Acts::GainMatrixUpdater::operator()<Acts::VectorMultiTrajectory>>(
-        &kfUpdater);
-  ckf_extensions.smoother.connect<
-    &Acts::GainMatrixSmoother::operator()<Acts::VectorMultiTrajectory>>(
-        &kfSmoother);
-
-  ckf_extensions.measurementSelector
-      .connect<&Acts::MeasurementSelector::select<Acts::VectorMultiTrajectory>>(&measSel);
-  
-  
-  ldmx_log(debug) 
-      << "SourceLinkAccessor..." <<  std::endl;
-  
-  // Create source link accessor and connect delegate
-  struct SourceLinkAccIt {
-    using BaseIt = decltype(geoId_sl_map.begin());
-    BaseIt it;
-
-    using difference_type = typename BaseIt::difference_type;
-    using iterator_category = typename BaseIt::iterator_category;
-    //using value_type = typename BaseIt::value_type::second_type;
-    using value_type = Acts::SourceLink;
-    using pointer = typename BaseIt::pointer;
-    using reference = value_type&;
-
-    SourceLinkAccIt& operator++() {
-      ++it;
-      return *this;
-    }
-    bool operator==(const SourceLinkAccIt& other) const {
-      return it == other.it;
-    }
-    bool operator!=(const SourceLinkAccIt& other) const {
-      return !(*this == other);
-    }
-    //const value_type& operator*() const { return it->second; }
-
-    //by value
-    value_type operator*() const { return value_type{it->second}; }
-  };
-
-  auto sourceLinkAccessor = [&](const Acts::Surface& surface)
-                            -> std::pair<SourceLinkAccIt, SourceLinkAccIt> {
-    auto [begin, end] = geoId_sl_map.equal_range(surface.geometryId());
-    return {SourceLinkAccIt{begin}, SourceLinkAccIt{end}};
-  };
-  
-  Acts::SourceLinkAccessorDelegate<SourceLinkAccIt> sourceLinkAccessorDelegate;
-  sourceLinkAccessorDelegate.connect<&decltype(sourceLinkAccessor)::operator(),
-                                     decltype(sourceLinkAccessor)>(
-                                         &sourceLinkAccessor);
-  
-  ldmx_log(debug) 
-      << "Surfaces..." <<  std::endl;
-  
-  std::shared_ptr<const Acts::PerigeeSurface> origin_surface =
-      Acts::Surface::makeShared<Acts::PerigeeSurface>(
-          Acts::Vector3(0., 0., 0.));
-
-  auto extr_surface = &(*origin_surface);
-
-  std::shared_ptr<const Acts::PerigeeSurface> tgt_surface =
-      Acts::Surface::makeShared<Acts::PerigeeSurface>(
-          Acts::Vector3(extrapolate_location_[0], extrapolate_location_[1],
-                        extrapolate_location_[2]));
-
-  if (use_extrapolate_location_) {
-    extr_surface = &(*tgt_surface);
-  }
-
-  Acts::Vector3 seed_perigee_surface_center =
-      startParameters.at(0).referenceSurface().center(geometry_context());
-  std::shared_ptr<const Acts::PerigeeSurface> seed_surface =
-      Acts::Surface::makeShared<Acts::PerigeeSurface>(
-          seed_perigee_surface_center);
+  // Point the CKF context to the measurements of this event
+  calibration_view_.fill(measurements);
+  calibrator_ = tracking::sim::LdmxMeasurementCalibrator{calibration_view_};
+  source_link_accessor_.container = &source_links_;
 
   if (use_seed_perigee_) {
-    extr_surface = &(*seed_surface);
+    seed_surface_ = Acts::Surface::makeShared<Acts::PerigeeSurface>(
+        startParameters.at(0).referenceSurface().center(geometry_context()));
+    ckf_options_->referenceSurface = seed_surface_.get();
   }
 
-  const Acts::CombinatorialKalmanFilterOptions<SourceLinkAccIt,Acts::VectorMultiTrajectory> ckfOptions(
-      geometry_context(), 
-      magnetic_field_context(),
-      calibration_context(), 
-      sourceLinkAccessorDelegate, ckf_extensions,
-      propagator_options, &(*extr_surface));
-
-
   ldmx_log(debug) 
       << "About to run CKF..." <<  std::endl;
     
@@ -414,166 +409,196 @@ void CKFProcessor::produce(framework::Event& event) {
       std::chrono::duration<double, std::milli>(ckf_setup - seeds).count();
   
 
+  // Containers of the tracks found by one worker
+  struct CkfTracks {
+    Acts::VectorTrackContainer vtc;
+    Acts::VectorMultiTrajectory mtj;
+    decltype(Acts::TrackContainer{vtc, mtj}) tc{vtc, mtj};
+  };
+
+  // Tracks found from one seed: the range they were appended to in the
+  // container of the worker that processed the seed, so that seeds without
+  // a track don't shift the tracks of the other seeds
+  struct SeedTracks {
+    std::size_t worker{0};
+    std::size_t begin{0};
+    std::size_t end{0};
+    bool ok{false};
+    //Step statistics of the propagations of the seed
+    tracking::sim::PropagationCounters counters;
+    double time{0.};
+  };
+
+  const std::size_t n_workers = std::max<std::size_t>(
+      1, std::min<std::size_t>(n_threads_, startParameters.size()));
+  std::vector<std::unique_ptr<CkfTracks>> worker_tracks;
+  for (std::size_t w = 0; w < n_workers; w++)
+    worker_tracks.push_back(std::make_unique<CkfTracks>());
+  std::vector<SeedTracks> seed_results(startParameters.size());
+
+  // The CKF and its context are only read, so they can be shared by the workers
+  auto findTracks = [&](std::size_t worker, std::size_t seed) {
+    auto& tc = worker_tracks[worker]->tc;
+    SeedTracks& result = seed_results[seed];
+    result.worker = worker;
+    result.begin = tc.size();
+    if (step_statistics_)
+      tracking::sim::activePropagationCounters() = &result.counters;
+    auto seed_start = std::chrono::high_resolution_clock::now();
+    result.ok =
+        telescope_ckf_
+            ? telescope_ckf_->findTracks(startParameters[seed], *ckf_options_, tc).ok()
+            : ckf_->findTracks(startParameters[seed], *ckf_options_, tc).ok();
+    result.time = std::chrono::duration<double, std::milli>(
+                      std::chrono::high_resolution_clock::now() - seed_start)
+                      .count();
+    tracking::sim::activePropagationCounters() = nullptr;
+    result.end = tc.size();
+  };
+
+  if (n_workers == 1) {
+    for (std::size_t seed = 0; seed < startParameters.size(); ++seed)
+      findTracks(0, seed);
+  } else {
+    // The seeds are handed out one at a time, so the workers stay busy
+    // even if some seeds take much longer than the others
+    std::atomic<std::size_t> next_seed{0};
+    std::vector<std::thread> workers;
+    for (std::size_t w = 0; w < n_workers; w++) {
+      workers.emplace_back([&, w]() {
+        for (std::size_t seed = next_seed++; seed < startParameters.size();
+             seed = next_seed++)
+          findTracks(w, seed);
+      });
+    }
+    for (auto& worker : workers) worker.join();
+  }
+
   auto ckf_run = std::chrono::high_resolution_clock::now();
   profiling_map_["ckf_run"] +=
       std::chrono::duration<double, std::milli>(ckf_run - ckf_setup).count();
+
+  if (step_statistics_) {
+    seed_steps_.clear();
+    seed_accuracy_limited_steps_.clear();
+    seed_field_evaluations_.clear();
+    seed_surfaces_.clear();
+    seed_time_.clear();
+    for (const SeedTracks& result : seed_results) {
+      step_totals_ += result.counters;
+      max_seed_steps_ = std::max(max_seed_steps_, result.counters.steps);
+      seed_steps_.push_back(result.counters.steps);
+      seed_accuracy_limited_steps_.push_back(
+          result.counters.accuracy_limited_steps);
+      seed_field_evaluations_.push_back(result.counters.field_evaluations);
+      seed_surfaces_.push_back(result.counters.surfaces);
+      seed_time_.push_back(result.time);
+    }
+    if (step_statistics_tree_) step_statistics_tree_->Fill();
+  }
   
-  //I create a new container for every seed
-  Acts::VectorTrackContainer vtc;
-  Acts::VectorMultiTrajectory mtj;
-  Acts::TrackContainer tc{vtc, mtj};
-  
-  for (size_t trackId = 0u; trackId < startParameters.size(); ++trackId) {
-    
+  // The tracks are converted in seed order, so the output doesn't depend
+  // on the number of threads
+  for (std::size_t seed = 0; seed < startParameters.size(); ++seed) {
 
-    ldmx_log(debug)<<"Running CKF on seed params "<<startParameters.at(trackId).parameters().transpose()<<std::endl; 
-    
+    ldmx_log(debug)<<"CKF on seed params "<<startParameters.at(seed).parameters().transpose()<<std::endl; 
 
-    auto results = ckf_->findTracks(startParameters.at(trackId), ckfOptions,tc);
-    
-    if (not results.ok()) {
+    const SeedTracks& result = seed_results[seed];
+    if (not result.ok) {
       ldmx_log(warn)
           <<"CKF Fit failed"<<std::endl;
       continue;
     }
-    
-    //No track found
-    if (tc.size() < trackId + 1)
-      continue;
-    
 
-    ldmx_log(debug)<<"Filling track info"<<std::endl;
+    auto& tc = worker_tracks[result.worker]->tc;
 
-    // The track tips are the last measurement index 
-    //Acts::MultiTrajectory<Acts::VectorMultiTrajectory> mj = tc.getTrack(trackId);
-    //                                                        //.container()
-    //                                                        //.trackStateContainer();
-    
-    auto track = tc.getTrack(trackId);
-    calculateTrackQuantities(track);
+    //No track found if the range is empty
+    for (std::size_t trackId = result.begin; trackId < result.end; ++trackId) {
 
-    const Acts::BoundVector& perigee_pars =  track.parameters();
-    const Acts::BoundMatrix& trk_cov  = track.covariance();
-    const Acts::Surface& perigee_surface = track.referenceSurface();
+      ldmx_log(debug)<<"Filling track info"<<std::endl;
+
+      auto track = tc.getTrack(trackId);
+      calculateTrackQuantities(track);
+
+      const Acts::BoundVector& perigee_pars =  track.parameters();
+      const Acts::BoundMatrix& trk_cov  = track.covariance();
+      const Acts::Surface& perigee_surface = track.referenceSurface();
     
-    ldmx_log(debug)<<"Found track: nMeas "<< track.nMeasurements()<<std::endl
-                   <<"Track states "<< track.nTrackStates()<<std::endl
-                   <<perigee_pars[Acts::eBoundLoc0]<<" "
-                   <<perigee_pars[Acts::eBoundLoc1]<<" "
-                   <<perigee_pars[Acts::eBoundPhi]<<" "
-                   <<perigee_pars[Acts::eBoundTheta]<<" "
-                   <<perigee_pars[Acts::eBoundQOverP]<<std::endl
-                   <<"nHoles  "<<track.nHoles();
+      ldmx_log(debug)<<"Found track: nMeas "<< track.nMeasurements()<<std::endl
+                     <<"Track states "<< track.nTrackStates()<<std::endl
+                     <<perigee_pars[Acts::eBoundLoc0]<<" "
+                     <<perigee_pars[Acts::eBoundLoc1]<<" "
+                     <<perigee_pars[Acts::eBoundPhi]<<" "
+                     <<perigee_pars[Acts::eBoundTheta]<<" "
+                     <<perigee_pars[Acts::eBoundQOverP]<<std::endl
+                     <<"nHoles  "<<track.nHoles();
     
-    ldmx::Track trk = ldmx::Track();
-    trk.setPerigeeLocation(perigee_surface.transform(geometry_context()).translation()(0),
-                           perigee_surface.transform(geometry_context()).translation()(1),
-                           perigee_surface.transform(geometry_context()).translation()(2));
+      ldmx::Track trk = ldmx::Track();
+      trk.setPerigeeLocation(perigee_surface.transform(geometry_context()).translation()(0),
+                             perigee_surface.transform(geometry_context()).translation()(1),
+                             perigee_surface.transform(geometry_context()).translation()(2));
     
     
-    trk.setChi2(track.chi2());
-    trk.setNhits(track.nMeasurements());
-    //trk.setNdf(track.nDoF());
-    //TODO Switch back to nDoF when Acts is fixed. 
-    trk.setNdf(track.nMeasurements() - 5);
-    trk.setNsharedHits(track.nSharedHits());
+      trk.setChi2(track.chi2());
+      trk.setNhits(track.nMeasurements());
+      //trk.setNdf(track.nDoF());
+      //TODO Switch back to nDoF when Acts is fixed. 
+      trk.setNdf(track.nMeasurements() - 5);
+      trk.setNsharedHits(track.nSharedHits());
     
-    trk.setPerigeeParameters(tracking::sim::utils::convertActsToLdmxPars(perigee_pars));
-    std::vector<double> v_trk_cov;
-    tracking::sim::utils::flatCov(trk_cov, v_trk_cov);
-    trk.setPerigeeCov(v_trk_cov);
+      trk.setPerigeeParameters(tracking::sim::utils::convertActsToLdmxPars(perigee_pars));
+      std::vector<double> v_trk_cov;
+      tracking::sim::utils::flatCov(trk_cov, v_trk_cov);
+      trk.setPerigeeCov(v_trk_cov);
     
-    Acts::Vector3 trk_momentum = track.momentum();
-    trk.setMomentum(trk_momentum(0), trk_momentum(1), trk_momentum(2));
+      Acts::Vector3 trk_momentum = track.momentum();
+      trk.setMomentum(trk_momentum(0), trk_momentum(1), trk_momentum(2));
     
     
-    //Add measurements on track
-    for (auto ts : track.trackStates()) {
+      //Add measurements on track
+      for (auto ts : track.trackStates()) {
       
-      //Check if the track state is a measurement
-      auto typeFlags = ts.typeFlags();
-      if (typeFlags.test(Acts::TrackStateFlag::MeasurementFlag)) {
-        ActsExamples::IndexSourceLink sl =
-            ts.getUncalibratedSourceLink().get<ActsExamples::IndexSourceLink>();
-        ldmx::Measurement ldmx_meas = measurements.at(sl.index());
-        ldmx_log(debug)<<"SourceLink Index::"<<sl.index();
-        ldmx_log(debug)<<"Measurement:\n"<<ldmx_meas<<"\n";
-        trk.addMeasurementIndex(sl.index());
+        //Check if the track state is a measurement
+        auto typeFlags = ts.typeFlags();
+        if (typeFlags.test(Acts::TrackStateFlag::MeasurementFlag)) {
+          ActsExamples::IndexSourceLink sl =
+              ts.getUncalibratedSourceLink().get<ActsExamples::IndexSourceLink>();
+          ldmx::Measurement ldmx_meas = measurements.at(sl.index());
+          ldmx_log(debug)<<"SourceLink Index::"<<sl.index();
+          ldmx_log(debug)<<"Measurement:\n"<<ldmx_meas<<"\n";
+          trk.addMeasurementIndex(sl.index());
+        }
       }
-    }
-
-    // Extrapolations
-    
-    //Define the target surface - be careful:
-    // x - downstream
-    // y - left (when looking along x)
-    // z - up
-    // Passing identity here means that your target surface is oriented in the same way
-    Acts::RotationMatrix3 surf_rotation = Acts::RotationMatrix3::Zero();
-    //u direction along +Y
-    surf_rotation(1,0) = 1;
-    //v direction along +Z
-    surf_rotation(2,1) = 1;
-    //w direction along +X
-    surf_rotation(0,2) = 1;
-
-    const double ECAL_SCORING_PLANE  = 240.5;
-    Acts::Vector3 pos(ECAL_SCORING_PLANE, 0., 0.);
-    Acts::Translation3 surf_translation(pos);
-    Acts::Transform3 surf_transform(surf_translation * surf_rotation);
-    
-    //Unbounded surface
-    const std::shared_ptr<Acts::PlaneSurface> ecal_surface =
-        Acts::Surface::makeShared<Acts::PlaneSurface>(surf_transform);
-    
-    Acts::Vector3 target_pos(0., 0., 0.);
-    Acts::Translation3 target_translation(target_pos);
-    Acts::Transform3 target_transform(target_translation * surf_rotation);
-    
-    //Unbounded surface
-    const std::shared_ptr<Acts::PlaneSurface> target_surface =
-        Acts::Surface::makeShared<Acts::PlaneSurface>(target_transform);
 
-
-    ldmx_log(debug)<<"Starting the extrapolations to target and ecal";
-
-    ldmx_log(debug)<<"Target extrapolation";
-    ldmx::Track::TrackState tsAtTarget;
-    bool success = trk_extrap_->TrackStateAtSurface(track,
-                                                    target_surface,
-                                                    tsAtTarget,
-                                                    ldmx::TrackStateType::AtTarget);
-    
-    if (success)
-      trk.addTrackState(tsAtTarget);
-    
-
-    ldmx_log(debug)<<"Ecal Extrapolation";
-    ldmx::Track::TrackState tsAtEcal;
-    success = trk_extrap_->TrackStateAtSurface(track,
-                                               ecal_surface,
-                                               tsAtEcal,
-                                               ldmx::TrackStateType::AtECAL);
-    
-    
-    if (success)
-      trk.addTrackState(tsAtEcal);
-    
-    
-    //Truth matching
-    if (truthMatchingTool) {
-      auto truthInfo = truthMatchingTool->TruthMatch(trk);
-      trk.setTrackID(truthInfo.trackID);
-      trk.setPdgID(truthInfo.pdgID);
-      trk.setTruthProb(truthInfo.truthProb);
-    }
+      // Extrapolations to the surfaces built in onNewRun
+    
+      ldmx_log(debug)<<"Starting the extrapolations to target and ecal";
+
+      // The target and the ecal are reached from the closest track state,
+      // the surfaces of one direction in a single propagation
+      auto states =
+          telescope_trk_extrap_
+              ? telescope_trk_extrap_->TrackStatesAtSurfaces(
+                    track, extrapolation_targets_)
+              : trk_extrap_->TrackStatesAtSurfaces(track,
+                                                   extrapolation_targets_);
+      for (const auto& state : states) trk.addTrackState(state);
+    
+      //Truth matching
+      if (truthMatchingTool) {
+        auto truthInfo = truthMatchingTool->TruthMatch(trk);
+        trk.setTrackID(truthInfo.trackID);
+        trk.setPdgID(truthInfo.pdgID);
+        trk.setTruthProb(truthInfo.truthProb);
+      }
     
-    //At least 8 hits and p > 50 MeV
-    if (trk.getNhits() > min_hits_ && abs(1. / trk.getQoP()) > 0.05) {
-      tracks.push_back(trk);
-      ntracks_++;
-    }
+      //At least 8 hits and p > 50 MeV
+      if (trk.getNhits() > min_hits_ && abs(1. / trk.getQoP()) > 0.05) {
+        tracks.push_back(trk);
+        ntracks_++;
+      }
     
+    }  // loop tracks of the seed
   }    // loop seed track parameters
   
   
@@ -585,6 +610,8 @@ void CKFProcessor::produce(framework::Event& event) {
     
   // Add the tracks to the event
   event.add(out_trk_collection_, tracks);
+  if (columnar_output_)
+    event.add(out_trk_collection_ + "Columns", ldmx::TrackColumns(tracks));
 
   auto end = std::chrono::high_resolution_clock::now();
   // long long microseconds =
@@ -615,6 +642,32 @@ void CKFProcessor::onProcessEnd() {
             << profiling_map_["ckf_run"] / nevents_ << " ms" << std::endl;
   std::cout << "result_loop Avg Time/Event = "
             << profiling_map_["result_loop"] / nevents_ << " ms" << std::endl;
+
+  if (step_statistics_) {
+    double n = nseeds_ > 0 ? nseeds_ : 1.;
+    std::cout << "Propagation::" << std::endl;
+    std::cout << "steps                 Avg/Seed = " << step_totals_.steps / n
+              << "  Max/Seed = " << max_seed_steps_ << std::endl;
+    std::cout << "field evaluations     Avg/Seed = "
+              << step_totals_.field_evaluations / n << std::endl;
+    std::cout << "surfaces              Avg/Seed = "
+              << step_totals_.surfaces / n << std::endl;
+    std::cout << "accuracy limited steps fraction = "
+              << (step_totals_.steps > 0
+                      ? double(step_totals_.accuracy_limited_steps) /
+                            step_totals_.steps
+                      : 0.)
+              << std::endl;
+  }
+
+  if (step_statistics_outfile_) {
+    step_statistics_outfile_->cd();
+    step_statistics_tree_->Write();
+    step_statistics_outfile_->Close();
+    delete step_statistics_outfile_;
+    step_statistics_outfile_ = nullptr;
+    step_statistics_tree_ = nullptr;
+  }
 }
 
 void CKFProcessor::configure(framework::config::Parameters& parameters) {
@@ -630,11 +683,21 @@ void CKFProcessor::configure(framework::config::Parameters& parameters) {
 
   bfield_ = parameters.getParameter<double>("bfield", -1.5);
   const_b_field_ = parameters.getParameter<bool>("const_b_field", false);
-  field_map_ = parameters.getParameter<std::string>("field_map");
+  hybrid_b_field_ = parameters.getParameter<bool>("hybrid_b_field", false);
+  telescope_navigator_ =
+      parameters.getParameter<bool>("telescope_navigator", false);
   propagator_step_size_ =
       parameters.getParameter<double>("propagator_step_size", 200.);
   propagator_maxSteps_ =
       parameters.getParameter<int>("propagator_maxSteps", 10000);
+  adaptive_step_size_ =
+      parameters.getParameter<bool>("adaptive_step_size", false);
+  adaptive_step_field_tolerance_ =
+      parameters.getParameter<double>("adaptive_step_field_tolerance", 0.05);
+  adaptive_step_min_ = parameters.getParameter<double>("adaptive_step_min", 5.);
+  step_statistics_ = parameters.getParameter<bool>("step_statistics", false);
+  step_statistics_file_ =
+      parameters.getParameter<std::string>("step_statistics_file", "");
   measurement_collection_ =
       parameters.getParameter<std::string>("measurement_collection","TaggerMeasurements");
   outlier_pval_ = parameters.getParameter<double>("outlier_pval_",3.84);
@@ -665,6 +728,17 @@ void CKFProcessor::configure(framework::config::Parameters& parameters) {
   // output track collection
   out_trk_collection_ =
       parameters.getParameter<std::string>("out_trk_collection", "Tracks");
+  columnar_output_ = parameters.getParameter<bool>("columnar_output", false);
+
+  n_threads_ = parameters.getParameter<int>("n_threads", 1);
+
+  used_hit_tracks_ = parameters.getParameter<std::vector<std::string>>(
+      "used_hit_tracks", {});
+  tracking::sim::HitMask::Config mask_cfg;
+  mask_cfg.min_nhits = parameters.getParameter<int>("used_hit_min_nhits", 7);
+  mask_cfg.max_chi2_ndf =
+      parameters.getParameter<double>("used_hit_max_chi2ndf", 5.);
+  hit_mask_ = tracking::sim::HitMask(mask_cfg);
 
   kf_refit_ = parameters.getParameter<bool>("kf_refit", false);
   gsf_refit_ = parameters.getParameter<bool>("gsf_refit", false);
@@ -688,50 +762,6 @@ void CKFProcessor::testField(
             << std::endl;
 }
 
-auto CKFProcessor::makeGeoIdSourceLinkMap(
-    const geo::TrackersTrackingGeometry& tg,
-    const std::vector<ldmx::Measurement>& measurements)
-    -> std::unordered_multimap<Acts::GeometryIdentifier,
-                               ActsExamples::IndexSourceLink> {
-  std::unordered_multimap<Acts::GeometryIdentifier,
-                          ActsExamples::IndexSourceLink>
-      geoId_sl_map;
-
-
-  ldmx_log(debug) << "makeGeoIdSourceLinkMap::Available measurements"<< measurements.size();
-
-  // Check the hits associated to the surfaces
-  for (unsigned int i_meas = 0; i_meas < measurements.size(); i_meas++) {
-    ldmx::Measurement meas = measurements.at(i_meas);
-    unsigned int layerid = meas.getLayerID();
-
-    const Acts::Surface* hit_surface = tg.getSurface(layerid);
-    
-    
-    if (hit_surface) {
-      // Transform the ldmx space point from global to local and store the
-      // information
-
-      ActsExamples::IndexSourceLink idx_sl(hit_surface->geometryId(),
-                                           i_meas);
-
-      ldmx_log(debug)<<"Insert measurement on surface located at::"<<hit_surface->transform(geometry_context()).translation();
-      ldmx_log(debug)<<"and geoId::"<<hit_surface->geometryId()<<std::endl;
-      
-      ldmx_log(debug)<<"Surface info::"<<std::tie(*hit_surface, geometry_context());
-      
-      geoId_sl_map.insert(std::make_pair(hit_surface->geometryId(), idx_sl));
-
-    } else
-      std::cout << getName() << "::HIT " << i_meas << " at layer"
-                << (measurements.at(i_meas)).getLayerID()
-                << " is not associated to any surface?!" << std::endl;
-  }
-  
-  return geoId_sl_map;
-}
-
-
 }  // namespace reco
 }  // namespace tracking
 
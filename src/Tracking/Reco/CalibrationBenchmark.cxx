@@ -0,0 +1,166 @@
+#include "Tracking/Reco/CalibrationBenchmark.h"
+
+#include "Acts/EventData/SourceLink.hpp"
+#include "Acts/EventData/VectorMultiTrajectory.hpp"
+#include "Acts/Geometry/GeometryContext.hpp"
+
+#include "Tracking/Sim/IndexSourceLink.h"
+
+//--- C++ ---//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace tracking::reco {
+
+namespace {
+
+/// The calibration as it was before the calibration view: the measurement
+/// is copied, with its vector of track ids, on every call.
+struct CopyingCalibrator {
+  const std::vector<ldmx::Measurement>* measurements{nullptr};
+
+  void calibrate(const Acts::GeometryContext& /*gctx*/,
+                 Acts::MultiTrajectory<Acts::VectorMultiTrajectory>::TrackStateProxy
+                     trackState) const {
+    ActsExamples::IndexSourceLink sourceLink =
+        trackState.getUncalibratedSourceLink().get<ActsExamples::IndexSourceLink>();
+    auto meas = measurements->at(sourceLink.index());
+
+    trackState.calibrated<2>().setZero();
+    Acts::Vector2 local_pos{meas.getLocalPosition()[0], meas.getLocalPosition()[1]};
+    trackState.calibrated<2>().head<2>() = local_pos;
+    trackState.calibratedCovariance<2>().setZero();
+
+    Acts::SymMatrix2 local_cov;
+    local_cov.setZero();
+    local_cov(0,0) = meas.getLocalCovariance()[0];
+    local_cov(1,1) = meas.getLocalCovariance()[1];
+    trackState.calibratedCovariance<2>().block<2,2>(0,0) = local_cov;
+
+    Acts::ActsMatrix<2,6> projector;
+    projector.setZero();
+    projector(0,0) = 1.;
+    projector(1,1) = 1.;
+    trackState.setProjector(projector);
+  }
+
+  void calibrate_1d(const Acts::GeometryContext& /*gctx*/,
+                    Acts::MultiTrajectory<Acts::VectorMultiTrajectory>::TrackStateProxy
+                        trackState) const {
+    ActsExamples::IndexSourceLink sourceLink =
+        trackState.getUncalibratedSourceLink().get<ActsExamples::IndexSourceLink>();
+    auto meas = measurements->at(sourceLink.index());
+
+    trackState.allocateCalibrated(1);
+    trackState.calibrated<1>().setZero();
+    trackState.calibrated<1>()(0) = (meas.getLocalPosition())[0];
+    trackState.calibratedCovariance<1>().setZero();
+    trackState.calibratedCovariance<1>()(0,0) = (meas.getLocalCovariance())[0];
+
+    Acts::ActsMatrix<2,6> projector;
+    projector.setZero();
+    projector(0,0) = 1.;
+    projector(1,1) = 1.;
+    trackState.setProjector(projector.row(0));
+  }
+};
+
+}  // namespace
+
+CalibrationBenchmark::CalibrationBenchmark(const std::string& name,
+                                           framework::Process& process)
+    : framework::Producer(name, process) {}
+
+void CalibrationBenchmark::produce(framework::Event& event) {
+  const std::vector<ldmx::Measurement> measurements =
+      event.getCollection<ldmx::Measurement>(measurement_collection_);
+  if (measurements.empty()) return;
+
+  const CopyingCalibrator copying{&measurements};
+
+  std::vector<double> copy_values, view_values;
+  for (int r = 0; r < n_repeat_; r++) {
+    copy_time_ += timeCalibrations(copying, measurements.size(), copy_values);
+
+    // The view is filled once per event, so its cost is included
+    auto start = std::chrono::high_resolution_clock::now();
+    view_.fill(measurements);
+    auto filled = std::chrono::high_resolution_clock::now();
+    view_time_ +=
+        std::chrono::duration<double, std::milli>(filled - start).count();
+
+    const tracking::sim::LdmxMeasurementCalibrator calibrator{view_};
+    view_time_ += timeCalibrations(calibrator, measurements.size(), view_values);
+
+    n_calibrations_ += measurements.size();
+  }
+
+  for (std::size_t i = 0; i < measurements.size(); i++)
+    max_diff_ = std::max(max_diff_, std::abs(copy_values[i] - view_values[i]));
+}
+
+template <typename calibrator_t>
+double CalibrationBenchmark::timeCalibrations(const calibrator_t& calibrator,
+                                              std::size_t n_measurements,
+                                              std::vector<double>& values) const {
+  // Fresh track states, one per measurement, as the CKF would create them
+  Acts::VectorMultiTrajectory traj;
+  std::vector<Acts::MultiTrajectoryTraits::IndexType> states;
+  states.reserve(n_measurements);
+  for (std::size_t i = 0; i < n_measurements; i++) {
+    auto index = traj.addTrackState();
+    traj.getTrackState(index).setUncalibratedSourceLink(
+        Acts::SourceLink{ActsExamples::IndexSourceLink(
+            Acts::GeometryIdentifier(), static_cast<ActsExamples::Index>(i))});
+    states.push_back(index);
+  }
+
+  const Acts::GeometryContext gctx;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (auto index : states) {
+    if (use1Dmeasurements_)
+      calibrator.calibrate_1d(gctx, traj.getTrackState(index));
+    else
+      calibrator.calibrate(gctx, traj.getTrackState(index));
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  values.resize(n_measurements);
+  for (std::size_t i = 0; i < n_measurements; i++) {
+    auto ts = traj.getTrackState(states[i]);
+    values[i] = use1Dmeasurements_ ? ts.template calibrated<1>()(0)
+                                   : ts.template calibrated<2>()(0);
+  }
+
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void CalibrationBenchmark::onProcessEnd() {
+  auto rate = [this](double time) {
+    return time > 0. ? n_calibrations_ / time * 1e3 : 0.;
+  };
+
+  std::cout << "PROCESSOR:: " << getName() << std::endl
+            << "calibrations: " << n_calibrations_
+            << (use1Dmeasurements_ ? " (1D)" : " (2D)") << std::endl
+            << "copying calibrator  calibrations/s = " << rate(copy_time_)
+            << std::endl
+            << "calibration view    calibrations/s = " << rate(view_time_)
+            << std::endl
+            << "speedup = " << (view_time_ > 0. ? copy_time_ / view_time_ : 0.)
+            << std::endl
+            << "max |diff| = " << max_diff_ << std::endl;
+}
+
+void CalibrationBenchmark::configure(framework::config::Parameters& parameters) {
+  measurement_collection_ = parameters.getParameter<std::string>(
+      "measurement_collection", "TaggerMeasurements");
+  n_repeat_ = parameters.getParameter<int>("n_repeat", 10);
+  use1Dmeasurements_ = parameters.getParameter<bool>("use1Dmeasurements", true);
+}
+
+}  // namespace tracking::reco
+
+DECLARE_PRODUCER_NS(tracking::reco, CalibrationBenchmark)
@@ -9,7 +9,7 @@ namespace tracking {
 namespace reco {
 
 CustomStatePropagator::CustomStatePropagator(const std::string&name, framework::Process& process)
-    : framework::Producer(name,process) {
+    : TrackingGeometryUser(name,process) {
   
 }
 
@@ -41,12 +41,12 @@ void CustomStatePropagator::onProcessStart() {
   outTree_->Branch("end_py",&end_py);
   outTree_->Branch("end_pz",&end_pz);
 
-  
-  // Setup a interpolated bfield map
-  const auto map = std::make_shared<InterpolatedMagneticField3>(
-      loadDefaultBField(field_map_,
-                        default_transformPos,
-                        default_transformBField));
+}
+
+void CustomStatePropagator::onNewRun(const ldmx::RunHeader& rh) {
+
+  // The interpolated bfield map is shared through the conditions
+  const auto map = magnetic_field();
   
   const auto stepper = Acts::EigenStepper<>{map};
 
@@ -176,13 +176,12 @@ void CustomStatePropagator::onProcessStart() {
     
   }//state propagation
   
-}//on Process Start
+}//on New Run
 
 void CustomStatePropagator::configure(framework::config::Parameters& parameters) {
 
   const double PIo2 = 1.57079632679;
       
-  field_map_     = parameters.getParameter<std::string>("field_map", "");
   surf_location_ = parameters.getParameter<double>("surf_location",350.);
   nstates_       = parameters.getParameter<int>("nstates",10);
   bs_size_       = parameters.getParameter<std::vector<double>>("bs_size",{40.,10.});
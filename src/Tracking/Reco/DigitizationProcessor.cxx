@@ -1,8 +1,14 @@
 #include "Tracking/Reco/DigitizationProcessor.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
 
+#include "Framework/RandomNumberSeedService.h"
 #include "Tracking/Event/Measurement.h"
+#include "Tracking/Sim/GroupBy.h"
 #include "Tracking/Sim/TrackingUtils.h"
 
 using namespace framework;
@@ -14,47 +20,28 @@ DigitizationProcessor::DigitizationProcessor(const std::string& name,
     : TrackingGeometryUser(name, process) {}
 
 void DigitizationProcessor::onProcessStart() {
-  normal_ = std::make_shared<std::normal_distribution<float>>(0., 1.);
+  // The smearing and the strip noise are only reproducible with the
+  // published Philox, check it before using it
+  if (!tracking::sim::PhiloxRandom::checkKnownAnswers())
+    throw std::runtime_error(
+        "DigitizationProcessor: PhiloxRandom doesn't reproduce the "
+        "Philox4x32-10 known answers");
 
-  std::cout << "Loading the tracking geometry" << std::endl;
-
-  // Module Bounds => Take them from the tracking geometry TODO
-  auto moduleBounds = std::make_shared<const Acts::RectangleBounds>(
-      20.17 * Acts::UnitConstants::mm, 50 * Acts::UnitConstants::mm);
-
-  // I assume 5 APVs
-  int nbinsx = 128 * 5;
-
-  // Strips
-  int nbinsy = 1;
-
-  // Thickness = 0.320 mm
-  double thickness = 0.320 * Acts::UnitConstants::mm;
-
-  // Lorentz angle
-  double lAngle = 0.01;
-
-  // Energy threshold
-  double eThresh = 0.;
-
-  // Analogue readout
-  bool isAnalog = true;
-
-  // Cartesian segmentation
-  auto cSegmentation = std::make_shared<const Acts::CartesianSegmentation>(
-      moduleBounds, nbinsx, nbinsy);
-
-  // Negative side readout => TODO Make sure this is correct!
-  //  - Ask Paul what does this mean: depending on how local w is oriented
-  // TODO: load proper lorentz angle
-
-  Acts::DigitizationModule ndModule(cSegmentation, thickness * 0.5, -1, lAngle,
-                                    eThresh, isAnalog);
+  if (strip_digitization_)
+    strip_digitizer_ = std::make_unique<tracking::sim::StripDigitizer>(strip_cfg_);
 
   std::cout << getName() << " Initialization done" << std::endl;
+}
 
-  // Seed the generator
-  generator_.seed(1);
+void DigitizationProcessor::onNewRun(const ldmx::RunHeader& rh) {
+  // Key the generators, the random numbers of a hit then only depend on its
+  // event, sensor and index
+  const auto& rseed = getCondition<framework::RandomNumberSeedService>(
+      framework::RandomNumberSeedService::CONDITIONS_OBJECT_NAME);
+  smearing_random_ = tracking::sim::PhiloxRandom(
+      rseed.getSeed(getName() + "::Smearing"), rh.getRunNumber());
+  strip_random_ = tracking::sim::PhiloxRandom(
+      rseed.getSeed(getName() + "::StripNoise"), rh.getRunNumber());
 }
 
 void DigitizationProcessor::configure(
@@ -70,16 +57,36 @@ void DigitizationProcessor::configure(
   sigma_u_ = parameters.getParameter<double>("sigma_u", 0.01);
   sigma_v_ = parameters.getParameter<double>("sigma_v", 0.);
   merge_hits_ = parameters.getParameter<bool>("merge_hits", false);
+
+  strip_digitization_ =
+      parameters.getParameter<bool>("strip_digitization", false);
+  raw_hit_collection_ = parameters.getParameter<std::string>(
+      "raw_hit_collection", "RawSiStripHits");
+  packed_raw_hits_ = parameters.getParameter<bool>("packed_raw_hits", false);
+  strip_cfg_.n_strips = parameters.getParameter<int>("n_strips", 640);
+  strip_cfg_.lorentz_tan = parameters.getParameter<double>("lorentz_tan", 0.01);
+  strip_cfg_.diffusion = parameters.getParameter<double>("diffusion", 0.006);
+  strip_cfg_.noise = parameters.getParameter<double>("strip_noise", 1000.);
+  strip_cfg_.threshold = parameters.getParameter<double>("strip_threshold", 3.);
+  strip_cfg_.electrons_per_adc =
+      parameters.getParameter<double>("electrons_per_adc", 15.);
+  strip_cfg_.pedestal = parameters.getParameter<double>("pedestal", 4000.);
+  strip_cfg_.shaping_time =
+      parameters.getParameter<double>("shaping_time", 50.);
+  strip_cfg_.first_sample_time =
+      parameters.getParameter<double>("first_sample_time", 0.);
 }
 
 void DigitizationProcessor::produce(framework::Event& event) {
 
   ldmx_log(debug) << " Getting the tracking geometry:" << geometry().getTG();
 
+  event_number_ = event.getEventHeader().getEventNumber();
+
   // Mode 0: Load simulated hits and produce smeared 1d measurements
   // Mode 1: Load simulated hits and produce digitized 1d measurements
 
-  const std::vector<ldmx::SimTrackerHit> sim_hits =
+  const std::vector<ldmx::SimTrackerHit>& sim_hits =
       event.getCollection<ldmx::SimTrackerHit>(hit_collection_);
 
   std::vector<ldmx::SimTrackerHit> merged_hits;
@@ -95,38 +102,113 @@ void DigitizationProcessor::produce(framework::Event& event) {
   }
 
   event.add(out_collection_, measurements);
+
+  // The strips are digitized from all the sim hits, not the merged ones
+  if (!strip_digitizer_) return;
+  auto start = std::chrono::high_resolution_clock::now();
+  if (packed_raw_hits_) {
+    ldmx::RawSiStripHitColumns raw_hits;
+    digitizeStrips(sim_hits, raw_hits);
+    n_raw_hits_ += raw_hits.size();
+    event.add(raw_hit_collection_, raw_hits);
+  } else {
+    std::vector<ldmx::RawSiStripHit> raw_hits;
+    digitizeStrips(sim_hits, raw_hits);
+    n_raw_hits_ += raw_hits.size();
+    event.add(raw_hit_collection_, raw_hits);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  strip_time_ += std::chrono::duration<double, std::milli>(end - start).count();
+  n_strip_sim_hits_ += sim_hits.size();
+  n_strip_events_++;
+}
+
+void DigitizationProcessor::onProcessEnd() {
+  if (!strip_digitizer_) return;
+  double n = n_strip_events_ > 0 ? n_strip_events_ : 1.;
+  std::cout << "PROCESSOR:: " << getName() << std::endl
+            << "events: " << n_strip_events_ << std::endl
+            << "sim hits/event = " << n_strip_sim_hits_ / n
+            << "  raw hits/event = " << n_raw_hits_ / n << std::endl
+            << "strip digitization time/event = " << strip_time_ / n << " ms"
+            << std::endl;
+}
+
+void DigitizationProcessor::digitizeStrips(
+    const std::vector<ldmx::SimTrackerHit>& sim_hits,
+    std::vector<ldmx::RawSiStripHit>& raw_hits) {
+  depositStrips(sim_hits);
+  strip_digitizer_->readout(strip_random_, event_number_, raw_hits);
+
+  ldmx_log(debug) << "Sim_hits Size=" << sim_hits.size()
+                  << " RawSiStripHits Size=" << raw_hits.size();
+}
+
+void DigitizationProcessor::digitizeStrips(
+    const std::vector<ldmx::SimTrackerHit>& sim_hits,
+    ldmx::RawSiStripHitColumns& raw_hits) {
+  depositStrips(sim_hits);
+  strip_digitizer_->readout(strip_random_, event_number_, raw_hits);
+
+  ldmx_log(debug) << "Sim_hits Size=" << sim_hits.size()
+                  << " RawSiStripHits Size=" << raw_hits.size();
+}
+
+void DigitizationProcessor::depositStrips(
+    const std::vector<ldmx::SimTrackerHit>& sim_hits) {
+  strip_digitizer_->clear();
+
+  for (const auto& sim_hit : sim_hits) {
+    auto sensor_id = tracking::sim::utils::getSensorID(sim_hit);
+    const auto* sensor{geometry().getSensor(sensor_id)};
+    if (!sensor) continue;
+
+    // The sim hits are in the Geant4 frame, the sensors in the tracking frame
+    Acts::Vector3 pos(sim_hit.getPosition()[2], sim_hit.getPosition()[0],
+                      sim_hit.getPosition()[1]);
+    Acts::Vector3 mom(sim_hit.getMomentum()[2], sim_hit.getMomentum()[0],
+                      sim_hit.getMomentum()[1]);
+
+    // The hit is at the middle of the step of the particle in the sensor
+    Acts::Vector3 half_step = Acts::Vector3::Zero();
+    if (mom.norm() > 0.)
+      half_step = 0.5 * sim_hit.getPathLength() * mom.normalized();
+
+    double thickness = sensor->thickness > 0. ? sensor->thickness
+                                              : 0.320 * Acts::UnitConstants::mm;
+    strip_digitizer_->deposit(sensor_id, sensor->half_length_u, thickness,
+                              sensor->inverse * (pos - half_step),
+                              sensor->inverse * (pos + half_step),
+                              sim_hit.getEdep(), sim_hit.getTime());
+  }
 }
 
 // This method merges hits that have the same track_id on the same layer.
 // The energy of the merged hit is the sum of the energy of the single sub-hits
 // The position/momentum of the merged hit is the energy-weighted average
-// sihits = vector of hits to merge
-// mergedHits = total merged collection
+// sim_hits = the hit collection
+// group = indices of the hits to merge
+// merged_hits = total merged collection
 
 bool DigitizationProcessor::mergeHits(
-    const std::vector<ldmx::SimTrackerHit>& sihits,
-    std::vector<ldmx::SimTrackerHit>& mergedHits) {
-  if (sihits.size() < 1) return false;
+    const std::vector<ldmx::SimTrackerHit>& sim_hits, const HitGroup& group,
+    std::vector<ldmx::SimTrackerHit>& merged_hits) {
+  if (group.empty()) return false;
 
-  if (sihits.size() == 1) {
-    mergedHits.push_back(sihits[0]);
+  const ldmx::SimTrackerHit& first = sim_hits[group.begin()->index];
+  if (group.size() == 1) {
+    merged_hits.push_back(first);
     return true;
   }
 
-  ldmx::SimTrackerHit mergedHit;
-  // Since all the hits will be on the same sensor, just use the ID of the first
-  mergedHit.setLayerID(sihits[0].getLayerID());
-  mergedHit.setModuleID(sihits[0].getModuleID());
-  mergedHit.setID(sihits[0].getID());
-  mergedHit.setTrackID(sihits[0].getTrackID());
-
   double X{0}, Y{0}, Z{0}, PX{0}, PY{0}, PZ{0};
   double T{0}, E{0}, EDEP{0}, path{0};
   int pdgID{0};
 
-  pdgID = sihits[0].getPdgID();
+  pdgID = first.getPdgID();
 
-  for (auto hit : sihits) {
+  for (const auto& key : group) {
+    const ldmx::SimTrackerHit& hit = sim_hits[key.index];
     double edep_hit = hit.getEdep();
     EDEP += edep_hit;
     E += hit.getEnergy();
@@ -144,12 +226,19 @@ bool DigitizationProcessor::mergeHits(
                    "but different PDGID"
                 << std::endl;
       std::cout << "TRACKID ==" << hit.getTrackID() << " vs "
-                << sihits[0].getTrackID() << std::endl;
+                << first.getTrackID() << std::endl;
       std::cout << "PDGID== " << hit.getPdgID() << " vs " << pdgID << std::endl;
       return false;
     }
   }
 
+  // The merged hit is built in place in the output
+  ldmx::SimTrackerHit& mergedHit = merged_hits.emplace_back();
+  // Since all the hits will be on the same sensor, just use the ID of the first
+  mergedHit.setLayerID(first.getLayerID());
+  mergedHit.setModuleID(first.getModuleID());
+  mergedHit.setID(first.getID());
+  mergedHit.setTrackID(first.getTrackID());
   mergedHit.setTime(T / EDEP);
   mergedHit.setPosition(X / EDEP, Y / EDEP, Z / EDEP);
   mergedHit.setMomentum(PX / EDEP, PY / EDEP, PZ / EDEP);
@@ -158,44 +247,47 @@ bool DigitizationProcessor::mergeHits(
   mergedHit.setEdep(EDEP);
   mergedHit.setPdgID(pdgID);
 
-  mergedHits.push_back(mergedHit);
-
   return true;
 }
 
-// TODO avoid copies and use references
+namespace {
+// Key of the groups of hits to merge
+struct SensorTrack {
+  std::pair<int, int> operator()(
+      const DigitizationProcessor::HitKey& key) const {
+    return {key.sensor, key.track};
+  }
+};
+}  // namespace
+
 bool DigitizationProcessor::mergeSimHits(
     const std::vector<ldmx::SimTrackerHit>& sim_hits,
     std::vector<ldmx::SimTrackerHit>& merged_hits) {
-  // The first key is the index of the sensitive element ID, second key is the
-  // track_id
-  std::map<int, std::map<int, std::vector<ldmx::SimTrackerHit>>> hitmap;
-
-  for (auto hit : sim_hits) {
-    unsigned int index = tracking::sim::utils::getSensorID(hit);
-    unsigned int trackid = hit.getTrackID();
-    hitmap[index][trackid].push_back(hit);
-
-    ldmx_log(debug) << "hitmap being filled, size::[" << index << "]["
-                    << trackid << "] size " << hitmap[index][trackid].size();
+  hit_keys_.clear();
+  hit_keys_.reserve(sim_hits.size());
+  for (std::size_t i = 0; i < sim_hits.size(); i++) {
+    const auto& hit = sim_hits[i];
+    hit_keys_.push_back(
+        {tracking::sim::utils::getSensorID(hit), hit.getTrackID(), i});
   }
 
-  typedef std::map<int,
-                   std::map<int, std::vector<ldmx::SimTrackerHit>>>::iterator
-      hitmap_it1;
-  typedef std::map<int, std::vector<ldmx::SimTrackerHit>>::iterator hitmap_it2;
-  for (hitmap_it1 it = hitmap.begin(); it != hitmap.end(); it++) {
-    for (hitmap_it2 it2 = it->second.begin(); it2 != it->second.end(); it2++) {
-      mergeHits(it2->second, merged_hits);
-    }
-  }
+  // Sorted by sensor and track, the hits of a group stay in the order of the
+  // collection so the sums are the same as when merging them in that order
+  std::sort(hit_keys_.begin(), hit_keys_.end(),
+            [](const HitKey& a, const HitKey& b) {
+              return std::tie(a.sensor, a.track, a.index) <
+                     std::tie(b.sensor, b.track, b.index);
+            });
+
+  merged_hits.reserve(merged_hits.size() + hit_keys_.size());
+  using Groups =
+      ActsExamples::GroupBy<std::vector<HitKey>::const_iterator, SensorTrack>;
+  for (auto&& [key, group] : Groups(hit_keys_.cbegin(), hit_keys_.cend()))
+    mergeHits(sim_hits, group, merged_hits);
 
   ldmx_log(debug) << "Sim_hits Size=" << sim_hits.size()
                   << "Merged_hits Size=" << merged_hits.size();
 
-  // for (auto hit : sim_hits) hit.Print();
-  // for (auto mhit : merged_hits) mhit.Print();
-
   return true;
 }
 
@@ -206,13 +298,26 @@ std::vector<ldmx::Measurement> DigitizationProcessor::digitizeHits(
 
   std::vector<ldmx::Measurement> measurements;
 
+  // The smearing of the hits in one batch, each hit from its own counter
+  if (do_smearing_) {
+    counters_.resize(sim_hits.size());
+    for (std::size_t i = 0; i < sim_hits.size(); i++)
+      counters_[i] = tracking::sim::PhiloxRandom::counter(
+          event_number_, tracking::sim::utils::getSensorID(sim_hits[i]), i);
+    smearing_.resize(counters_.size() *
+                     tracking::sim::PhiloxRandom::kBlockSize);
+    smearing_random_.normal(counters_.data(), counters_.size(),
+                            smearing_.data());
+  }
+
   // Loop over all SimTrackerHits and
   // * Use the position of the SimTrackerHit (global position) and the surface
   //   the hit was created on to extract the local coordinates.
   // * If specified, smear the local coordinates and update the global
   //   coordinates.
   // * Create a Measurement object.
-  for (auto& sim_hit : sim_hits) {
+  for (std::size_t i = 0; i < sim_hits.size(); i++) {
+    const auto& sim_hit = sim_hits[i];
     // Remove low energy deposit hits
     if (sim_hit.getEdep() > min_e_dep_) {
       if (track_id_ > 0 && sim_hit.getTrackID() != track_id_) continue;
@@ -225,55 +330,52 @@ std::vector<ldmx::Measurement> DigitizationProcessor::digitizeHits(
 
       
       
-      // Get the surface
-      auto hit_surface{geometry().getSurface(layer_id)};
+      // Get the sensor
+      const auto* sensor{geometry().getSensor(layer_id)};
 
-      if (hit_surface) {
+      if (sensor) {
         // Transform from global to local coordinates.
-        // hit_surface->toStream(geometry_context(), std::cout);
         ldmx_log(debug) << "Local to global" << std::endl
-                        << hit_surface->transform(geometry_context()).rotation() << std::endl
-                        << hit_surface->transform(geometry_context()).translation();
+                        << sensor->transform.rotation() << std::endl
+                        << sensor->translation;
 
-        Acts::Vector3 dummy_momentum;
-        Acts::Vector2 local_pos;
-        double surface_thickness = 0.320 * Acts::UnitConstants::mm;
         Acts::Vector3 global_pos(measurement.getGlobalPosition()[0],
                                  measurement.getGlobalPosition()[1],
                                  measurement.getGlobalPosition()[2]);
+        Acts::Vector3 local_pos3 = sensor->inverse * global_pos;
 
-        try {
-          local_pos = hit_surface
-                          ->globalToLocal(geometry_context(), global_pos, dummy_momentum,
-                                          surface_thickness)
-                          .value();
-        } catch (const std::exception& e) {
+        // The hit has to be within the thickness of the sensor
+        double surface_thickness = sensor->thickness > 0.
+                                       ? sensor->thickness
+                                       : 0.320 * Acts::UnitConstants::mm;
+        if (std::abs(local_pos3(2)) > surface_thickness) {
           std::cout << "WARNING:: hit not on surface.. Skipping." << std::endl;
           continue;
         }
+        Acts::Vector2 local_pos = local_pos3.topRows<2>();
 
         // Smear the local position
         if (do_smearing_) {
-          float smear_factor{(*normal_)(generator_)};
+          const float* smear_factor =
+              smearing_.data() + i * tracking::sim::PhiloxRandom::kBlockSize;
 
-          local_pos[0] += smear_factor * sigma_u_;
-          smear_factor = (*normal_)(generator_);
-          local_pos[1] += smear_factor * sigma_v_;
+          local_pos[0] += smear_factor[0] * sigma_u_;
+          local_pos[1] += smear_factor[1] * sigma_v_;
 
           // update covariance
           measurement.setLocalCovariance(sigma_u_ * sigma_u_,
                                          sigma_v_ * sigma_v_);
 
           // transform to global
-          auto global_pos{
-              hit_surface->localToGlobal(geometry_context(), local_pos, dummy_momentum)};
+          Acts::Vector3 global_pos{sensor->transform *
+                                   Acts::Vector3(local_pos(0), local_pos(1), 0.)};
           measurement.setGlobalPosition(measurement.getGlobalPosition()[0],
                                         global_pos(1), global_pos(2));
 
         }  // do smearing
         measurement.setLocalPosition(local_pos(0), local_pos(1));
         measurements.push_back(measurement);
-      }  // hit_surface exists
+      }  // sensor exists
       
     }    // energy cut
   }      // loop on sim-hits
@@ -0,0 +1,135 @@
+#include "Tracking/Reco/ExtrapolationBenchmark.h"
+
+#include "Acts/Definitions/Units.hpp"
+#include "Acts/Surfaces/PerigeeSurface.hpp"
+
+#include "Tracking/Event/Track.h"
+#include "Tracking/Sim/TrackingUtils.h"
+
+//--- C++ ---//
+#include <chrono>
+#include <iostream>
+
+namespace tracking::reco {
+
+ExtrapolationBenchmark::ExtrapolationBenchmark(const std::string& name,
+                                               framework::Process& process)
+    : TrackingGeometryUser(name, process) {}
+
+void ExtrapolationBenchmark::onNewRun(const ldmx::RunHeader& rh) {
+  const auto stepper = Acts::EigenStepper<>{magnetic_field()};
+
+  if (telescope_navigator_) {
+    telescope_extrapolator_ =
+        std::make_unique<std::decay_t<decltype(*telescope_extrapolator_)>>(
+            TelescopePropagator(
+                stepper, tracking::sim::InstrumentedNavigator<TelescopeNavigator>(
+                             TelescopeNavigator(geometry()))),
+            geometry_context(), magnetic_field_context());
+  } else {
+    // Same configuration as the CKF
+    Acts::Navigator::Config navCfg{geometry().getTG()};
+    navCfg.resolveMaterial = true;
+    navCfg.resolvePassive = true;
+    navCfg.resolveSensitive = true;
+    navCfg.boundaryCheckLayerResolving = false;
+
+    generic_extrapolator_ =
+        std::make_unique<std::decay_t<decltype(*generic_extrapolator_)>>(
+            GenericPropagator(
+                stepper, tracking::sim::InstrumentedNavigator<Acts::Navigator>(
+                             Acts::Navigator(navCfg))),
+            geometry_context(), magnetic_field_context());
+  }
+
+  surfaces_.clear();
+  for (double x : planes_)
+    surfaces_.push_back(tracking::sim::utils::unboundSurface(x));
+}
+
+void ExtrapolationBenchmark::produce(framework::Event& event) {
+  const auto& tracks = event.getCollection<ldmx::Track>(track_collection_);
+
+  for (const auto& track : tracks) {
+    auto perigee = Acts::Surface::makeShared<Acts::PerigeeSurface>(
+        Acts::Vector3(track.getPerigeeX(), track.getPerigeeY(),
+                      track.getPerigeeZ()));
+
+    Acts::BoundVector params;
+    params << track.getD0(), track.getZ0(), track.getPhi(), track.getTheta(),
+        track.getQoP(), track.getT();
+    Acts::ActsScalar q = track.getQoP() < 0 ? -1 * Acts::UnitConstants::e
+                                            : Acts::UnitConstants::e;
+    const Acts::BoundTrackParameters start(
+        perigee, params, q,
+        tracking::sim::utils::unpackCov(track.getPerigeeCov()));
+
+    if (telescope_extrapolator_)
+      compare(*telescope_extrapolator_, start);
+    else
+      compare(*generic_extrapolator_, start);
+  }
+}
+
+template <typename propagator_t>
+void ExtrapolationBenchmark::compare(
+    TrackExtrapolatorTool<propagator_t>& extrapolator,
+    const Acts::BoundTrackParameters& start) {
+  auto start_time = std::chrono::high_resolution_clock::now();
+  auto parameters = extrapolator.extrapolate(start, surfaces_);
+  auto end_time = std::chrono::high_resolution_clock::now();
+  time_single_pass_ +=
+      std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+  std::vector<std::optional<Acts::BoundTrackParameters>> singles;
+  start_time = std::chrono::high_resolution_clock::now();
+  for (const auto& surface : surfaces_)
+    singles.push_back(extrapolator.extrapolate(start, surface));
+  end_time = std::chrono::high_resolution_clock::now();
+  time_per_surface_ +=
+      std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+  n_tracks_++;
+  for (std::size_t i = 0; i < surfaces_.size(); i++) {
+    if (parameters[i]) n_reached_single_pass_++;
+    if (singles[i]) n_reached_per_surface_++;
+    if (!singles[i] && !parameters[i]) continue;
+    if (!singles[i] || !parameters[i] ||
+        (singles[i]->position(geometry_context()) -
+         parameters[i]->position(geometry_context()))
+                .norm() > tolerance_)
+      n_mismatches_++;
+  }
+}
+
+void ExtrapolationBenchmark::onProcessEnd() {
+  double n = n_tracks_ > 0 ? n_tracks_ : 1.;
+  std::cout << "PROCESSOR:: " << getName() << std::endl
+            << "tracks: " << n_tracks_ << "  planes: " << surfaces_.size()
+            << std::endl
+            << "single propagation  time/track = " << time_single_pass_ / n
+            << " ms  planes reached = " << n_reached_single_pass_ << std::endl
+            << "one per plane       time/track = " << time_per_surface_ / n
+            << " ms  planes reached = " << n_reached_per_surface_ << std::endl
+            << "speedup = "
+            << (time_single_pass_ > 0. ? time_per_surface_ / time_single_pass_
+                                       : 0.)
+            << std::endl
+            << "planes differing by more than " << tolerance_
+            << " mm = " << n_mismatches_ << std::endl;
+}
+
+void ExtrapolationBenchmark::configure(
+    framework::config::Parameters& parameters) {
+  track_collection_ =
+      parameters.getParameter<std::string>("track_collection", "RecoilTracks");
+  planes_ = parameters.getParameter<std::vector<double>>(
+      "planes", {205., 220., 240.5});
+  tolerance_ = parameters.getParameter<double>("tolerance", 0.001);
+  telescope_navigator_ =
+      parameters.getParameter<bool>("telescope_navigator", false);
+}
+
+}  // namespace tracking::reco
+
+DECLARE_PRODUCER_NS(tracking::reco, ExtrapolationBenchmark)
@@ -0,0 +1,215 @@
+#include "Tracking/Reco/FieldMapBenchmark.h"
+
+#include "Acts/Definitions/Units.hpp"
+
+#include "Tracking/Sim/BFieldMapView.h"
+#include "Tracking/Sim/BFieldSoAGrid.h"
+#include "Tracking/Sim/BFieldXYZUtils.h"
+
+//--- C++ ---//
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace tracking::reco {
+
+FieldMapBenchmark::FieldMapBenchmark(const std::string& name,
+                                     framework::Process& process)
+    : TrackingGeometryUser(name, process) {}
+
+void FieldMapBenchmark::onNewRun(const ldmx::RunHeader& rh) {
+  // Same positions for all the benchmarks
+  std::default_random_engine generator;
+  generator.seed(1);
+  std::uniform_real_distribution<double> X(x_range_[0], x_range_[1]);
+  std::uniform_real_distribution<double> Y(y_range_[0], y_range_[1]);
+  std::uniform_real_distribution<double> Z(z_range_[0], z_range_[1]);
+
+  positions_.clear();
+  positions_.reserve(n_lookups_);
+  for (int i = 0; i < n_lookups_; i++)
+    positions_.emplace_back(X(generator), Y(generator), Z(generator));
+
+  // Reference: std::function transformations in Acts::InterpolatedBFieldMap
+  auto start = std::chrono::high_resolution_clock::now();
+  const auto generic_map = std::make_shared<InterpolatedMagneticField3>(
+      loadDefaultBField(field_map_, default_transformPos,
+                        default_transformBField));
+  auto loaded = std::chrono::high_resolution_clock::now();
+
+  // Shared view from the conditions
+  const auto view = magnetic_field();
+  auto view_loaded = std::chrono::high_resolution_clock::now();
+
+  // Structure-of-arrays copies of the shared grid
+  const auto soa_double_grid =
+      std::make_shared<const tracking::sim::BFieldSoAGrid<double>>(
+          *magnetic_field_map().grid());
+  const auto soa_float_grid =
+      std::make_shared<const tracking::sim::BFieldSoAGrid<float>>(
+          *magnetic_field_map().grid());
+  const tracking::sim::BFieldSoAMap<> soa_double(soa_double_grid);
+  const tracking::sim::BFieldSoAMap<tracking::sim::DefaultPosTransform,
+                                    tracking::sim::DefaultFieldTransform, float>
+      soa_float(soa_float_grid);
+
+  std::vector<Acts::Vector3> generic_values, view_values;
+  double generic_time = timeLookups(*generic_map, generic_values);
+  double view_time = timeLookups(*view, view_values);
+
+  std::vector<Acts::Vector3> soa_double_values, soa_float_values;
+  std::vector<Acts::Vector3> batch_double_values, batch_float_values;
+  double soa_double_time = timeLookups(soa_double, soa_double_values);
+  double soa_float_time = timeLookups(soa_float, soa_float_values);
+  double batch_double_time = timeBatchedLookups(soa_double, batch_double_values);
+  double batch_float_time = timeBatchedLookups(soa_float, batch_float_values);
+
+  // Check that all the paths agree with the reference
+  double max_diff = 0.;
+  int n_inside = 0;
+  for (int i = 0; i < n_lookups_; i++) {
+    max_diff = std::max(max_diff, (generic_values[i] - view_values[i]).norm());
+    if (!view_values[i].isZero()) n_inside++;
+  }
+  double soa_double_diff = maxDifference(generic_values, soa_double_values);
+  soa_double_diff = std::max(
+      soa_double_diff, maxDifference(generic_values, batch_double_values));
+  double soa_float_diff = maxDifference(generic_values, soa_float_values);
+  soa_float_diff = std::max(soa_float_diff,
+                            maxDifference(generic_values, batch_float_values));
+
+  auto rate = [this](double time) { return n_lookups_ / time * 1e3; };
+  double generic_rate = rate(generic_time);
+
+  std::cout << "PROCESSOR:: " << getName() << std::endl
+            << "lookups: " << n_lookups_ << " (" << n_inside
+            << " with non-zero field), best of " << n_repeat_ << std::endl
+            << "std::function map  load = "
+            << std::chrono::duration<double, std::milli>(loaded - start).count()
+            << " ms  lookups/s = " << generic_rate << std::endl
+            << "shared map view    load = "
+            << std::chrono::duration<double, std::milli>(view_loaded - loaded)
+                   .count()
+            << " ms  lookups/s = " << rate(view_time)
+            << "  speedup = " << rate(view_time) / generic_rate
+            << "  max |dB| = " << max_diff / Acts::UnitConstants::T << " T"
+            << std::endl
+            << "SoA kernel: "
+            << tracking::sim::BFieldSoAGrid<double>::kernel() << std::endl
+            << "SoA double         lookups/s = " << rate(soa_double_time)
+            << "  batched = " << rate(batch_double_time)
+            << "  speedup = " << rate(batch_double_time) / generic_rate
+            << "  memory = " << soa_double_grid->memory() / 1e6 << " MB"
+            << "  max |dB| = " << soa_double_diff / Acts::UnitConstants::T
+            << " T" << std::endl
+            << "SoA float          lookups/s = " << rate(soa_float_time)
+            << "  batched = " << rate(batch_float_time)
+            << "  speedup = " << rate(batch_float_time) / generic_rate
+            << "  memory = " << soa_float_grid->memory() / 1e6 << " MB"
+            << "  max |dB| = " << soa_float_diff / Acts::UnitConstants::T
+            << " T" << std::endl;
+
+  // Hybrid field, on the same positions. Where the region model covers a
+  // position each component is within the tolerance of the model from the
+  // map, elsewhere the hybrid field is the map itself.
+  const auto model = magnetic_field_map().model();
+  if (!model) {
+    std::cout << "hybrid field       no region model given to the field map "
+                 "provider, not benchmarked"
+              << std::endl;
+    return;
+  }
+  const auto hybrid = magnetic_field_map().makeHybridView(Acts::Vector3::Zero());
+  std::vector<Acts::Vector3> hybrid_values;
+  double hybrid_time = timeLookups(*hybrid, hybrid_values);
+
+  const tracking::sim::DefaultPosTransform to_field_frame;
+  Acts::Vector3 max_deviation = Acts::Vector3::Zero();
+  int n_covered = 0, n_out_of_tolerance = 0;
+  for (int i = 0; i < n_lookups_; i++) {
+    if (model->find(to_field_frame(positions_[i])) == nullptr) continue;
+    n_covered++;
+    Acts::Vector3 deviation = (hybrid_values[i] - view_values[i]).cwiseAbs();
+    max_deviation = max_deviation.cwiseMax(deviation);
+    // Allow for the rounding of the evaluation of the model
+    if (deviation.maxCoeff() > model->tolerance() * (1. + 1e-6))
+      n_out_of_tolerance++;
+  }
+  double fallback_diff = maxDifference(view_values, hybrid_values);
+
+  std::cout << "hybrid field       lookups/s = " << rate(hybrid_time)
+            << "  speedup = " << rate(hybrid_time) / generic_rate
+            << "  vs map view = " << rate(hybrid_time) / rate(view_time)
+            << std::endl
+            << "                   covered = " << n_covered << " of "
+            << n_lookups_ << "  max |dBx|,|dBy|,|dBz| = ("
+            << max_deviation(0) / Acts::UnitConstants::T << ", "
+            << max_deviation(1) / Acts::UnitConstants::T << ", "
+            << max_deviation(2) / Acts::UnitConstants::T
+            << ") T  tolerance = " << model->tolerance() / Acts::UnitConstants::T
+            << " T  out of tolerance = " << n_out_of_tolerance
+            << "  max |dB| = " << fallback_diff / Acts::UnitConstants::T << " T"
+            << std::endl;
+}
+
+double FieldMapBenchmark::timeLookups(const Acts::MagneticFieldProvider& field,
+                                      std::vector<Acts::Vector3>& values) {
+  auto cache = field.makeCache(magnetic_field_context());
+  values.assign(positions_.size(), Acts::Vector3::Zero());
+
+  double best = std::numeric_limits<double>::max();
+  for (int r = 0; r < n_repeat_; r++) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < positions_.size(); i++) {
+      auto result = field.getField(positions_[i], cache);
+      if (result.ok()) values[i] = *result;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    best = std::min(best,
+                    std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best;
+}
+
+template <typename soa_map_t>
+double FieldMapBenchmark::timeBatchedLookups(const soa_map_t& field,
+                                             std::vector<Acts::Vector3>& values) {
+  values.assign(positions_.size(), Acts::Vector3::Zero());
+
+  double best = std::numeric_limits<double>::max();
+  for (int r = 0; r < n_repeat_; r++) {
+    auto start = std::chrono::high_resolution_clock::now();
+    field.getField(positions_, values);
+    auto end = std::chrono::high_resolution_clock::now();
+    best = std::min(best,
+                    std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best;
+}
+
+double FieldMapBenchmark::maxDifference(
+    const std::vector<Acts::Vector3>& reference,
+    const std::vector<Acts::Vector3>& values) const {
+  double max_diff = 0.;
+  for (std::size_t i = 0; i < reference.size(); i++)
+    max_diff = std::max(max_diff, (reference[i] - values[i]).norm());
+  return max_diff;
+}
+
+void FieldMapBenchmark::configure(framework::config::Parameters& parameters) {
+  field_map_ = parameters.getParameter<std::string>("field_map");
+  n_lookups_ = parameters.getParameter<int>("n_lookups", 1000000);
+  n_repeat_ = parameters.getParameter<int>("n_repeat", 5);
+  x_range_ = parameters.getParameter<std::vector<double>>("x_range",
+                                                          {-800., 400.});
+  y_range_ = parameters.getParameter<std::vector<double>>("y_range",
+                                                          {-200., 200.});
+  z_range_ = parameters.getParameter<std::vector<double>>("z_range",
+                                                          {-100., 100.});
+}
+
+}  // namespace tracking::reco
+
+DECLARE_PRODUCER_NS(tracking::reco, FieldMapBenchmark)
@@ -0,0 +1,155 @@
+#include "Tracking/Reco/NavigatorBenchmark.h"
+
+#include "Acts/Definitions/Units.hpp"
+#include "Acts/Propagator/AbortList.hpp"
+#include "Acts/Propagator/ActionList.hpp"
+#include "Acts/Propagator/MaterialInteractor.hpp"
+#include "Acts/Propagator/StandardAborters.hpp"
+#include "Acts/Surfaces/PerigeeSurface.hpp"
+
+#include "Tracking/Event/Track.h"
+#include "Tracking/Sim/TrackingUtils.h"
+
+//--- C++ ---//
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace tracking::reco {
+
+NavigatorBenchmark::NavigatorBenchmark(const std::string& name,
+                                       framework::Process& process)
+    : TrackingGeometryUser(name, process) {}
+
+void NavigatorBenchmark::onNewRun(const ldmx::RunHeader& rh) {
+  const auto stepper = Acts::EigenStepper<>{magnetic_field()};
+
+  // Same configuration as the CKF
+  Acts::Navigator::Config navCfg{geometry().getTG()};
+  navCfg.resolveMaterial = true;
+  navCfg.resolvePassive = true;
+  navCfg.resolveSensitive = true;
+  navCfg.boundaryCheckLayerResolving = false;
+
+  generic_propagator_ = std::make_unique<std::decay_t<decltype(*generic_propagator_)>>(
+      stepper, Acts::Navigator(navCfg));
+  telescope_propagator_ =
+      std::make_unique<std::decay_t<decltype(*telescope_propagator_)>>(
+          stepper, TelescopeNavigator(geometry()));
+
+  const auto& planes = geometry().getTelescopePlanes();
+  if (planes.empty())
+    throw std::runtime_error("NavigatorBenchmark: no planes of sensors");
+  first_plane_ = tracking::sim::utils::unboundSurface(planes.front().x);
+  last_plane_ = tracking::sim::utils::unboundSurface(planes.back().x);
+}
+
+void NavigatorBenchmark::produce(framework::Event& event) {
+  const std::vector<ldmx::Track> tracks =
+      event.getCollection<ldmx::Track>(track_collection_);
+
+  std::vector<Acts::GeometryIdentifier> generic_sensors, telescope_sensors;
+  for (const auto& track : tracks) {
+    auto perigee = Acts::Surface::makeShared<Acts::PerigeeSurface>(
+        Acts::Vector3(track.getPerigeeX(), track.getPerigeeY(),
+                      track.getPerigeeZ()));
+
+    Acts::BoundVector params;
+    params << track.getD0(), track.getZ0(), track.getPhi(), track.getTheta(),
+        track.getQoP(), track.getT();
+    Acts::ActsScalar q = track.getQoP() < 0 ? -1 * Acts::UnitConstants::e
+                                            : Acts::UnitConstants::e;
+    const Acts::BoundTrackParameters start(
+        perigee, params, q,
+        tracking::sim::utils::unpackCov(track.getPerigeeCov()));
+
+    // Both navigators stop on the last plane in the direction of the track
+    const Acts::Surface& target =
+        start.unitDirection()(0) < 0. ? *first_plane_ : *last_plane_;
+    propagate(*generic_propagator_, start, target, generic_sensors,
+              generic_totals_);
+    propagate(*telescope_propagator_, start, target, telescope_sensors,
+              telescope_totals_);
+
+    if (generic_sensors != telescope_sensors) n_mismatches_++;
+  }
+}
+
+template <typename propagator_t>
+void NavigatorBenchmark::propagate(
+    const propagator_t& propagator, const Acts::BoundTrackParameters& start,
+    const Acts::Surface& target,
+    std::vector<Acts::GeometryIdentifier>& sensors, Totals& totals) const {
+  using ActionList = Acts::ActionList<Acts::MaterialInteractor>;
+  using AbortList = Acts::AbortList<Acts::EndOfWorldReached>;
+
+  Acts::PropagatorOptions<ActionList, AbortList> options(
+      geometry_context(), magnetic_field_context());
+  options.pathLimit = std::numeric_limits<double>::max();
+  options.loopProtection = false;
+  options.maxStepSize = propagator_step_size_ * Acts::UnitConstants::mm;
+  options.maxSteps = propagator_maxSteps_;
+  options.mass = 0.511 * Acts::UnitConstants::MeV;
+
+  auto& interactor = options.actionList.template get<Acts::MaterialInteractor>();
+  interactor.multipleScattering = true;
+  interactor.energyLoss = true;
+  interactor.recordInteractions = true;
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  auto result = propagator.propagate(start, target, options);
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  totals.n_tracks++;
+  totals.time +=
+      std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+  sensors.clear();
+  if (!result.ok()) {
+    totals.n_failed++;
+    return;
+  }
+  totals.n_steps += result.value().steps;
+
+  const auto& recorded =
+      result.value().template get<Acts::MaterialInteractor::result_type>();
+  for (const auto& interaction : recorded.materialInteractions) {
+    if (interaction.surface)
+      sensors.push_back(interaction.surface->geometryId());
+  }
+}
+
+void NavigatorBenchmark::onProcessEnd() {
+  auto report = [](const std::string& name, const Totals& totals) {
+    double n = totals.n_tracks > 0 ? totals.n_tracks : 1.;
+    std::cout << name << " steps/track = " << totals.n_steps / n
+              << "  time/track = " << totals.time / n << " ms"
+              << "  failed = " << totals.n_failed << std::endl;
+  };
+
+  std::cout << "PROCESSOR:: " << getName() << std::endl
+            << "tracks: " << generic_totals_.n_tracks << std::endl;
+  report("generic navigator  ", generic_totals_);
+  report("telescope navigator", telescope_totals_);
+  std::cout << "speedup = "
+            << (telescope_totals_.time > 0.
+                    ? generic_totals_.time / telescope_totals_.time
+                    : 0.)
+            << std::endl
+            << "tracks crossing different sensors = " << n_mismatches_
+            << std::endl;
+}
+
+void NavigatorBenchmark::configure(framework::config::Parameters& parameters) {
+  track_collection_ =
+      parameters.getParameter<std::string>("track_collection", "TaggerTracks");
+  propagator_step_size_ =
+      parameters.getParameter<double>("propagator_step_size", 200.);
+  propagator_maxSteps_ =
+      parameters.getParameter<int>("propagator_maxSteps", 10000);
+}
+
+}  // namespace tracking::reco
+
+DECLARE_PRODUCER_NS(tracking::reco, NavigatorBenchmark)
@@ -4,6 +4,14 @@
 #include "Acts/Seeding/EstimateTrackParamsFromSeed.hpp"
 #include "Eigen/Dense"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
 
 /* This processor takes in input a set of 3D space points and builds seedTracks
  * using the ACTS algorithm which is based on the ATLAS 3-space point conformal
@@ -17,6 +25,29 @@ using Eigen::VectorXd;
 namespace tracking {
 namespace reco {
 
+namespace {
+
+/// Number of measurements shared by two seeds, from their sorted indices
+int sharedHits(const std::array<unsigned int, 5>& hits1,
+               const std::array<unsigned int, 5>& hits2) {
+  int shared = 0;
+  auto it1 = hits1.begin(), it2 = hits2.begin();
+  while (it1 != hits1.end() && it2 != hits2.end()) {
+    if (*it1 < *it2) {
+      ++it1;
+    } else if (*it2 < *it1) {
+      ++it2;
+    } else {
+      shared++;
+      ++it1;
+      ++it2;
+    }
+  }
+  return shared;
+}
+
+}  // namespace
+
 SeedFinderProcessor::SeedFinderProcessor(const std::string& name,
                                          framework::Process& process)
     : TrackingGeometryUser(name, process) {
@@ -65,11 +96,47 @@ void SeedFinderProcessor::configure(framework::config::Parameters& parameters) {
       parameters.getParameter<double>("z0max", 60. * Acts::UnitConstants::mm);
   strategies_ = parameters.getParameter<std::vector<std::string>>(
       "strategies", {"0,1,2,3,4"});
+  if (strategies_.empty()) strategies_ = {"0,1,2,3,4"};
+  max_shared_hits_ = parameters.getParameter<int>("max_shared_hits", 1);
+  n_threads_ = parameters.getParameter<int>("n_threads", 1);
+
+  used_hit_tracks_ = parameters.getParameter<std::vector<std::string>>(
+      "used_hit_tracks", {});
+  tracking::sim::HitMask::Config mask_cfg;
+  mask_cfg.min_nhits = parameters.getParameter<int>("used_hit_min_nhits", 7);
+  mask_cfg.max_chi2_ndf =
+      parameters.getParameter<double>("used_hit_max_chi2ndf", 5.);
+  hit_mask_ = tracking::sim::HitMask(mask_cfg);
+
+  // Each strategy is a comma separated list of the 5 layers to seed from
+  seed_strategies_.clear();
+  for (const auto& strategy : strategies_) {
+    SeedStrategy seed_strategy;
+    std::stringstream layers(strategy);
+    std::string layer;
+    while (std::getline(layers, layer, ','))
+      seed_strategy.layers.push_back(std::stoi(layer));
+    if (seed_strategy.layers.size() != 5) {
+      throw std::runtime_error("SeedFinderProcessor: the strategy '" +
+                               strategy + "' doesn't have 5 layers.");
+    }
+    seed_strategies_.push_back(std::move(seed_strategy));
+  }
   bfield_ = parameters.getParameter<double>("bfield", 1.5);
+  window_tolerance_ = parameters.getParameter<double>(
+      "window_tolerance", 2. * Acts::UnitConstants::mm);
+
+  // The momentum of a seed is p = 0.3 * B * R * 0.001 GeV, with the radius
+  // R = 1 / (2 |b2|) from the curvature b2 of the bending plane parabola.
+  max_curvature_ = pmin_ > 0. ? 0.3 * bfield_ * 0.001 / (2. * pmin_)
+                              : std::numeric_limits<double>::infinity();
+  min_curvature_ = 0.3 * bfield_ * 0.001 / (2. * pmax_);
 }
 
 void SeedFinderProcessor::produce(framework::Event& event) {
+  // The conditions are fetched here, the workers below only read them
   const auto& tg{geometry()};
+  const auto& gctx{geometry_context()};
   auto start = std::chrono::high_resolution_clock::now();
   std::vector<ldmx::Track> seed_tracks;
 
@@ -87,22 +154,113 @@ void SeedFinderProcessor::produce(framework::Event& event) {
     truthMatchingTool_->setup(particleMap,measurements);
   }
 
+  // Skip the hits already used by the good tracks of the previous passes
+  const tracking::sim::HitMask* used_hits = nullptr;
+  if (!used_hit_tracks_.empty()) {
+    hit_mask_.reset(measurements.size());
+    for (const auto& coll : used_hit_tracks_)
+      hit_mask_.mask(event.getCollection<ldmx::Track>(coll));
+    used_hits = &hit_mask_;
+    ldmx_log(debug) << hit_mask_.count() << " of " << measurements.size()
+                    << " measurements used by the previous passes";
+  }
+
   ldmx_log(debug) << "Preparing the strategies";
-  
-  groups_map.clear();
-  std::vector<int> strategy = {0, 1, 2, 3, 4};
-  bool success = GroupStrips(measurements, strategy);
-  if (success) FindSeedsFromMap(seed_tracks);
 
-  /*
-  groups_map.clear();
-  strategy = {3,4,5,6,7};
-  success = GroupStrips(measurements,strategy);
-  if (success)
-    FindSeedsFromMap(seed_tracks);
+  std::vector<char> grouped(seed_strategies_.size());
+  for (std::size_t s = 0; s < seed_strategies_.size(); s++) {
+    seed_strategies_[s].clear();
+    grouped[s] =
+        GroupStrips(tg, measurements, used_hits, seed_strategies_[s]);
+  }
+
+  // Each strategy has its own state, so the strategies can run in parallel
+  auto findSeeds = [&](std::size_t s) {
+    if (grouped[s]) FindSeedsFromMap(tg, gctx, seed_strategies_[s]);
+  };
+
+  const std::size_t n_workers = std::max<std::size_t>(
+      1, std::min<std::size_t>(n_threads_, seed_strategies_.size()));
+  if (n_workers == 1) {
+    for (std::size_t s = 0; s < seed_strategies_.size(); s++) findSeeds(s);
+  } else {
+    std::atomic<std::size_t> next_strategy{0};
+    std::vector<std::thread> workers;
+    for (std::size_t w = 0; w < n_workers; w++) {
+      workers.emplace_back([&]() {
+        for (std::size_t s = next_strategy++; s < seed_strategies_.size();
+             s = next_strategy++)
+          findSeeds(s);
+      });
+    }
+    for (auto& worker : workers) worker.join();
+  }
+
+  // The seeds are merged in the order of the strategies, so the output
+  // doesn't depend on the number of threads. A seed sharing too many
+  // measurements with a seed of a previous strategy is a duplicate.
+  std::vector<std::array<unsigned int, 5>> kept_hits;
+  for (auto& strategy : seed_strategies_) {
+    const std::size_t n_previous = kept_hits.size();
+
+    for (std::size_t i = 0; i < strategy.seeds.size(); i++) {
+      const auto& seed_hits = strategy.seed_hits[i];
+      std::array<unsigned int, 5> hits;
+      for (std::size_t j = 0; j < hits.size(); j++)
+        hits[j] = seed_hits[j] - measurements.data();
+      std::sort(hits.begin(), hits.end());
+
+      bool duplicate = std::any_of(
+          kept_hits.begin(), kept_hits.begin() + n_previous,
+          [&](const auto& kept) {
+            return sharedHits(kept, hits) > max_shared_hits_;
+          });
+      if (duplicate) {
+        nduplicates_++;
+        continue;
+      }
+
+      ldmx::Track& seedTrack = strategy.seeds[i];
+      for (const ldmx::Measurement* meas : seed_hits)
+        seedTrack.addMeasurementIndex(meas - measurements.data());
+
+      ldmx_log(debug) << "seed parameters at perigee location" << std::endl
+                      << seedTrack.getD0() << " " << seedTrack.getZ0() << " "
+                      << seedTrack.getPhi() << " " << seedTrack.getTheta()
+                      << " " << seedTrack.getQoP();
+
+      if (truthMatchingTool_->configured()) {
+        std::vector<ldmx::Measurement> vmeas;
+        vmeas.reserve(seed_hits.size());
+        for (const ldmx::Measurement* meas : seed_hits) vmeas.push_back(*meas);
+        auto truthInfo = truthMatchingTool_->TruthMatch(vmeas);
+        seedTrack.setTrackID(truthInfo.trackID);
+        seedTrack.setPdgID(truthInfo.pdgID);
+        seedTrack.setTruthProb(truthInfo.truthProb);
+      }
+
+      seed_tracks.push_back(seedTrack);
+      kept_hits.push_back(hits);
+    }
+
+    nmissing_ += strategy.nmissing;
+    nfailpmin_ += strategy.nfailpmin;
+    nfailpmax_ += strategy.nfailpmax;
+    nfaild0min_ += strategy.nfaild0min;
+    nfaild0max_ += strategy.nfaild0max;
+    nfailz0max_ += strategy.nfailz0max;
+    nfits_ += strategy.nfits;
+
+    xhit_.insert(xhit_.end(), strategy.xhit.begin(), strategy.xhit.end());
+    yhit_.insert(yhit_.end(), strategy.yhit.begin(), strategy.yhit.end());
+    zhit_.insert(zhit_.end(), strategy.zhit.begin(), strategy.zhit.end());
+    b0_.insert(b0_.end(), strategy.b0.begin(), strategy.b0.end());
+    b1_.insert(b1_.end(), strategy.b1.begin(), strategy.b1.end());
+    b2_.insert(b2_.end(), strategy.b2.begin(), strategy.b2.end());
+    b3_.insert(b3_.end(), strategy.b3.begin(), strategy.b3.end());
+    b4_.insert(b4_.end(), strategy.b4.begin(), strategy.b4.end());
+  }
 
-  */
-  groups_map.clear();
   //outputTree_->Fill();
   event.add(out_seed_collection_, seed_tracks);
   ntracks_ += seed_tracks.size();
@@ -116,8 +274,8 @@ void SeedFinderProcessor::produce(framework::Event& event) {
   processing_time_ += std::chrono::duration<double, std::milli>(diff).count();
 
   // Seed finding using 2D Hits
-  //  - The hits should keep track if they are already associated to a track or
-  //  not. This can be used for subsequent passes of seed-finding
+  //  - The hits used by the good tracks of the previous passes are skipped,
+  //  see used_hit_tracks
 
   // This should go into a digitization producer, which takes care of producing
   // measurements from:
@@ -142,17 +300,17 @@ void SeedFinderProcessor::produce(framework::Event& event) {
 // https://github.com/JeffersonLab/hps-java/blob/47712878302eb0c0374d077a208a6f8f0e2c3dc6/tracking/src/main/java/org/hps/recon/tracking/kalman/SeedTrack.java
 // Adapted to possible 3D hit points.
 
-// yOrigin is the location along the beam about which we fit the seed helix
-// perigee_location is where the track parameters will be extracted
+// The hits enter the fit through their contribution to the normal
+// equations, computed once per event with the positions along the beam
+// relative to the origin of the strategy.
 
-ldmx::Track SeedFinderProcessor::SeedTracker(
-    const std::vector<ldmx::Measurement>& vmeas, double xOrigin,
-    const Acts::Vector3& perigee_location) {
+SeedFinderProcessor::SeedFitSums SeedFinderProcessor::SeedFitContribution(
+    const geo::TrackersTrackingGeometry& tg, const ldmx::Measurement& meas,
+    double origin) const {
   // Fit a straight line in the non-bending plane and a parabola in the bending
   // plane
   // TODO:: use the actual errors from the measurement.
 
-  const int N = vmeas.size();
   double uError = 0.006;
   double vError = 40. / sqrt(12);
 
@@ -161,73 +319,58 @@ ldmx::Track SeedFinderProcessor::SeedTracker(
   // In this way it's easier to incorporate the tagger track extrapolation to
   // the fit
 
-  Acts::ActsMatrix<5, 5> A = Acts::ActsMatrix<5, 5>::Zero();
-  Acts::ActsVector<5> Y = Acts::ActsVector<5>::Zero();
-
-  for (auto meas : vmeas) {
-    double xmeas = meas.getGlobalPosition()[0] - xOrigin;
-
-    // Get the surface
-    const Acts::Surface* hit_surface = geometry().getSurface(meas.getLayerID());
-
-    // Get the global to local transformation
-    auto rot = hit_surface->transform(geometry_context()).rotation();
-    auto tr = hit_surface->transform(geometry_context()).translation();
-
-    auto rotl2g = rot.transpose();
-
-    // Only for saving purposes
-    Acts::Vector2 loc{meas.getLocalPosition()[0], 0.};
+  double xmeas = meas.getGlobalPosition()[0] - origin;
 
-    xhit_.push_back(xmeas);
-    yhit_.push_back(meas.getGlobalPosition()[1]);
-    zhit_.push_back(meas.getGlobalPosition()[2]);
+  // Get the sensor and its global to local transformation
+  const auto& sensor = *tg.getSensor(meas.getLayerID());
+  const auto& rotl2g = sensor.rotation;
+  const auto& tr = sensor.translation;
 
-    Acts::ActsMatrix<2, 5> A_i;
+  Acts::ActsMatrix<2, 5> A_i;
 
-    A_i(0, 0) = rotl2g(0, 1);
-    A_i(0, 1) = rotl2g(0, 1) * xmeas;
-    A_i(0, 2) = rotl2g(0, 1) * xmeas * xmeas;
-    A_i(0, 3) = rotl2g(0, 2);
-    A_i(0, 4) = rotl2g(0, 2) * xmeas;
+  A_i(0, 0) = rotl2g(0, 1);
+  A_i(0, 1) = rotl2g(0, 1) * xmeas;
+  A_i(0, 2) = rotl2g(0, 1) * xmeas * xmeas;
+  A_i(0, 3) = rotl2g(0, 2);
+  A_i(0, 4) = rotl2g(0, 2) * xmeas;
 
-    A_i(1, 0) = rotl2g(1, 1);
-    A_i(1, 1) = rotl2g(1, 1) * xmeas;
-    A_i(1, 2) = rotl2g(1, 1) * xmeas * xmeas;
-    A_i(1, 3) = rotl2g(1, 2);
-    A_i(1, 4) = rotl2g(1, 2) * xmeas;
+  A_i(1, 0) = rotl2g(1, 1);
+  A_i(1, 1) = rotl2g(1, 1) * xmeas;
+  A_i(1, 2) = rotl2g(1, 1) * xmeas * xmeas;
+  A_i(1, 3) = rotl2g(1, 2);
+  A_i(1, 4) = rotl2g(1, 2) * xmeas;
 
-    // Fill the yprime vector
-    Acts::Vector2 offset = (rot.transpose() * tr).topRows<2>();
-    Acts::Vector2 xoffset = {rotl2g(0, 0) * xmeas, rotl2g(1, 0) * xmeas};
+  // Fill the yprime vector
+  Acts::Vector2 offset = (rotl2g * tr).topRows<2>();
+  Acts::Vector2 xdir = {rotl2g(0, 0), rotl2g(1, 0)};
 
-    loc(0) = meas.getLocalPosition()[0];
-    loc(1) = 0.;
+  Acts::Vector2 loc{meas.getLocalPosition()[0], 0.};
 
-    Acts::ActsMatrix<2, 2> W_i =
-        Acts::ActsMatrix<2, 2>::Zero();  // weight matrix
+  Acts::ActsMatrix<2, 2> W_i =
+      Acts::ActsMatrix<2, 2>::Zero();  // weight matrix
 
-    W_i(0, 0) = 1. / (uError * uError);
-    W_i(1, 1) = 1. / (vError * vError);
+  W_i(0, 0) = 1. / (uError * uError);
+  W_i(1, 1) = 1. / (vError * vError);
 
-    Acts::Vector2 Yprime_i = loc + offset - xoffset;
+  Acts::Vector2 Yprime_i = loc + offset - xdir * xmeas;
 
-    Acts::Vector2 yi = W_i * Yprime_i;
-    Y += (A_i.transpose()) * W_i * Yprime_i;
+  Acts::ActsMatrix<5, 2> AtW_i = A_i.transpose() * W_i;
 
-    Acts::ActsMatrix<2, 5> WA_i = (W_i * A_i);
-    A += A_i.transpose() * WA_i;
-  }
-
-  Acts::ActsVector<5> B;
-  B = A.inverse() * Y;
+  // The position along the beam is relative to the center of the fit in
+  // the x offset of yprime: moving the center by d adds xdir * d.
+  SeedFitSums sums;
+  sums.normal = AtW_i * A_i;
+  sums.rhs = AtW_i * Yprime_i;
+  sums.shift = AtW_i * xdir;
+  return sums;
+}
 
-  b0_.push_back(B(0));
-  b1_.push_back(B(1));
-  b2_.push_back(B(2));
-  b3_.push_back(B(3));
-  b4_.push_back(B(4));
+// B are the parameters of the line and parabola centered at xOrigin
+// perigee_location is where the track parameters will be extracted
 
+ldmx::Track SeedFinderProcessor::SeedTracker(
+    const Acts::GeometryContext& gctx, const Acts::ActsVector<5>& B,
+    double xOrigin, const Acts::Vector3& perigee_location) {
   Acts::ActsVector<5> hlx = Acts::ActsVector<5>::Zero();
   Acts::ActsVector<3> ref{0., 0., 0.};
   LineParabolaToHelix(B, hlx, ref);
@@ -263,18 +406,15 @@ ldmx::Track SeedFinderProcessor::SeedTracker(
   // the mean might not fulfill the perigee condition.
   
   auto intersection =
-      (*seed_perigee).intersect(geometry_context(), seed_pos, dir, false);
+      (*seed_perigee).intersect(gctx, seed_pos, dir, false);
   
   Acts::FreeVector seed_free =
       tracking::sim::utils::toFreeParameters(intersection.intersection.position, seed_mom, q);
   
   auto bound_params = Acts::detail::transformFreeToBoundParameters(
-                          seed_free, *seed_perigee, geometry_context())
+                          seed_free, *seed_perigee, gctx)
                           .value();
 
-  ldmx_log(debug) << "bound parameters at perigee location" << std::endl
-                  << bound_params;
-
   Acts::BoundVector stddev;
   double sigma_p = 0.75 * p * Acts::UnitConstants::GeV;
   stddev[Acts::eBoundLoc0] = 2 * Acts::UnitConstants::mm;
@@ -364,6 +504,34 @@ void SeedFinderProcessor::onProcessEnd() {
             << "   nfaild0min=" << nfaild0min_ << std::endl;
   std::cout << "PROCESSOR:: " << this->getName()
             << "   nfailz0max=" << nfailz0max_ << std::endl;
+  std::cout << "PROCESSOR:: " << this->getName()
+            << "   nfits=" << nfits_ << std::endl;
+  std::cout << "PROCESSOR:: " << this->getName()
+            << "   nduplicates=" << nduplicates_ << std::endl;
+}
+
+void SeedFinderProcessor::SeedStrategy::clear() {
+  groups_map.clear();
+  seeds.clear();
+  seed_hits.clear();
+
+  xhit.clear();
+  yhit.clear();
+  zhit.clear();
+
+  b0.clear();
+  b1.clear();
+  b2.clear();
+  b3.clear();
+  b4.clear();
+
+  nmissing = 0;
+  nfailpmin = 0;
+  nfailpmax = 0;
+  nfaild0min = 0;
+  nfaild0max = 0;
+  nfailz0max = 0;
+  nfits = 0;
 }
 
 // Given a strategy, group the hits according to some options
@@ -371,148 +539,309 @@ void SeedFinderProcessor::onProcessEnd() {
 // *first* then only select the hits that we are interested into. TODO!
 
 bool SeedFinderProcessor::GroupStrips(
+    const geo::TrackersTrackingGeometry& tg,
     const std::vector<ldmx::Measurement>& measurements,
-    const std::vector<int> strategy) {
-    //    std::cout<<"Using stratedy"<<std::endl;
-    // for (auto& e : strategy) {
-    //  std::cout<<e<<" ";
-  //}
-  // std::cout<<std::endl;
-
-  for (auto& meas : measurements) {
+    const tracking::sim::HitMask* used_hits, SeedStrategy& strategy) {
+  const std::vector<int>& layers = strategy.layers;
+
+  for (std::size_t i = 0; i < measurements.size(); i++) {
+    const ldmx::Measurement& meas = measurements[i];
       
       ldmx_log(debug) << meas<<std::endl;
+
+    if (used_hits && used_hits->used(i)) continue;
+
+    // The seeding looks up the sensor of each hit
+    if (!tg.getSensor(meas.getLayerID())) {
+      ldmx_log(warn) << "No sensor for the measurement on layer "
+                     << meas.getLayerID();
+      continue;
+    }
       
-    if (std::find(strategy.begin(), strategy.end(), meas.getLayer()) !=
-        strategy.end()) {
-      groups_map[meas.getLayer()].push_back(&meas);
+    if (std::find(layers.begin(), layers.end(), meas.getLayer()) !=
+        layers.end()) {
+      strategy.groups_map[meas.getLayer()].push_back(&meas);
     }
 
   }  // loop meas
 
-  if (groups_map.size() < 5)
+  if (strategy.groups_map.size() < 5)
     return false;
   else
     return true;
 }
 
-// For each strategy, form all the possible combinatorics and form a seedTrack
-// for each of those This will reshuffle all points. (issue?) Will sort the
-// meas_for_seed vector
+// For each strategy, build the seeds layer by layer. The hits of each layer
+// are sorted by their bending coordinate, and only the hits in the window
+// allowed by the curvature (pmin) given two hits already on the seed are
+// tried. Every triplet of hits is also checked against the curvature and d0
+// cuts, so most of the combinations are rejected before the full fit.
 
 void SeedFinderProcessor::FindSeedsFromMap(
-    std::vector<ldmx::Track>& seeds) {
-  std::vector<ldmx::Measurement> meas_for_seeds;
-  meas_for_seeds.reserve(5);
-
-  std::map<int, std::vector<const ldmx::Measurement*>>::iterator groups_iter =
-      groups_map.begin();
-  std::vector<const ldmx::Measurement*>::iterator meas_iter;
+    const geo::TrackersTrackingGeometry& tg, const Acts::GeometryContext& gctx,
+    SeedStrategy& strategy) {
+  BuildSeedLayers(tg, strategy);
+  if (strategy.seed_layers.size() < 5) {
+    strategy.nmissing++;
+    return;
+  }
 
-  // Vector of iterators
+  std::array<const SeedHit*, 5> chosen{};
+  SeedFitSums sums;
+  sums.normal.setZero();
+  sums.rhs.setZero();
+  sums.shift.setZero();
+  ExtendSeed(gctx, strategy, 0, chosen, sums);
+}  // find seeds
 
-  constexpr size_t K = 5;
-  std::vector<std::vector<const ldmx::Measurement*>::iterator> it;
-  it.reserve(K);
+void SeedFinderProcessor::BuildSeedLayers(
+    const geo::TrackersTrackingGeometry& tg, SeedStrategy& strategy) {
+  std::vector<SeedLayer>& layers = strategy.seed_layers;
+  layers.clear();
+
+  // Center the fit contributions in the middle of the strategy, close to
+  // where the fits are centered
+  double xmin = std::numeric_limits<double>::infinity();
+  double xmax = -std::numeric_limits<double>::infinity();
+  for (const auto& [layer, group] : strategy.groups_map) {
+    for (const ldmx::Measurement* meas : group) {
+      xmin = std::min<double>(xmin, meas->getGlobalPosition()[0]);
+      xmax = std::max<double>(xmax, meas->getGlobalPosition()[0]);
+    }
+  }
+  strategy.seed_origin = 0.5 * (xmin + xmax);
+
+  for (const auto& [layer, group] : strategy.groups_map) {
+    SeedLayer seed_layer;
+    seed_layer.xmin = std::numeric_limits<double>::infinity();
+    seed_layer.xmax = -std::numeric_limits<double>::infinity();
+    seed_layer.dymax = 0.;
+    seed_layer.hits.reserve(group.size());
+
+    for (const ldmx::Measurement* meas : group) {
+      const auto& sensor = *tg.getSensor(meas->getLayerID());
+      // Local to global rotation
+      auto rot = sensor.rotation.transpose();
+
+      // Along the strip the bending coordinate moves by the v axis of the
+      // sensor times the half length of the strip.
+      SeedHit hit;
+      hit.x = meas->getGlobalPosition()[0];
+      hit.y = sensor.translation(1) + rot(1, 0) * meas->getLocalPosition()[0];
+      hit.dy = sensor.half_length_v * std::abs(rot(1, 1));
+      hit.meas = meas;
+      hit.fit = SeedFitContribution(tg, *meas, strategy.seed_origin);
+
+      seed_layer.xmin = std::min(seed_layer.xmin, hit.x);
+      seed_layer.xmax = std::max(seed_layer.xmax, hit.x);
+      seed_layer.dymax = std::max(seed_layer.dymax, hit.dy);
+      seed_layer.hits.push_back(hit);
+    }
 
-  unsigned int ikey = 0;
-  for (auto& key : groups_map) {
-    it[ikey] = key.second.begin();
-    ikey++;
+    std::sort(seed_layer.hits.begin(), seed_layer.hits.end(),
+              [](const SeedHit& h1, const SeedHit& h2) { return h1.y < h2.y; });
+    layers.push_back(std::move(seed_layer));
   }
 
-  // K vectors in an array v[0],v[1].... v[K-1]
-
-  while (it[0] != groups_iter->second.end()) {
-    // process the pointed-to elements
-    
-    /*
-      for (int j=0; j<K; j++) {
-      const ldmx::Measurement* meas = (*(it[j]));
-      std::cout<<meas->getGlobalPosition()[0]<<","
-      <<meas->getGlobalPosition()[1]<<","
-      <<meas->getGlobalPosition()[2]<<","<<std::endl;
-      }
-    */
+  std::sort(layers.begin(), layers.end(),
+            [](const SeedLayer& l1, const SeedLayer& l2) {
+              return l1.xmin + l1.xmax < l2.xmin + l2.xmax;
+            });
+}
 
-    std::vector<ldmx::Measurement> meas_for_seeds;
-    meas_for_seeds.reserve(5);
+void SeedFinderProcessor::ExtendSeed(const Acts::GeometryContext& gctx,
+                                     SeedStrategy& strategy, std::size_t k,
+                                     std::array<const SeedHit*, 5>& chosen,
+                                     const SeedFitSums& sums) {
+  if (k == chosen.size()) {
+    FitSeed(gctx, strategy, chosen, sums);
+    return;
+  }
 
-    ldmx_log(debug)<<" Grouping ";
-    
-    for (int j = 0; j < K; j++) {
-      const ldmx::Measurement* meas = (*(it[j]));
-      meas_for_seeds.push_back(*meas);
+  const SeedLayer& layer = strategy.seed_layers[k];
+
+  // Window of the bending coordinate on this layer: the seed goes through
+  // each pair of hits already chosen with a curvature below the pmin bound.
+  // Between two hits the parabola is the straight line through them, plus
+  // at most max_curvature * |(x - x_i) (x - x_j)|.
+  double ylo = -std::numeric_limits<double>::infinity();
+  double yhi = std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0; i < k; i++) {
+    for (std::size_t j = i + 1; j < k; j++) {
+      const SeedHit& hi = *chosen[i];
+      const SeedHit& hj = *chosen[j];
+      if (hi.x == hj.x || !std::isfinite(hi.dy) || !std::isfinite(hj.dy))
+        continue;
+      // The bound below is only valid outside of [x_i, x_j]
+      double xlo = std::min(hi.x, hj.x), xhi = std::max(hi.x, hj.x);
+      if (layer.xmax >= xlo && layer.xmin <= xhi) continue;
+
+      double wlo = std::numeric_limits<double>::infinity();
+      double whi = -std::numeric_limits<double>::infinity();
+      for (double x : {layer.xmin, layer.xmax}) {
+        double li = (x - hj.x) / (hi.x - hj.x);
+        double lj = (x - hi.x) / (hj.x - hi.x);
+        double center = li * hi.y + lj * hj.y;
+        double radius = max_curvature_ * std::abs((x - hi.x) * (x - hj.x)) +
+                        std::abs(li) * (hi.dy + window_tolerance_) +
+                        std::abs(lj) * (hj.dy + window_tolerance_) +
+                        layer.dymax + window_tolerance_;
+        wlo = std::min(wlo, center - radius);
+        whi = std::max(whi, center + radius);
+      }
+      ylo = std::max(ylo, wlo);
+      yhi = std::min(yhi, whi);
     }
-
-    std::sort(meas_for_seeds.begin(), meas_for_seeds.end(),
-              [](const ldmx::Measurement& m1, const ldmx::Measurement& m2) {
-                  return m1.getGlobalPosition()[0] < m2.getGlobalPosition()[0];
-              });
-    
-    if (meas_for_seeds.size() < 5) {
-      nmissing_++;
-      return;
+  }
+  if (!(ylo <= yhi)) return;
+
+  auto first = std::lower_bound(
+      layer.hits.begin(), layer.hits.end(), ylo,
+      [](const SeedHit& hit, double y) { return hit.y < y; });
+  for (auto hit = first; hit != layer.hits.end() && hit->y <= yhi; ++hit) {
+    bool compatible = true;
+    for (std::size_t i = 0; i < k && compatible; i++) {
+      for (std::size_t j = i + 1; j < k && compatible; j++) {
+        compatible = Compatible(*chosen[i], *chosen[j], *hit);
+      }
     }
+    if (!compatible) continue;
 
-    ldmx_log(debug)<<"seedTrack";
-    
-    ldmx::Track seedTrack =
-        SeedTracker(meas_for_seeds, meas_for_seeds.at(2).getGlobalPosition()[0],
-                    Acts::Vector3(perigee_location_[0], perigee_location_[1],
-                                  perigee_location_[2]));
-    
-    bool fail = false;
-    // Remove failed fits
-
-    if (1. / abs(seedTrack.getQoP()) < pmin_) {
-      nfailpmin_++;
-      fail = true;
-    } else if (1. / abs(seedTrack.getQoP()) > pmax_) {
-      nfailpmax_++;
-      fail = true;
-    } else if (abs(seedTrack.getZ0()) > z0max_) {
-      nfailz0max_++;
-      fail = true;
-    } else if (seedTrack.getD0() < d0min_) {
-      nfaild0min_++;
-      fail = true;
-    } else if (seedTrack.getD0() > d0max_) {
-      nfaild0max_++;
-      fail = true;
-    }
+    chosen[k] = &(*hit);
+    SeedFitSums next = sums;
+    next += hit->fit;
+    ExtendSeed(gctx, strategy, k + 1, chosen, next);
+  }
+}
 
-    if (!fail) {
-      
-      if (truthMatchingTool_->configured()) {
-        auto truthInfo = truthMatchingTool_->TruthMatch(meas_for_seeds);
-        seedTrack.setTrackID(truthInfo.trackID);
-        seedTrack.setPdgID(truthInfo.pdgID);
-        seedTrack.setTruthProb(truthInfo.truthProb);
-      }
+bool SeedFinderProcessor::Compatible(const SeedHit& h0, const SeedHit& h1,
+                                     const SeedHit& h2) const {
+  const std::array<const SeedHit*, 3> hits{&h0, &h1, &h2};
+  for (const SeedHit* hit : hits) {
+    if (!std::isfinite(hit->dy)) return true;
+  }
+  const double x_perigee = perigee_location_[0];
+
+  // The parabola through the three hits is y(x) = sum_i y_i l_i(x), with the
+  // Lagrange polynomials l_i. Its curvature, value and slope at the perigee
+  // are linear in the y_i: their range follows from the range of each hit.
+  double curv = 0., curv_err = 0.;
+  double y_per = 0., y_per_err = 0.;
+  double slope = 0., slope_err = 0.;
+  for (int i = 0; i < 3; i++) {
+    const SeedHit& hi = *hits[i];
+    const SeedHit& hj = *hits[(i + 1) % 3];
+    const SeedHit& hk = *hits[(i + 2) % 3];
+    double denom = (hi.x - hj.x) * (hi.x - hk.x);
+    // Hits at the same position along the beam don't constrain the helix
+    if (denom == 0.) return true;
+    double err = hi.dy + window_tolerance_;
+
+    curv += hi.y / denom;
+    curv_err += err / std::abs(denom);
+
+    double l = (x_perigee - hj.x) * (x_perigee - hk.x) / denom;
+    y_per += hi.y * l;
+    y_per_err += err * std::abs(l);
+
+    double dl = ((x_perigee - hj.x) + (x_perigee - hk.x)) / denom;
+    slope += hi.y * dl;
+    slope_err += err * std::abs(dl);
+  }
 
-      seeds.push_back(seedTrack);
-    }
-    
-    else {
-      b0_.pop_back();
-      b1_.pop_back();
-      b2_.pop_back();
-      b3_.pop_back();
-      b4_.pop_back();
-    }
+  // pmin and pmax
+  double curv_lo = std::abs(curv) - curv_err;
+  if (curv_lo > max_curvature_) return false;
+  if (std::abs(curv) + curv_err < min_curvature_) return false;
+
+  // d0 is the distance to the perigee in the bending plane, the offset of
+  // the parabola at the perigee times the cosine of the track angle.
+  double dy_lo = y_per - y_per_err - perigee_location_[1];
+  double dy_hi = y_per + y_per_err - perigee_location_[1];
+  double s_lo = slope - slope_err, s_hi = slope + slope_err;
+  double s2_max = std::max(s_lo * s_lo, s_hi * s_hi);
+  double s2_min = (s_lo <= 0. && s_hi >= 0.)
+                      ? 0.
+                      : std::min(s_lo * s_lo, s_hi * s_hi);
+  double cos_lo = 1. / std::sqrt(1. + s2_max);
+  double cos_hi = 1. / std::sqrt(1. + s2_min);
+  double d0_lo = std::min(dy_lo * cos_lo, dy_lo * cos_hi);
+  double d0_hi = std::max(dy_hi * cos_lo, dy_hi * cos_hi);
+
+  return d0_hi >= d0min_ - window_tolerance_ &&
+         d0_lo <= d0max_ + window_tolerance_;
+}
 
-    // Go to next combination
-    ldmx_log(debug)<<"Go to the next combination";
-    
-    ++it[K - 1];
-    for (int i = K - 1;
-         (i > 0) && (it[i] == (std::next(groups_iter, i))->second.end()); --i) {
-      it[i] = std::next(groups_iter, i)->second.begin();
-      ++it[i - 1];
-    }
+void SeedFinderProcessor::FitSeed(const Acts::GeometryContext& gctx,
+                                  SeedStrategy& strategy,
+                                  const std::array<const SeedHit*, 5>& chosen,
+                                  const SeedFitSums& sums) {
+  std::array<const ldmx::Measurement*, 5> meas_for_seeds;
+  for (std::size_t i = 0; i < chosen.size(); i++)
+    meas_for_seeds[i] = chosen[i]->meas;
+
+  std::sort(meas_for_seeds.begin(), meas_for_seeds.end(),
+            [](const ldmx::Measurement* m1, const ldmx::Measurement* m2) {
+              return m1->getGlobalPosition()[0] < m2->getGlobalPosition()[0];
+            });
+
+  // The seed is centered at the middle hit along the beam
+  double xOrigin = meas_for_seeds.at(2)->getGlobalPosition()[0];
+  double d = xOrigin - strategy.seed_origin;
+
+  for (const ldmx::Measurement* meas : meas_for_seeds) {
+    strategy.xhit.push_back(meas->getGlobalPosition()[0] - xOrigin);
+    strategy.yhit.push_back(meas->getGlobalPosition()[1]);
+    strategy.zhit.push_back(meas->getGlobalPosition()[2]);
   }
-}  // find seeds
+
+  // Solve the normal equations, centered at the origin of the strategy, and
+  // move the parameters to the center of the seed.
+  strategy.nfits++;
+  Acts::ActsVector<5> C =
+      sums.normal.ldlt().solve(sums.rhs + d * sums.shift);
+
+  Acts::ActsVector<5> B;
+  B(0) = C(0) + C(1) * d + C(2) * d * d;
+  B(1) = C(1) + 2. * C(2) * d;
+  B(2) = C(2);
+  B(3) = C(3) + C(4) * d;
+  B(4) = C(4);
+
+  ldmx::Track seedTrack =
+      SeedTracker(gctx, B, xOrigin,
+                  Acts::Vector3(perigee_location_[0], perigee_location_[1],
+                                perigee_location_[2]));
+
+  // Remove failed fits
+
+  if (1. / abs(seedTrack.getQoP()) < pmin_) {
+    strategy.nfailpmin++;
+    return;
+  } else if (1. / abs(seedTrack.getQoP()) > pmax_) {
+    strategy.nfailpmax++;
+    return;
+  } else if (abs(seedTrack.getZ0()) > z0max_) {
+    strategy.nfailz0max++;
+    return;
+  } else if (seedTrack.getD0() < d0min_) {
+    strategy.nfaild0min++;
+    return;
+  } else if (seedTrack.getD0() > d0max_) {
+    strategy.nfaild0max++;
+    return;
+  }
+
+  strategy.b0.push_back(B(0));
+  strategy.b1.push_back(B(1));
+  strategy.b2.push_back(B(2));
+  strategy.b3.push_back(B(3));
+  strategy.b4.push_back(B(4));
+
+  // The truth matching is done when the seeds of the strategies are merged
+  strategy.seeds.push_back(seedTrack);
+  strategy.seed_hits.push_back(meas_for_seeds);
+}  // fit seed
 
 }  // namespace reco
 }  // namespace tracking
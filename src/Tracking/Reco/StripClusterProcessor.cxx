@@ -0,0 +1,208 @@
+#include "Tracking/Reco/StripClusterProcessor.h"
+
+#include "Acts/Definitions/Units.hpp"
+
+//--- C++ ---//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace tracking::reco {
+
+StripClusterProcessor::StripClusterProcessor(const std::string& name,
+                                             framework::Process& process)
+    : TrackingGeometryUser(name, process) {}
+
+void StripClusterProcessor::onProcessStart() {
+  fitter_ = std::make_unique<StripPulseFitter>(fit_cfg_);
+}
+
+void StripClusterProcessor::configure(
+    framework::config::Parameters& parameters) {
+  raw_hit_collection_ = parameters.getParameter<std::string>(
+      "raw_hit_collection", "RawSiStripHits");
+  packed_raw_hits_ = parameters.getParameter<bool>("packed_raw_hits", false);
+  out_collection_ = parameters.getParameter<std::string>("out_collection",
+                                                         "StripMeasurements");
+  n_strips_ = parameters.getParameter<int>("n_strips", 640);
+  lorentz_tan_ = parameters.getParameter<double>("lorentz_tan", 0.01);
+  noise_adc_ = parameters.getParameter<double>("strip_noise", 1000.) /
+               parameters.getParameter<double>("electrons_per_adc", 15.);
+  pedestal_ = parameters.getParameter<double>("pedestal", 4000.);
+  seed_threshold_ = parameters.getParameter<double>("seed_threshold", 4.);
+  neighbour_threshold_ =
+      parameters.getParameter<double>("neighbour_threshold", 2.);
+  max_chi2_ndf_ = parameters.getParameter<double>("max_chi2_ndf", 10.);
+
+  fit_cfg_.shaping_time = parameters.getParameter<double>("shaping_time", 50.);
+  fit_cfg_.first_sample_time =
+      parameters.getParameter<double>("first_sample_time", 0.);
+  fit_cfg_.t0_min = parameters.getParameter<double>("t0_min", -50.);
+  fit_cfg_.t0_max = parameters.getParameter<double>("t0_max", 100.);
+  fit_cfg_.t0_step = parameters.getParameter<double>("t0_step", 1.);
+}
+
+void StripClusterProcessor::produce(framework::Event& event) {
+  // The hits are read in place when they are packed, otherwise packed first
+  if (!packed_raw_hits_) {
+    columns_ = ldmx::RawSiStripHitColumns(
+        event.getCollection<ldmx::RawSiStripHit>(raw_hit_collection_));
+  }
+  const ldmx::RawSiStripHitColumns& raw_hits =
+      packed_raw_hits_
+          ? event.getObject<ldmx::RawSiStripHitColumns>(raw_hit_collection_)
+          : columns_;
+  const std::size_t n = raw_hits.size();
+  const int n_samples = fit_cfg_.n_samples;
+
+  // Transpose the samples so that the fit runs over the strips. Missing
+  // samples are left at the pedestal.
+  samples_.assign(n_samples * n, 0.f);
+  for (std::size_t s = 0; s < n; s++) {
+    const short* samples = raw_hits.getSamples(s);
+    int n_hit_samples = std::min<int>(raw_hits.getNSamples(s), n_samples);
+    for (int i = 0; i < n_hit_samples; i++)
+      samples_[i * n + s] = samples[i] - pedestal_;
+  }
+
+  amplitude_.resize(n);
+  t0_.resize(n);
+  chi2_.resize(n);
+  amplitude_noise_.resize(n);
+  auto start = std::chrono::high_resolution_clock::now();
+  fitter_->fit(samples_.data(), n, amplitude_.data(), t0_.data(),
+               chi2_.data(), amplitude_noise_.data());
+  auto end = std::chrono::high_resolution_clock::now();
+  fit_time_ +=
+      std::chrono::duration<double, std::milli>(end - start).count();
+  n_strips_fitted_ += n;
+  n_events_++;
+
+  order_.resize(n);
+  std::iota(order_.begin(), order_.end(), 0);
+  std::sort(order_.begin(), order_.end(),
+            [&raw_hits](std::size_t a, std::size_t b) {
+              return std::make_pair(raw_hits.getSensorID(a),
+                                    raw_hits.getStrip(a)) <
+                     std::make_pair(raw_hits.getSensorID(b),
+                                    raw_hits.getStrip(b));
+            });
+
+  // Strips whose pulse doesn't have the expected shape are not clustered.
+  // The chi2 of the fit has n_samples - 2 degrees of freedom, in units of
+  // the noise of a sample squared.
+  const int ndf = n_samples - 2;
+  const float max_chi2 =
+      ndf > 0 ? max_chi2_ndf_ * ndf * noise_adc_ * noise_adc_
+              : std::numeric_limits<float>::infinity();
+  for (std::size_t s = 0; s < n; s++)
+    n_strips_bad_chi2_ += chi2_[s] > max_chi2 && amplitude_[s] > 0.f;
+
+  // Runs of adjacent strips above the neighbour threshold, kept if one of
+  // them is above the seed threshold. The thresholds are in units of the
+  // noise of the amplitude of each strip.
+  auto above = [&](std::size_t hit, double threshold) {
+    return chi2_[hit] <= max_chi2 &&
+           amplitude_[hit] > threshold * noise_adc_ * amplitude_noise_[hit];
+  };
+  std::vector<ldmx::Measurement> measurements;
+  std::size_t begin{0};
+  bool seeded{false};
+  for (std::size_t k = 0; k <= n; k++) {
+    bool in_run = false;
+    if (k < n && above(order_[k], neighbour_threshold_) && k > begin) {
+      std::size_t prev = order_[k - 1], hit = order_[k];
+      in_run = raw_hits.getSensorID(hit) == raw_hits.getSensorID(prev) &&
+               raw_hits.getStrip(hit) == raw_hits.getStrip(prev) + 1;
+    }
+    if (in_run) {
+      seeded |= above(order_[k], seed_threshold_);
+      continue;
+    }
+
+    if (seeded) makeMeasurement(raw_hits, begin, k, measurements);
+
+    // Start the next run, at the first strip above the neighbour threshold
+    while (k < n && !above(order_[k], neighbour_threshold_)) k++;
+    begin = k;
+    seeded = k < n && above(order_[k], seed_threshold_);
+  }
+  n_clusters_ += measurements.size();
+
+  ldmx_log(debug) << "RawSiStripHits Size=" << n
+                  << " Measurements Size=" << measurements.size();
+
+  event.add(out_collection_, measurements);
+}
+
+void StripClusterProcessor::makeMeasurement(
+    const ldmx::RawSiStripHitColumns& raw_hits, std::size_t begin,
+    std::size_t end, std::vector<ldmx::Measurement>& measurements) {
+  int sensor_id = raw_hits.getSensorID(order_[begin]);
+  const auto* sensor{geometry().getSensor(sensor_id)};
+  if (!sensor) {
+    ldmx_log(warn) << "No sensor with id " << sensor_id;
+    return;
+  }
+
+  // Strip j covers [-half_length_u + j * pitch, -half_length_u + (j + 1) *
+  // pitch)
+  double pitch = 2. * sensor->half_length_u / n_strips_;
+  double sum_a{0.}, sum_au{0.}, sum_at{0.};
+  for (std::size_t k = begin; k < end; k++) {
+    double a = amplitude_[order_[k]];
+    double u = -sensor->half_length_u +
+               (raw_hits.getStrip(order_[k]) + 0.5) * pitch;
+    sum_a += a;
+    sum_au += a * u;
+    sum_at += a * t0_[order_[k]];
+  }
+  double u = sum_au / sum_a;
+
+  // A single strip has a uniform resolution, otherwise the noise of the
+  // amplitudes is propagated to the centroid
+  double var_u = pitch * pitch / 12.;
+  if (end - begin > 1) {
+    var_u = 0.;
+    for (std::size_t k = begin; k < end; k++) {
+      double du = -sensor->half_length_u +
+                  (raw_hits.getStrip(order_[k]) + 0.5) * pitch - u;
+      double sigma_a = noise_adc_ * amplitude_noise_[order_[k]];
+      var_u += du * du * sigma_a * sigma_a;
+    }
+    var_u /= sum_a * sum_a;
+  }
+
+  // The charge drifts on average half of the thickness to the readout side
+  double thickness = sensor->thickness > 0. ? sensor->thickness
+                                            : 0.320 * Acts::UnitConstants::mm;
+  u -= 0.5 * thickness * lorentz_tan_;
+
+  double length_v = 2. * sensor->half_length_v;
+  Acts::Vector3 global_pos{sensor->transform * Acts::Vector3(u, 0., 0.)};
+
+  ldmx::Measurement& measurement = measurements.emplace_back();
+  measurement.setLayerID(sensor_id);
+  measurement.setLocalPosition(u, 0.);
+  measurement.setLocalCovariance(var_u, length_v * length_v / 12.);
+  measurement.setGlobalPosition(global_pos(0), global_pos(1), global_pos(2));
+  measurement.setTime(sum_at / sum_a);
+}
+
+void StripClusterProcessor::onProcessEnd() {
+  double n = n_events_ > 0 ? n_events_ : 1.;
+  std::cout << "PROCESSOR:: " << getName() << std::endl
+            << "events: " << n_events_ << std::endl
+            << "strips/event = " << n_strips_fitted_ / n
+            << "  above max chi2/event = " << n_strips_bad_chi2_ / n
+            << "  clusters/event = " << n_clusters_ / n << std::endl
+            << "pulse fit time/event = " << fit_time_ / n << " ms"
+            << std::endl;
+}
+
+}  // namespace tracking::reco
+
+DECLARE_PRODUCER_NS(tracking::reco, StripClusterProcessor)
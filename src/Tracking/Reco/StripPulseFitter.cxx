@@ -0,0 +1,132 @@
+#include "Tracking/Reco/StripPulseFitter.h"
+
+//--- C++ ---//
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+//--- Tracking ---//
+#include "Tracking/Sim/FastMath.h"
+
+namespace tracking::reco {
+
+StripPulseFitter::StripPulseFitter(const Config& cfg) : cfg_(cfg) {
+  if (cfg_.n_samples < 1 || !(cfg_.shaping_time > 0.) ||
+      !(cfg_.t0_step > 0.) || !(cfg_.t0_max >= cfg_.t0_min))
+    throw std::runtime_error("StripPulseFitter: invalid configuration");
+
+  int n_grid =
+      static_cast<int>(std::floor((cfg_.t0_max - cfg_.t0_min) / cfg_.t0_step)) +
+      1;
+  grid_.resize(n_grid);
+  shapes_.resize(n_grid * cfg_.n_samples);
+  shape_norms_.resize(n_grid);
+  for (int g = 0; g < n_grid; g++) {
+    grid_[g] = cfg_.t0_min + g * cfg_.t0_step;
+    float norm{0.};
+    for (int i = 0; i < cfg_.n_samples; i++) {
+      float f = pulse(i, grid_[g]);
+      shapes_[g * cfg_.n_samples + i] = f;
+      norm += f * f;
+    }
+    shape_norms_[g] = norm;
+  }
+}
+
+float StripPulseFitter::pulse(int i, float t0) const {
+  float t = std::max(0.f, float((cfg_.first_sample_time +
+                                 i * cfg_.sample_spacing - t0) /
+                                cfg_.shaping_time));
+  return t * std::exp(1.f - t);
+}
+
+void StripPulseFitter::fit(const float* samples, std::size_t n,
+                           float* amplitude, float* t0, float* chi2,
+                           float* amplitude_noise) {
+  if (n == 0) return;
+  const int n_samples = cfg_.n_samples;
+  const int n_grid = grid_.size();
+
+  syy_.assign(n, 0.f);
+  float* syy = syy_.data();
+  for (int i = 0; i < n_samples; i++) {
+    const float* y = samples + i * n;
+    for (std::size_t s = 0; s < n; s++) syy[s] += y[s] * y[s];
+  }
+
+  // Syf^2 / Sff of every strip at every grid point, the chi2 is Syy minus
+  // this score. Pulses of negative amplitude get a score of 0.
+  scores_.assign(n_grid * n, 0.f);
+  for (int g = 0; g < n_grid; g++) {
+    float* score = scores_.data() + g * n;
+    for (int i = 0; i < n_samples; i++) {
+      const float f = shapes_[g * n_samples + i];
+      if (f == 0.f) continue;
+      const float* y = samples + i * n;
+      for (std::size_t s = 0; s < n; s++) score[s] += f * y[s];
+    }
+    const float inv_norm = shape_norms_[g] > 0.f ? 1.f / shape_norms_[g] : 0.f;
+    for (std::size_t s = 0; s < n; s++) {
+      float syf = std::max(score[s], 0.f);
+      score[s] = syf * syf * inv_norm;
+    }
+  }
+
+  // Best grid point of each strip
+  best_score_.assign(scores_.begin(), scores_.begin() + n);
+  best_index_.assign(n, 0);
+  float* best_score = best_score_.data();
+  int* best_index = best_index_.data();
+  for (int g = 1; g < n_grid; g++) {
+    const float* score = scores_.data() + g * n;
+    for (std::size_t s = 0; s < n; s++) {
+      bool better = score[s] > best_score[s];
+      best_score[s] = better ? score[s] : best_score[s];
+      best_index[s] = better ? g : best_index[s];
+    }
+  }
+
+  // Parabola through the best grid point and its neighbours
+  for (std::size_t s = 0; s < n; s++) {
+    int g = best_index[s];
+    float offset{0.};
+    if (g > 0 && g < n_grid - 1) {
+      float prev = scores_[(g - 1) * n + s];
+      float next = scores_[(g + 1) * n + s];
+      float curvature = prev - 2.f * best_score[s] + next;
+      if (curvature < 0.f)
+        offset = std::clamp(0.5f * (prev - next) / curvature, -0.5f, 0.5f);
+    }
+    t0[s] = grid_[g] + offset * cfg_.t0_step;
+  }
+
+  // Amplitude and chi2 at the refined start time
+  syf_.assign(n, 0.f);
+  sff_.assign(n, 0.f);
+  float* syf = syf_.data();
+  float* sff = sff_.data();
+  for (int i = 0; i < n_samples; i++) {
+    const float* y = samples + i * n;
+    const float sample_time = cfg_.first_sample_time + i * cfg_.sample_spacing;
+    const float inv_tau = 1. / cfg_.shaping_time;
+    for (std::size_t s = 0; s < n; s++) {
+      float t = std::max(0.f, (sample_time - t0[s]) * inv_tau);
+      float f = t * tracking::sim::fastmath::exp(1.f - t);
+      syf[s] += f * y[s];
+      sff[s] += f * f;
+    }
+  }
+  // Separate loops for the outputs, which may alias, so that the compiler
+  // doesn't need too many run time checks to vectorize them
+  for (std::size_t s = 0; s < n; s++) {
+    float a = syf[s] > 0.f && sff[s] > 0.f ? syf[s] / sff[s] : 0.f;
+    amplitude[s] = a;
+    chi2[s] = std::max(0.f, syy[s] - a * syf[s]);
+  }
+  for (std::size_t s = 0; s < n; s++)
+    amplitude_noise[s] = sff[s] > 0.f ? 1.f / std::sqrt(sff[s])
+                                      : std::numeric_limits<float>::infinity();
+}
+
+}  // namespace tracking::reco
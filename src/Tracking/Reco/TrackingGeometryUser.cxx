@@ -17,5 +17,11 @@ const Acts::CalibrationContext& TrackingGeometryUser::calibration_context() {
 const geo::TrackersTrackingGeometry& TrackingGeometryUser::geometry() {
   return getNamedCondition<geo::TrackersTrackingGeometry>();
 }
+const geo::MagneticFieldMap& TrackingGeometryUser::magnetic_field_map() {
+  return getNamedCondition<geo::MagneticFieldMap>();
+}
+std::shared_ptr<const Acts::MagneticFieldProvider> TrackingGeometryUser::magnetic_field() {
+  return magnetic_field_map().get();
+}
 
 }
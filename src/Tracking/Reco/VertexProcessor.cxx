@@ -11,7 +11,7 @@ namespace reco {
 
 VertexProcessor::VertexProcessor(const std::string &name,
                                  framework::Process &process)
-    : framework::Producer(name, process) {}
+    : TrackingGeometryUser(name, process) {}
 
 VertexProcessor::~VertexProcessor() {}
 
@@ -23,30 +23,15 @@ void VertexProcessor::onProcessStart() {
   h_m_truthFilter_ = new TH1F("m_filter", "m", 100, 0., 1.);
   h_m_truth_ = new TH1F("m_truth", "m_truth", 100, 0., 1.);
 
-  auto localToGlobalBin_xyz = [](std::array<size_t, 3> bins,
-                                 std::array<size_t, 3> sizes) {
-    return (bins[0] * (sizes[1] * sizes[2]) + bins[1] * sizes[2] +
-            bins[2]);  // xyz - field space
-    // return (bins[1] * (sizes[2] * sizes[0]) + bins[2] * sizes[0] + bins[0]);
-    // //zxy
-  };
-
-  // Setup a interpolated bfield map
-  sp_interpolated_bField_ = std::make_shared<InterpolatedMagneticField3>(
-      loadDefaultBField(field_map_,
-                        default_transformPos,
-                        default_transformBField));
-  
-  
-  std::cout << "Check if nullptr::" << sp_interpolated_bField_.get()
-            << std::endl;
+}
+
+void VertexProcessor::onNewRun(const ldmx::RunHeader &rh) {
+  // The interpolated bfield map is shared through the conditions
+  sp_interpolated_bField_ = magnetic_field();
 }
 
 void VertexProcessor::configure(framework::config::Parameters &parameters) {
   
-  // TODO:: the bfield map should be taken automatically
-  field_map_ = parameters.getParameter<std::string>("field_map");
-
   trk_coll_name_ =
       parameters.getParameter<std::string>("trk_coll_name", "Tracks");
 }
@@ -15,7 +15,7 @@ namespace tracking {
 namespace reco {
 
 Vertexer::Vertexer(const std::string& name, framework::Process& process)
-    : framework::Producer(name, process) {}
+    : TrackingGeometryUser(name, process) {}
 
 Vertexer::~Vertexer() {}
 
@@ -48,20 +48,12 @@ void Vertexer::onProcessStart() {
 
   gctx_ = Acts::GeometryContext();
   bctx_ = Acts::MagneticFieldContext();
+}
+
+void Vertexer::onNewRun(const ldmx::RunHeader& rh) {
+  // The interpolated bfield map is shared through the conditions
+  sp_interpolated_bField_ = magnetic_field();
 
-  auto localToGlobalBin_xyz = [](std::array<size_t, 3> bins,
-                                 std::array<size_t, 3> sizes) {
-    return (bins[0] * (sizes[1] * sizes[2]) + bins[1] * sizes[2] +
-            bins[2]);  // xyz - field space
-    // return (bins[1] * (sizes[2] * sizes[0]) + bins[2] * sizes[0] + bins[0]);
-    // //zxy
-  };
-
-  sp_interpolated_bField_ = std::make_shared<InterpolatedMagneticField3>(
-      loadDefaultBField(field_map_,
-                        default_transformPos,
-                        default_transformBField));
-  
   // There is a sign issue between the vertexing and the perigee representation
   Acts::Vector3 b_field(0., 0., -1.5 * Acts::UnitConstants::T);
   bField_ = std::make_shared<Acts::ConstantBField>(b_field);
@@ -81,9 +73,6 @@ void Vertexer::onProcessStart() {
 
 void Vertexer::configure(framework::config::Parameters& parameters) {
   
-  // TODO:: the bfield map should be taken automatically
-  field_map_ = parameters.getParameter<std::string>("field_map");
-
   trk_c_name_1 =
       parameters.getParameter<std::string>("trk_c_name_1", "TaggerTracks");
   trk_c_name_2 =
@@ -0,0 +1,172 @@
+#include "Tracking/Sim/BFieldMapIO.h"
+
+//--- C++ ---//
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+//--- POSIX ---//
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tracking {
+namespace sim {
+
+namespace {
+
+/// Alignment of the field planes in the file
+constexpr std::uint64_t kDataAlignment = 64;
+
+template <typename T>
+void writePlane(std::ofstream& out, const std::vector<double>& values) {
+  std::vector<T> buffer(values.begin(), values.end());
+  out.write(reinterpret_cast<const char*>(buffer.data()),
+            buffer.size() * sizeof(T));
+}
+
+}  // namespace
+
+bool isBinaryFieldMap(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  char magic[sizeof(BFIELD_MAP_MAGIC)];
+  in.read(magic, sizeof(magic));
+  return in.gcount() == sizeof(magic) &&
+         std::memcmp(magic, BFIELD_MAP_MAGIC, sizeof(magic)) == 0;
+}
+
+std::string binaryFieldMapCachePath(const std::string& text_path) {
+  return text_path + ".bin";
+}
+
+void writeBinaryFieldMap(const std::string& path,
+                         const std::array<std::size_t, 3>& nbins,
+                         const std::array<double, 3>& min,
+                         const std::array<double, 3>& max,
+                         const std::vector<double>& bx,
+                         const std::vector<double>& by,
+                         const std::vector<double>& bz,
+                         bool single_precision) {
+  std::size_t npoints = nbins[0] * nbins[1] * nbins[2];
+  if (bx.size() != npoints || by.size() != npoints || bz.size() != npoints)
+    throw std::runtime_error(
+        "writeBinaryFieldMap: field planes don't match the grid size");
+
+  BFieldMapHeader header{};
+  std::memcpy(header.magic, BFIELD_MAP_MAGIC, sizeof(header.magic));
+  header.version = BFIELD_MAP_VERSION;
+  header.precision = single_precision ? sizeof(float) : sizeof(double);
+  for (int i = 0; i < 3; i++) {
+    header.nbins[i] = nbins[i];
+    header.min[i] = min[i];
+    header.max[i] = max[i];
+  }
+  header.data_offset =
+      (sizeof(BFieldMapHeader) + kDataAlignment - 1) / kDataAlignment *
+      kDataAlignment;
+
+  // Write to a temporary file and move it in place once complete
+  std::string tmp_path = path + ".tmp." + std::to_string(::getpid());
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("writeBinaryFieldMap: can't open " + tmp_path);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<char> padding(header.data_offset - sizeof(header), 0);
+    out.write(padding.data(), padding.size());
+
+    for (const auto* plane : {&bx, &by, &bz}) {
+      if (single_precision)
+        writePlane<float>(out, *plane);
+      else
+        writePlane<double>(out, *plane);
+    }
+
+    if (!out) {
+      std::remove(tmp_path.c_str());
+      throw std::runtime_error("writeBinaryFieldMap: failed writing " +
+                               tmp_path);
+    }
+  }
+
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("writeBinaryFieldMap: can't rename " + tmp_path +
+                             " to " + path);
+  }
+}
+
+BFieldMapFile::BFieldMapFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("BFieldMapFile: can't open " + path);
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(BFieldMapHeader)) {
+    ::close(fd);
+    throw std::runtime_error("BFieldMapFile: " + path +
+                             " is too small to be a binary field map");
+  }
+
+  length_ = st.st_size;
+  void* addr = ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("BFieldMapFile: can't map " + path);
+
+  data_ = static_cast<const char*>(addr);
+  header_ = reinterpret_cast<const BFieldMapHeader*>(data_);
+
+  std::string error;
+  if (std::memcmp(header_->magic, BFIELD_MAP_MAGIC, sizeof(header_->magic)))
+    error = " is not a binary field map";
+  else if (header_->version != BFIELD_MAP_VERSION)
+    error = " has unsupported version " + std::to_string(header_->version);
+  else if (header_->precision != sizeof(float) &&
+           header_->precision != sizeof(double))
+    error = " has unsupported precision " +
+            std::to_string(header_->precision);
+  else if (header_->data_offset + 3 * size() * header_->precision > length_)
+    error = " is truncated";
+
+  if (!error.empty()) {
+    ::munmap(const_cast<char*>(data_), length_);
+    throw std::runtime_error("BFieldMapFile: " + path + error);
+  }
+
+  // The grid is read sequentially when filling the field map
+  ::madvise(const_cast<char*>(data_), length_, MADV_SEQUENTIAL);
+}
+
+BFieldMapFile::~BFieldMapFile() {
+  if (data_) ::munmap(const_cast<char*>(data_), length_);
+}
+
+BFieldMapFile::BFieldMapFile(BFieldMapFile&& other) noexcept
+    : data_(other.data_), length_(other.length_), header_(other.header_) {
+  other.data_ = nullptr;
+  other.length_ = 0;
+  other.header_ = nullptr;
+}
+
+BFieldMapFile& BFieldMapFile::operator=(BFieldMapFile&& other) noexcept {
+  if (this != &other) {
+    if (data_) ::munmap(const_cast<char*>(data_), length_);
+    data_ = other.data_;
+    length_ = other.length_;
+    header_ = other.header_;
+    other.data_ = nullptr;
+    other.length_ = 0;
+    other.header_ = nullptr;
+  }
+  return *this;
+}
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,322 @@
+#include "Tracking/Sim/BFieldRegionModel.h"
+
+//--- C++ ---//
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+namespace tracking {
+namespace sim {
+
+namespace {
+
+/// Keyword starting the model files
+const std::string kModelMagic = "LDMX-BFIELD-REGIONS";
+
+/**
+ * Read-only access to the grid points of a field grid, including the layer
+ * of zeros after the last point of each axis towards which the map is
+ * interpolated.
+ */
+class GridPoints {
+ public:
+  explicit GridPoints(const MagneticFieldGrid3& grid) : grid_(grid) {
+    auto min = grid.minPosition();
+    auto max = grid.maxPosition();
+    auto nbins = grid.numLocalBins();
+    for (int i = 0; i < 3; i++) {
+      min_[i] = min[i];
+      step_[i] = (max[i] - min[i]) / nbins[i];
+      nbins_[i] = nbins[i];
+    }
+  }
+
+  Acts::Vector3 position(std::int32_t i, std::int32_t j, std::int32_t k) const {
+    return Acts::Vector3(min_[0] + i * step_[0], min_[1] + j * step_[1],
+                         min_[2] + k * step_[2]);
+  }
+
+  Acts::Vector3 value(std::int32_t i, std::int32_t j, std::int32_t k) const {
+    if (i >= nbins_[0] || j >= nbins_[1] || k >= nbins_[2])
+      return Acts::Vector3::Zero();
+    // Acts local bins start at 1 because of the underflow bins
+    return grid_.atLocalBins({{static_cast<std::size_t>(i) + 1,
+                               static_cast<std::size_t>(j) + 1,
+                               static_cast<std::size_t>(k) + 1}});
+  }
+
+ private:
+  const MagneticFieldGrid3& grid_;
+  std::array<double, 3> min_;
+  std::array<double, 3> step_;
+  std::array<std::int32_t, 3> nbins_;
+};
+
+/// Call f(i, j, k) on all the grid points of a box of cells
+template <typename F>
+void forEachPoint(const std::array<std::int32_t, 3>& lo,
+                  const std::array<std::int32_t, 3>& hi, F&& f) {
+  for (std::int32_t i = lo[0]; i <= hi[0]; i++)
+    for (std::int32_t j = lo[1]; j <= hi[1]; j++)
+      for (std::int32_t k = lo[2]; k <= hi[2]; k++) f(i, j, k);
+}
+
+/**
+ * Fit the model of a box of cells.
+ *
+ * The grid points of the box form a regular lattice centered on the center
+ * of the box, so the least squares fit of a linear model decouples: the
+ * value at the center is the mean of the field and each column of the
+ * gradient is the covariance with the corresponding coordinate over its
+ * variance. The constant model uses the midrange of each component instead,
+ * which minimizes the largest deviation.
+ */
+BFieldRegion fitRegion(const GridPoints& points,
+                       const std::array<std::int32_t, 3>& lo,
+                       const std::array<std::int32_t, 3>& hi, int order) {
+  BFieldRegion region;
+  region.lo = lo;
+  region.hi = hi;
+  region.center = 0.5 * (points.position(lo[0], lo[1], lo[2]) +
+                         points.position(hi[0], hi[1], hi[2]));
+  region.value.setZero();
+  region.gradient.setZero();
+
+  if (order == 0) {
+    Acts::Vector3 bmin = Acts::Vector3::Constant(
+        std::numeric_limits<double>::max());
+    Acts::Vector3 bmax = -bmin;
+    forEachPoint(lo, hi, [&](std::int32_t i, std::int32_t j, std::int32_t k) {
+      Acts::Vector3 b = points.value(i, j, k);
+      bmin = bmin.cwiseMin(b);
+      bmax = bmax.cwiseMax(b);
+    });
+    region.value = 0.5 * (bmin + bmax);
+  } else {
+    Acts::Vector3 variance = Acts::Vector3::Zero();
+    double n = 0.;
+    forEachPoint(lo, hi, [&](std::int32_t i, std::int32_t j, std::int32_t k) {
+      Acts::Vector3 d = points.position(i, j, k) - region.center;
+      Acts::Vector3 b = points.value(i, j, k);
+      region.value += b;
+      region.gradient += b * d.transpose();
+      variance += d.cwiseProduct(d);
+      n += 1.;
+    });
+    region.value /= n;
+    for (int c = 0; c < 3; c++) {
+      // A box can be a single cell wide, but it always has two grid points
+      region.gradient.col(c) /= variance(c);
+    }
+  }
+
+  region.max_deviation = 0.;
+  forEachPoint(lo, hi, [&](std::int32_t i, std::int32_t j, std::int32_t k) {
+    Acts::Vector3 d = points.value(i, j, k) - region.eval(points.position(i, j, k));
+    region.max_deviation = std::max(region.max_deviation, d.cwiseAbs().maxCoeff());
+  });
+
+  return region;
+}
+
+}  // namespace
+
+BFieldRegionModel::BFieldRegionModel(const std::array<double, 3>& min,
+                                     const std::array<double, 3>& max,
+                                     const std::array<std::int32_t, 3>& nbins,
+                                     double tolerance)
+    : min_(min), max_(max), nbins_(nbins), tolerance_(tolerance) {
+  double ncells = 1.;
+  for (int i = 0; i < 3; i++) {
+    if (nbins_[i] <= 0 || !(max_[i] > min_[i]))
+      throw std::runtime_error("BFieldRegionModel: invalid binning");
+    inv_step_[i] = nbins_[i] / (max_[i] - min_[i]);
+    ncells *= nbins_[i];
+  }
+  if (ncells > std::numeric_limits<std::int32_t>::max())
+    throw std::runtime_error(
+        "BFieldRegionModel: the field map is too large to be indexed");
+  cell_region_.assign(static_cast<std::size_t>(ncells), -1);
+}
+
+BFieldRegionModel BFieldRegionModel::fit(const MagneticFieldGrid3& grid,
+                                         const Config& cfg) {
+  if (cfg.order != 0 && cfg.order != 1)
+    throw std::runtime_error("BFieldRegionModel: order must be 0 or 1");
+
+  auto min = grid.minPosition();
+  auto max = grid.maxPosition();
+  auto nbins = grid.numLocalBins();
+  BFieldRegionModel model(
+      {min[0], min[1], min[2]}, {max[0], max[1], max[2]},
+      {static_cast<std::int32_t>(nbins[0]), static_cast<std::int32_t>(nbins[1]),
+       static_cast<std::int32_t>(nbins[2])},
+      cfg.tolerance);
+
+  const GridPoints points(grid);
+  const std::int32_t min_cells = std::max(cfg.min_cells, 1);
+
+  // Split the boxes along their longest axis until the model is good enough
+  std::function<void(const std::array<std::int32_t, 3>&,
+                     const std::array<std::int32_t, 3>&)>
+      split = [&](const std::array<std::int32_t, 3>& lo,
+                  const std::array<std::int32_t, 3>& hi) {
+        BFieldRegion region = fitRegion(points, lo, hi, cfg.order);
+        if (region.max_deviation <= cfg.tolerance) {
+          model.addRegion(region);
+          return;
+        }
+
+        int axis = 0;
+        for (int i = 1; i < 3; i++)
+          if (hi[i] - lo[i] > hi[axis] - lo[axis]) axis = i;
+        // Left to the map
+        if (hi[axis] - lo[axis] <= min_cells) return;
+
+        std::int32_t mid = (lo[axis] + hi[axis]) / 2;
+        auto lo_hi = hi;
+        lo_hi[axis] = mid;
+        auto hi_lo = lo;
+        hi_lo[axis] = mid;
+        split(lo, lo_hi);
+        split(hi_lo, hi);
+      };
+  split({0, 0, 0}, model.nbins_);
+
+  return model;
+}
+
+void BFieldRegionModel::addRegion(const BFieldRegion& region) {
+  const auto index = static_cast<std::int32_t>(regions_.size());
+  regions_.push_back(region);
+  for (std::int32_t i = region.lo[0]; i < region.hi[0]; i++)
+    for (std::int32_t j = region.lo[1]; j < region.hi[1]; j++)
+      for (std::int32_t k = region.lo[2]; k < region.hi[2]; k++)
+        cell_region_[(i * nbins_[1] + j) * nbins_[2] + k] = index;
+}
+
+bool BFieldRegionModel::matches(const MagneticFieldGrid3& grid) const {
+  auto min = grid.minPosition();
+  auto max = grid.maxPosition();
+  auto nbins = grid.numLocalBins();
+  for (int i = 0; i < 3; i++) {
+    double step = (max_[i] - min_[i]) / nbins_[i];
+    if (static_cast<std::int32_t>(nbins[i]) != nbins_[i] ||
+        std::abs(min[i] - min_[i]) > 1e-6 * step ||
+        std::abs(max[i] - max_[i]) > 1e-6 * step)
+      return false;
+  }
+  return true;
+}
+
+double BFieldRegionModel::coverage() const {
+  auto covered = std::count_if(cell_region_.begin(), cell_region_.end(),
+                               [](std::int32_t r) { return r >= 0; });
+  return static_cast<double>(covered) / cell_region_.size();
+}
+
+void BFieldRegionModel::write(const std::string& path) const {
+  std::ofstream out(path);
+  if (!out) throw std::runtime_error("BFieldRegionModel: can't open " + path);
+
+  const double mm = Acts::UnitConstants::mm;
+  const double T = Acts::UnitConstants::T;
+
+  out << std::setprecision(std::numeric_limits<double>::max_digits10);
+  out << kModelMagic << "\n";
+  out << "nbins " << nbins_[0] << " " << nbins_[1] << " " << nbins_[2] << "\n";
+  out << "min " << min_[0] / mm << " " << min_[1] / mm << " " << min_[2] / mm
+      << "\n";
+  out << "max " << max_[0] / mm << " " << max_[1] / mm << " " << max_[2] / mm
+      << "\n";
+  out << "tolerance " << tolerance_ / T << "\n";
+  out << "regions " << regions_.size() << "\n";
+  // lo[3] hi[3] center[3] value[3] gradient[9] (row major) max_deviation
+  for (const auto& r : regions_) {
+    for (auto v : r.lo) out << v << " ";
+    for (auto v : r.hi) out << v << " ";
+    for (int i = 0; i < 3; i++) out << r.center(i) / mm << " ";
+    for (int i = 0; i < 3; i++) out << r.value(i) / T << " ";
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++) out << r.gradient(i, j) / (T / mm) << " ";
+    out << r.max_deviation / T << "\n";
+  }
+
+  if (!out) throw std::runtime_error("BFieldRegionModel: failed writing " + path);
+}
+
+BFieldRegionModel BFieldRegionModel::read(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("BFieldRegionModel: can't open " + path);
+
+  const double mm = Acts::UnitConstants::mm;
+  const double T = Acts::UnitConstants::T;
+
+  auto expect = [&](const std::string& keyword) {
+    std::string word;
+    if (!(in >> word) || word != keyword)
+      throw std::runtime_error("BFieldRegionModel: " + path +
+                               " is not a valid model file, expected '" +
+                               keyword + "'");
+  };
+
+  std::array<std::int32_t, 3> nbins;
+  std::array<double, 3> min, max;
+  double tolerance;
+  std::size_t nregions;
+
+  expect(kModelMagic);
+  expect("nbins");
+  in >> nbins[0] >> nbins[1] >> nbins[2];
+  expect("min");
+  in >> min[0] >> min[1] >> min[2];
+  expect("max");
+  in >> max[0] >> max[1] >> max[2];
+  expect("tolerance");
+  in >> tolerance;
+  expect("regions");
+  in >> nregions;
+  if (!in)
+    throw std::runtime_error("BFieldRegionModel: " + path +
+                             " has an invalid header");
+
+  for (int i = 0; i < 3; i++) {
+    min[i] *= mm;
+    max[i] *= mm;
+  }
+  BFieldRegionModel model(min, max, nbins, tolerance * T);
+
+  for (std::size_t n = 0; n < nregions; n++) {
+    BFieldRegion r;
+    for (auto& v : r.lo) in >> v;
+    for (auto& v : r.hi) in >> v;
+    for (int i = 0; i < 3; i++) in >> r.center(i);
+    for (int i = 0; i < 3; i++) in >> r.value(i);
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++) in >> r.gradient(i, j);
+    in >> r.max_deviation;
+    if (!in)
+      throw std::runtime_error("BFieldRegionModel: " + path +
+                               " is truncated");
+    for (int i = 0; i < 3; i++) {
+      if (r.lo[i] < 0 || r.hi[i] > nbins[i] || r.lo[i] >= r.hi[i])
+        throw std::runtime_error("BFieldRegionModel: " + path +
+                                 " has a region outside of the map");
+    }
+
+    r.center *= mm;
+    r.value *= T;
+    r.gradient *= T / mm;
+    r.max_deviation *= T;
+    model.addRegion(r);
+  }
+
+  return model;
+}
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,270 @@
+#include "Tracking/Sim/BFieldSoAGrid.h"
+
+//--- C++ ---//
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace tracking {
+namespace sim {
+
+namespace {
+
+#if defined(__AVX512F__)
+
+/// Gather 8 values of a plane and widen them to double
+inline __m512d gather8(const double* base, __m256i idx) {
+  return _mm512_i32gather_pd(idx, base, sizeof(double));
+}
+inline __m512d gather8(const float* base, __m256i idx) {
+  return _mm512_cvtps_pd(_mm256_i32gather_ps(base, idx, sizeof(float)));
+}
+
+inline __m512d lerp8(__m512d a, __m512d b, __m512d t) {
+  return _mm512_fmadd_pd(t, _mm512_sub_pd(b, a), a);
+}
+
+#elif defined(__AVX2__)
+
+/// Gather 4 values of a plane and widen them to double
+inline __m256d gather4(const double* base, __m128i idx) {
+  return _mm256_i32gather_pd(base, idx, sizeof(double));
+}
+inline __m256d gather4(const float* base, __m128i idx) {
+  return _mm256_cvtps_pd(_mm_i32gather_ps(base, idx, sizeof(float)));
+}
+
+inline __m256d lerp4(__m256d a, __m256d b, __m256d t) {
+#if defined(__FMA__)
+  return _mm256_fmadd_pd(t, _mm256_sub_pd(b, a), a);
+#else
+  return _mm256_add_pd(a, _mm256_mul_pd(t, _mm256_sub_pd(b, a)));
+#endif
+}
+
+#endif
+
+}  // namespace
+
+template <typename T>
+BFieldSoAGrid<T>::BFieldSoAGrid(const MagneticFieldGrid3& grid) {
+  auto min = grid.minPosition();
+  auto max = grid.maxPosition();
+  auto nbins = grid.numLocalBins();
+
+  // One extra layer of zeros at the upper edge of each axis
+  std::array<std::size_t, 3> npoints = {nbins[0] + 1, nbins[1] + 1,
+                                        nbins[2] + 1};
+  std::size_t size = npoints[0] * npoints[1] * npoints[2];
+  if (size > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+    throw std::runtime_error(
+        "BFieldSoAGrid: the field grid is too large to be indexed");
+
+  for (int i = 0; i < 3; i++) {
+    min_[i] = min[i];
+    nbins_[i] = nbins[i];
+    inv_step_[i] = nbins[i] / (max[i] - min[i]);
+  }
+  stride_ = {static_cast<std::int32_t>(npoints[1] * npoints[2]),
+             static_cast<std::int32_t>(npoints[2]), 1};
+
+  for (auto& plane : planes_) plane.assign(size, T(0));
+
+  for (std::size_t i = 0; i < nbins[0]; i++) {
+    for (std::size_t j = 0; j < nbins[1]; j++) {
+      for (std::size_t k = 0; k < nbins[2]; k++) {
+        // Acts local bins start at 1 because of the underflow bins
+        const Acts::Vector3& value = grid.atLocalBins({{i + 1, j + 1, k + 1}});
+        std::size_t idx = i * stride_[0] + j * stride_[1] + k;
+        for (int c = 0; c < 3; c++) planes_[c][idx] = static_cast<T>(value(c));
+      }
+    }
+  }
+}
+
+template <typename T>
+bool BFieldSoAGrid<T>::interpolate(const Acts::Vector3& pos,
+                                   Acts::Vector3& field) const {
+  std::int32_t idx = 0;
+  double t[3];
+  for (int i = 0; i < 3; i++) {
+    double u = (pos(i) - min_[i]) * inv_step_[i];
+    // Also rejects NaNs
+    if (!(u >= 0. && u < nbins_[i])) return false;
+    std::int32_t bin = static_cast<std::int32_t>(u);
+    t[i] = u - bin;
+    idx += bin * stride_[i];
+  }
+
+  const std::int32_t sx = stride_[0], sy = stride_[1], sz = stride_[2];
+  for (int c = 0; c < 3; c++) {
+    const T* v = planes_[c].data() + idx;
+    double c00 = v[0] + t[0] * (double(v[sx]) - v[0]);
+    double c01 = v[sz] + t[0] * (double(v[sx + sz]) - v[sz]);
+    double c10 = v[sy] + t[0] * (double(v[sx + sy]) - v[sy]);
+    double c11 = v[sy + sz] + t[0] * (double(v[sx + sy + sz]) - v[sy + sz]);
+    double c0 = c00 + t[1] * (c10 - c00);
+    double c1 = c01 + t[1] * (c11 - c01);
+    field(c) = c0 + t[2] * (c1 - c0);
+  }
+  return true;
+}
+
+template <typename T>
+std::size_t BFieldSoAGrid<T>::interpolate(const double* x, const double* y,
+                                          const double* z, double* bx,
+                                          double* by, double* bz,
+                                          std::uint8_t* inside,
+                                          std::size_t n) const {
+  std::size_t n_inside = 0;
+  std::size_t i = 0;
+
+#if defined(__AVX512F__)
+  const __m512d zero = _mm512_setzero_pd();
+  const __m256i vsx = _mm256_set1_epi32(stride_[0]);
+  const __m256i vsy = _mm256_set1_epi32(stride_[1]);
+  const __m256i vsz = _mm256_set1_epi32(stride_[2]);
+  const double* coords[3] = {x, y, z};
+  double* out[3] = {bx, by, bz};
+
+  for (; i + 8 <= n; i += 8) {
+    __mmask8 mask = 0xFF;
+    __m512d t[3];
+    __m256i bin[3];
+    for (int a = 0; a < 3; a++) {
+      __m512d u = _mm512_mul_pd(
+          _mm512_sub_pd(_mm512_loadu_pd(coords[a] + i), _mm512_set1_pd(min_[a])),
+          _mm512_set1_pd(inv_step_[a]));
+      // Ordered comparisons, so NaNs are outside
+      mask &= _mm512_cmp_pd_mask(u, zero, _CMP_GE_OQ);
+      mask &= _mm512_cmp_pd_mask(u, _mm512_set1_pd(nbins_[a]), _CMP_LT_OQ);
+      __m512d fl = _mm512_roundscale_pd(u, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+      t[a] = _mm512_sub_pd(u, fl);
+      bin[a] = _mm512_cvttpd_epi32(fl);
+    }
+
+    // Lanes outside of the map read the first cell and are zeroed at the end
+    __m256i lanes = _mm256_set_epi32(mask & 0x80, mask & 0x40, mask & 0x20,
+                                     mask & 0x10, mask & 0x08, mask & 0x04,
+                                     mask & 0x02, mask & 0x01);
+    __m256i valid = _mm256_cmpgt_epi32(lanes, _mm256_setzero_si256());
+    __m256i idx = _mm256_add_epi32(
+        _mm256_add_epi32(_mm256_mullo_epi32(bin[0], vsx),
+                         _mm256_mullo_epi32(bin[1], vsy)),
+        _mm256_mullo_epi32(bin[2], vsz));
+    idx = _mm256_and_si256(idx, valid);
+
+    const __m256i i100 = _mm256_add_epi32(idx, vsx);
+    const __m256i i010 = _mm256_add_epi32(idx, vsy);
+    const __m256i i001 = _mm256_add_epi32(idx, vsz);
+    const __m256i i110 = _mm256_add_epi32(i100, vsy);
+    const __m256i i101 = _mm256_add_epi32(i100, vsz);
+    const __m256i i011 = _mm256_add_epi32(i010, vsz);
+    const __m256i i111 = _mm256_add_epi32(i110, vsz);
+
+    for (int c = 0; c < 3; c++) {
+      const T* p = planes_[c].data();
+      __m512d c00 = lerp8(gather8(p, idx), gather8(p, i100), t[0]);
+      __m512d c01 = lerp8(gather8(p, i001), gather8(p, i101), t[0]);
+      __m512d c10 = lerp8(gather8(p, i010), gather8(p, i110), t[0]);
+      __m512d c11 = lerp8(gather8(p, i011), gather8(p, i111), t[0]);
+      __m512d c0 = lerp8(c00, c10, t[1]);
+      __m512d c1 = lerp8(c01, c11, t[1]);
+      _mm512_storeu_pd(out[c] + i, _mm512_maskz_mov_pd(mask, lerp8(c0, c1, t[2])));
+    }
+
+    for (int l = 0; l < 8; l++) inside[i + l] = (mask >> l) & 1;
+    n_inside += __builtin_popcount(mask);
+  }
+#elif defined(__AVX2__)
+  const __m256d zero = _mm256_setzero_pd();
+  const __m128i vsx = _mm_set1_epi32(stride_[0]);
+  const __m128i vsy = _mm_set1_epi32(stride_[1]);
+  const __m128i vsz = _mm_set1_epi32(stride_[2]);
+  const double* coords[3] = {x, y, z};
+  double* out[3] = {bx, by, bz};
+
+  for (; i + 4 <= n; i += 4) {
+    __m256d mask = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d t[3];
+    __m128i bin[3];
+    for (int a = 0; a < 3; a++) {
+      __m256d u = _mm256_mul_pd(
+          _mm256_sub_pd(_mm256_loadu_pd(coords[a] + i), _mm256_set1_pd(min_[a])),
+          _mm256_set1_pd(inv_step_[a]));
+      // Ordered comparisons, so NaNs are outside
+      mask = _mm256_and_pd(mask, _mm256_cmp_pd(u, zero, _CMP_GE_OQ));
+      mask = _mm256_and_pd(
+          mask, _mm256_cmp_pd(u, _mm256_set1_pd(nbins_[a]), _CMP_LT_OQ));
+      __m256d fl = _mm256_floor_pd(u);
+      t[a] = _mm256_sub_pd(u, fl);
+      bin[a] = _mm256_cvttpd_epi32(fl);
+    }
+
+    // Lanes outside of the map read the first cell and are zeroed at the end
+    int bits = _mm256_movemask_pd(mask);
+    __m128i valid = _mm_cmpgt_epi32(
+        _mm_set_epi32(bits & 8, bits & 4, bits & 2, bits & 1), _mm_setzero_si128());
+    __m128i idx = _mm_add_epi32(
+        _mm_add_epi32(_mm_mullo_epi32(bin[0], vsx), _mm_mullo_epi32(bin[1], vsy)),
+        _mm_mullo_epi32(bin[2], vsz));
+    idx = _mm_and_si128(idx, valid);
+
+    const __m128i i100 = _mm_add_epi32(idx, vsx);
+    const __m128i i010 = _mm_add_epi32(idx, vsy);
+    const __m128i i001 = _mm_add_epi32(idx, vsz);
+    const __m128i i110 = _mm_add_epi32(i100, vsy);
+    const __m128i i101 = _mm_add_epi32(i100, vsz);
+    const __m128i i011 = _mm_add_epi32(i010, vsz);
+    const __m128i i111 = _mm_add_epi32(i110, vsz);
+
+    for (int c = 0; c < 3; c++) {
+      const T* p = planes_[c].data();
+      __m256d c00 = lerp4(gather4(p, idx), gather4(p, i100), t[0]);
+      __m256d c01 = lerp4(gather4(p, i001), gather4(p, i101), t[0]);
+      __m256d c10 = lerp4(gather4(p, i010), gather4(p, i110), t[0]);
+      __m256d c11 = lerp4(gather4(p, i011), gather4(p, i111), t[0]);
+      __m256d c0 = lerp4(c00, c10, t[1]);
+      __m256d c1 = lerp4(c01, c11, t[1]);
+      _mm256_storeu_pd(out[c] + i, _mm256_and_pd(mask, lerp4(c0, c1, t[2])));
+    }
+
+    for (int l = 0; l < 4; l++) inside[i + l] = (bits >> l) & 1;
+    n_inside += __builtin_popcount(bits);
+  }
+#endif
+
+  // Scalar fallback and remainder of the vectorized loop
+  for (; i < n; i++) {
+    Acts::Vector3 field;
+    inside[i] = interpolate(Acts::Vector3(x[i], y[i], z[i]), field);
+    if (!inside[i]) field.setZero();
+    bx[i] = field(0);
+    by[i] = field(1);
+    bz[i] = field(2);
+    n_inside += inside[i];
+  }
+
+  return n_inside;
+}
+
+template <typename T>
+const char* BFieldSoAGrid<T>::kernel() {
+#if defined(__AVX512F__)
+  return "avx512";
+#elif defined(__AVX2__)
+  return "avx2";
+#else
+  return "scalar";
+#endif
+}
+
+template class BFieldSoAGrid<float>;
+template class BFieldSoAGrid<double>;
+
+}  // namespace sim
+}  // namespace tracking
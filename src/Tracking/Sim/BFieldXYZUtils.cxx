@@ -1,5 +1,11 @@
 #include "Tracking/Sim/BFieldXYZUtils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
 Acts::Vector3 default_transformPos(const Acts::Vector3& pos) {
 
   Acts::Vector3 rot_pos;
@@ -36,3 +42,179 @@ size_t localToGlobalBin_xyz(std::array<size_t, 3> bins,
   // return (bins[1] * (sizes[2] * sizes[0]) + bins[2] * sizes[0] + bins[0]);
   // //zxy
 }
+
+void readFieldMapText(const std::string& fieldMapFile,
+                      std::vector<double>& xPos, std::vector<double>& yPos,
+                      std::vector<double>& zPos,
+                      std::vector<Acts::Vector3>& bField) {
+
+  constexpr size_t kDefaultSize = 1 << 15;
+  // reserve estimated size
+  xPos.reserve(kDefaultSize);
+  yPos.reserve(kDefaultSize);
+  zPos.reserve(kDefaultSize);
+  bField.reserve(kDefaultSize);
+  // [1] Read in file and fill values
+  std::ifstream map_file(fieldMapFile.c_str(), std::ios::in);
+  std::string line;
+  double x = 0., y = 0., z = 0.;
+  double bx = 0., by = 0., bz = 0.;
+
+  bool headerFound = false;
+
+  while (std::getline(map_file, line)) {
+    if (line.empty() || line[0] == '%' || line[0] == '#' || line[0] == ' ' ||
+        line.find_first_not_of(' ') == std::string::npos    || !headerFound) {
+      if (line.find("Header") != std::string::npos)
+        headerFound = true;
+      continue;
+    }
+    std::istringstream tmp(line);
+    tmp >> x >> y >> z >> bx >> by >> bz;
+
+    xPos.push_back(x);
+    yPos.push_back(y);
+    zPos.push_back(z);
+    bField.push_back(Acts::Vector3(bx, by, bz));
+  }
+  map_file.close();
+
+  if (!headerFound) {
+    std::cout<<"MAP LOADING ERROR:: line containing the word 'Header' not found in the BMap."<<std::endl;
+  }
+
+  xPos.shrink_to_fit();
+  yPos.shrink_to_fit();
+  zPos.shrink_to_fit();
+  bField.shrink_to_fit();
+}
+
+void convertFieldMapToBinary(const std::string& fieldMapFile,
+                             const std::string& binaryFile,
+                             Acts::ActsScalar lengthUnit,
+                             Acts::ActsScalar BFieldUnit,
+                             bool singlePrecision) {
+
+  std::vector<double> xPos;
+  std::vector<double> yPos;
+  std::vector<double> zPos;
+  std::vector<Acts::Vector3> bField;
+
+  readFieldMapText(fieldMapFile, xPos, yPos, zPos, bField);
+
+  // Same axis definition of rotateFieldMapXYZ
+  std::array<size_t, 3> nBins;
+  std::array<double, 3> min;
+  std::array<double, 3> max;
+  std::array<std::vector<double>*, 3> axes = {&xPos, &yPos, &zPos};
+
+  for (size_t i = 0; i < 3; i++) {
+    auto& pos = *axes[i];
+    std::sort(pos.begin(), pos.end());
+    pos.erase(std::unique(pos.begin(), pos.end()), pos.end());
+    if (pos.size() < 2)
+      throw std::runtime_error("convertFieldMapToBinary: " + fieldMapFile +
+                               " needs at least two grid points per axis");
+
+    nBins[i] = pos.size();
+    // add one last bin, because bin value always corresponds to left boundary
+    double step = std::fabs(pos.back() - pos.front()) / (nBins[i] - 1);
+    min[i] = pos.front() * lengthUnit;
+    max[i] = (pos.back() + step) * lengthUnit;
+  }
+
+  size_t nPoints = nBins[0] * nBins[1] * nBins[2];
+  if (bField.size() != nPoints)
+    throw std::runtime_error("convertFieldMapToBinary: " + fieldMapFile +
+                             " has " + std::to_string(bField.size()) +
+                             " field values for a grid of " +
+                             std::to_string(nPoints) + " points");
+
+  // The ASCII maps are already in xyz ordering
+  std::vector<double> bx(nPoints), by(nPoints), bz(nPoints);
+  for (size_t idx = 0; idx < nPoints; idx++) {
+    bx[idx] = bField[idx](0) * BFieldUnit;
+    by[idx] = bField[idx](1) * BFieldUnit;
+    bz[idx] = bField[idx](2) * BFieldUnit;
+  }
+
+  tracking::sim::writeBinaryFieldMap(binaryFile, nBins, min, max, bx, by, bz,
+                                     singlePrecision);
+}
+
+MagneticFieldGrid3 makeFieldGridFromBinary(const tracking::sim::BFieldMapFile& fieldMap) {
+
+  const auto& header = fieldMap.header();
+  size_t nBinsX = header.nbins[0];
+  size_t nBinsY = header.nbins[1];
+  size_t nBinsZ = header.nbins[2];
+
+  Acts::detail::EquidistantAxis xAxis(header.min[0], header.max[0], nBinsX);
+  Acts::detail::EquidistantAxis yAxis(header.min[1], header.max[1], nBinsY);
+  Acts::detail::EquidistantAxis zAxis(header.min[2], header.max[2], nBinsZ);
+
+  MagneticFieldGrid3 grid(
+      std::make_tuple(std::move(xAxis), std::move(yAxis), std::move(zAxis)));
+
+  // The planes are stored in xyz ordering, so they are read sequentially
+  size_t idx = 0;
+  for (size_t i = 1; i <= nBinsX; ++i) {
+    for (size_t j = 1; j <= nBinsY; ++j) {
+      for (size_t k = 1; k <= nBinsZ; ++k, ++idx) {
+        grid.atLocalBins({{i, j, k}}) =
+            Acts::Vector3(fieldMap.value(0, idx), fieldMap.value(1, idx),
+                          fieldMap.value(2, idx));
+      }
+    }
+  }
+  grid.setExteriorBins(Acts::Vector3::Zero());
+
+  return grid;
+}
+
+InterpolatedMagneticField3 makeMagneticFieldMapXyzFromBinary(const tracking::sim::BFieldMapFile& fieldMap,
+                                                             GenericTransformPos transformPosition,
+                                                             GenericTransformBField transformMagneticField) {
+
+  return InterpolatedMagneticField3(
+      {transformPosition, transformMagneticField, makeFieldGridFromBinary(fieldMap)});
+}
+
+std::string findBinaryFieldMap(const std::string& fieldMapFile) {
+
+  if (tracking::sim::isBinaryFieldMap(fieldMapFile))
+    return fieldMapFile;
+
+  std::string cache = tracking::sim::binaryFieldMapCachePath(fieldMapFile);
+  std::error_code ec;
+  auto cacheTime = std::filesystem::last_write_time(cache, ec);
+  if (ec)
+    return "";
+  auto mapTime = std::filesystem::last_write_time(fieldMapFile, ec);
+  // Ignore stale caches
+  if (!ec && cacheTime < mapTime)
+    return "";
+
+  return tracking::sim::isBinaryFieldMap(cache) ? cache : "";
+}
+
+MagneticFieldGrid3 loadDefaultBFieldGrid(const std::string& fieldMapFile) {
+
+  std::string binaryFile = findBinaryFieldMap(fieldMapFile);
+  if (!binaryFile.empty())
+    return makeFieldGridFromBinary(tracking::sim::BFieldMapFile(binaryFile));
+
+  std::vector<double> xPos;
+  std::vector<double> yPos;
+  std::vector<double> zPos;
+  std::vector<Acts::Vector3> bField;
+
+  readFieldMapText(fieldMapFile, xPos, yPos, zPos, bField);
+
+  // Same units of loadDefaultBField
+  return makeFieldGridXYZ(localToGlobalBin_xyz, std::move(xPos), std::move(yPos),
+                          std::move(zPos), bField,
+                          1. * Acts::UnitConstants::mm,
+                          1000. * Acts::UnitConstants::T,
+                          false);
+}
@@ -0,0 +1,33 @@
+#include "Tracking/Sim/HitMask.h"
+
+//--- C++ ---//
+#include <bitset>
+
+namespace tracking {
+namespace sim {
+
+std::size_t HitMask::mask(const std::vector<ldmx::Track>& tracks) {
+  std::size_t n_masked = 0;
+  for (const auto& track : tracks) {
+    if (track.getNhits() < cfg_.min_nhits) continue;
+    if (track.getNdf() <= 0 ||
+        track.getChi2() / track.getNdf() > cfg_.max_chi2_ndf)
+      continue;
+
+    for (unsigned int index : track.getMeasurementsIdxs()) {
+      if (index < n_measurements_)
+        words_[index >> 6] |= std::uint64_t{1} << (index & 63);
+    }
+    n_masked++;
+  }
+  return n_masked;
+}
+
+std::size_t HitMask::count() const {
+  std::size_t n = 0;
+  for (std::uint64_t word : words_) n += std::bitset<64>(word).count();
+  return n;
+}
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,196 @@
+#include "Tracking/Sim/PhiloxRandom.h"
+
+//--- C++ ---//
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace tracking {
+namespace sim {
+
+namespace {
+constexpr std::uint32_t kMultiplier0 = 0xD2511F53;
+constexpr std::uint32_t kMultiplier1 = 0xCD9E8D57;
+constexpr std::uint32_t kWeyl0 = 0x9E3779B9;
+constexpr std::uint32_t kWeyl1 = 0xBB67AE85;
+constexpr int kRounds = 10;
+
+/// Counters done at once by the batched generation, sized for the stack
+constexpr std::size_t kChunk = 256;
+
+/**
+ * Philox rounds of a chunk of counters, word j of counter i in words[j][i].
+ *
+ * The rounds are the outer loop so that the inner loop over the counters is
+ * straight code on 32 bit words, which the compiler vectorizes.
+ */
+void philox(const PhiloxRandom::Counter* counters, std::size_t n,
+            PhiloxRandom::Key key, std::uint32_t (&words)[4][kChunk]) {
+  std::uint32_t* w0 = words[0];
+  std::uint32_t* w1 = words[1];
+  std::uint32_t* w2 = words[2];
+  std::uint32_t* w3 = words[3];
+  for (std::size_t i = 0; i < n; i++) {
+    w0[i] = counters[i][0];
+    w1[i] = counters[i][1];
+    w2[i] = counters[i][2];
+    w3[i] = counters[i][3];
+  }
+  for (int r = 0; r < kRounds; r++) {
+    const std::uint32_t k0 = key[0], k1 = key[1];
+    for (std::size_t i = 0; i < n; i++) {
+      std::uint64_t p0 = std::uint64_t(kMultiplier0) * w0[i];
+      std::uint64_t p1 = std::uint64_t(kMultiplier1) * w2[i];
+      std::uint32_t x1 = w1[i], x3 = w3[i];
+      w0[i] = static_cast<std::uint32_t>(p1 >> 32) ^ x1 ^ k0;
+      w1[i] = static_cast<std::uint32_t>(p1);
+      w2[i] = static_cast<std::uint32_t>(p0 >> 32) ^ x3 ^ k1;
+      w3[i] = static_cast<std::uint32_t>(p0);
+    }
+    key[0] += kWeyl0;
+    key[1] += kWeyl1;
+  }
+}
+
+/// Uniform number in (0, 1) from the top 24 bits of a word
+inline float uniform(std::uint32_t x) {
+  return ((x >> 8) + 0.5f) * (1.f / 16777216.f);
+}
+
+/**
+ * Natural logarithm of a positive normal float, with the polynomial of the
+ * Cephes logf, within 2 ulp. Written without calls and branches so that the
+ * loops using it are vectorized.
+ */
+inline float log(float x) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  // x = m * 2^e with m in [sqrt(1/2), sqrt(2))
+  std::int32_t e = std::int32_t((bits + 0x004afb0d) >> 23) - 127;
+  bits = ((bits + 0x004afb0d) & 0x007fffff) + 0x3f3504f3;
+  float m;
+  std::memcpy(&m, &bits, sizeof(m));
+  float f = m - 1.f;
+  float z = f * f;
+  float p = 7.0376836292e-2f;
+  p = p * f - 1.1514610310e-1f;
+  p = p * f + 1.1676998740e-1f;
+  p = p * f - 1.2420140846e-1f;
+  p = p * f + 1.4249322787e-1f;
+  p = p * f - 1.6668057665e-1f;
+  p = p * f + 2.0000714765e-1f;
+  p = p * f - 2.4999993993e-1f;
+  p = p * f + 3.3333331174e-1f;
+  float fe = float(e);
+  return f + (p * f * z - 0.5f * z) + fe * 0.693147180559945f;
+}
+
+/**
+ * Cosine and sine of 2 pi u for u in [0, 1], with the Cephes minimax
+ * polynomials on [-pi/4, pi/4] after a reduction by quarter turns.
+ */
+inline void sincos2pi(float u, float& c, float& s) {
+  constexpr float two_pi = 6.283185307f;
+  int q = int(4.f * u + 0.5f);
+  float a = two_pi * (u - 0.25f * float(q));
+  float z = a * a;
+  float sa = a + a * z * (-1.6666654611e-1f +
+                          z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+  float ca = 1.f - 0.5f * z +
+             z * z * (4.166664568298827e-2f +
+                      z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+  // Rotate by q quarter turns
+  q &= 3;
+  float c1 = (q & 1) ? -sa : ca;
+  float s1 = (q & 1) ? ca : sa;
+  c = (q & 2) ? -c1 : c1;
+  s = (q & 2) ? -s1 : s1;
+}
+}  // namespace
+
+PhiloxRandom::PhiloxRandom(std::uint64_t seed, int run)
+    : key_{static_cast<std::uint32_t>(seed),
+           static_cast<std::uint32_t>(seed >> 32) ^
+               static_cast<std::uint32_t>(run)} {}
+
+PhiloxRandom::Counter PhiloxRandom::generate(Counter counter, Key key) {
+  for (int r = 0; r < kRounds; r++) {
+    std::uint64_t p0 = std::uint64_t(kMultiplier0) * counter[0];
+    std::uint64_t p1 = std::uint64_t(kMultiplier1) * counter[2];
+    counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+               static_cast<std::uint32_t>(p1),
+               static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+               static_cast<std::uint32_t>(p0)};
+    key[0] += kWeyl0;
+    key[1] += kWeyl1;
+  }
+  return counter;
+}
+
+void PhiloxRandom::generate(const Counter* counters, std::size_t n,
+                            Counter* out) const {
+  std::uint32_t words[4][kChunk];
+  for (std::size_t first = 0; first < n; first += kChunk) {
+    const std::size_t m = std::min(kChunk, n - first);
+    philox(counters + first, m, key_, words);
+    for (std::size_t i = 0; i < m; i++)
+      out[first + i] = {words[0][i], words[1][i], words[2][i], words[3][i]};
+  }
+}
+
+void PhiloxRandom::normal(const Counter* counters, std::size_t n,
+                          float* out) const {
+  std::uint32_t words[4][kChunk];
+  for (std::size_t first = 0; first < n; first += kChunk) {
+    const std::size_t m = std::min(kChunk, n - first);
+    philox(counters + first, m, key_, words);
+
+    // Box-Muller, two normal numbers from words 0 and 1 and two from words 2
+    // and 3 of each counter
+    float* z = out + kBlockSize * first;
+    for (std::size_t i = 0; i < m; i++) {
+      float r0 = std::sqrt(-2.f * log(uniform(words[0][i])));
+      float r1 = std::sqrt(-2.f * log(uniform(words[2][i])));
+      float c0, s0, c1, s1;
+      sincos2pi(uniform(words[1][i]), c0, s0);
+      sincos2pi(uniform(words[3][i]), c1, s1);
+      z[kBlockSize * i] = r0 * c0;
+      z[kBlockSize * i + 1] = r0 * s0;
+      z[kBlockSize * i + 2] = r1 * c1;
+      z[kBlockSize * i + 3] = r1 * s1;
+    }
+  }
+}
+
+bool PhiloxRandom::checkKnownAnswers() {
+  // Known answers of Philox4x32-10 from the Random123 distribution
+  // (kat_vectors): counter, key and output
+  struct KnownAnswer {
+    Counter counter;
+    Key key;
+    Counter output;
+  };
+  static const KnownAnswer answers[] = {
+      {{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+       {0x00000000, 0x00000000},
+       {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+      {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+       {0xffffffff, 0xffffffff},
+       {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+      {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+       {0xa4093822, 0x299f31d0},
+       {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}};
+
+  for (const auto& answer : answers) {
+    if (generate(answer.counter, answer.key) != answer.output) return false;
+    PhiloxRandom random;
+    random.key_ = answer.key;
+    Counter output;
+    random.generate(&answer.counter, 1, &output);
+    if (output != answer.output) return false;
+  }
+  return true;
+}
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,90 @@
+#include "Tracking/Sim/StepSizeMap.h"
+
+//--- C++ ---//
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace tracking {
+namespace sim {
+
+StepSizeMap::StepSizeMap(const MagneticFieldGrid3& grid, const Config& cfg)
+    : max_step_(cfg.max_step) {
+  if (cfg.region_cells < 1 || !(cfg.min_step > 0.) ||
+      cfg.max_step < cfg.min_step || !(cfg.field_tolerance > 0.))
+    throw std::runtime_error("StepSizeMap: invalid configuration");
+
+  auto min = grid.minPosition();
+  auto max = grid.maxPosition();
+  auto nbins = grid.numLocalBins();
+  std::array<std::int32_t, 3> ncells;
+  std::array<double, 3> step;
+  for (int i = 0; i < 3; i++) {
+    ncells[i] = nbins[i];
+    step[i] = (max[i] - min[i]) / nbins[i];
+    min_[i] = min[i];
+    nregions_[i] = (ncells[i] + cfg.region_cells - 1) / cfg.region_cells;
+    inv_size_[i] = 1. / (cfg.region_cells * step[i]);
+  }
+
+  // Acts local bins start at 1 because of the underflow bins
+  auto value = [&](std::int32_t i, std::int32_t j, std::int32_t k) {
+    return grid.atLocalBins({{static_cast<std::size_t>(i) + 1,
+                              static_cast<std::size_t>(j) + 1,
+                              static_cast<std::size_t>(k) + 1}});
+  };
+
+  // Largest derivative of any field component in each region, from the
+  // differences between neighbouring grid points
+  std::vector<double> gradient(
+      static_cast<std::size_t>(nregions_[0]) * nregions_[1] * nregions_[2], 0.);
+  auto region = [&](std::int32_t i, std::int32_t j, std::int32_t k) {
+    return (static_cast<std::size_t>(i / cfg.region_cells) * nregions_[1] +
+            j / cfg.region_cells) *
+               nregions_[2] +
+           k / cfg.region_cells;
+  };
+  for (std::int32_t i = 0; i < ncells[0]; i++) {
+    for (std::int32_t j = 0; j < ncells[1]; j++) {
+      for (std::int32_t k = 0; k < ncells[2]; k++) {
+        Acts::Vector3 b = value(i, j, k);
+        double g = 0.;
+        if (i + 1 < ncells[0])
+          g = std::max(g, (value(i + 1, j, k) - b).cwiseAbs().maxCoeff() / step[0]);
+        if (j + 1 < ncells[1])
+          g = std::max(g, (value(i, j + 1, k) - b).cwiseAbs().maxCoeff() / step[1]);
+        if (k + 1 < ncells[2])
+          g = std::max(g, (value(i, j, k + 1) - b).cwiseAbs().maxCoeff() / step[2]);
+        auto& r = gradient[region(i, j, k)];
+        r = std::max(r, g);
+      }
+    }
+  }
+
+  // A step can leave its region, so the neighbours are included
+  steps_.assign(gradient.size(), cfg.max_step);
+  for (std::int32_t i = 0; i < nregions_[0]; i++) {
+    for (std::int32_t j = 0; j < nregions_[1]; j++) {
+      for (std::int32_t k = 0; k < nregions_[2]; k++) {
+        double g = 0.;
+        for (std::int32_t di = std::max(i - 1, 0);
+             di <= std::min(i + 1, nregions_[0] - 1); di++)
+          for (std::int32_t dj = std::max(j - 1, 0);
+               dj <= std::min(j + 1, nregions_[1] - 1); dj++)
+            for (std::int32_t dk = std::max(k - 1, 0);
+                 dk <= std::min(k + 1, nregions_[2] - 1); dk++)
+              g = std::max(g, gradient[(static_cast<std::size_t>(di) *
+                                            nregions_[1] +
+                                        dj) *
+                                           nregions_[2] +
+                                       dk]);
+        double h = g > 0. ? cfg.field_tolerance / g : cfg.max_step;
+        steps_[(static_cast<std::size_t>(i) * nregions_[1] + j) * nregions_[2] +
+               k] = std::clamp(h, cfg.min_step, cfg.max_step);
+      }
+    }
+  }
+}
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,197 @@
+#include "Tracking/Sim/StripDigitizer.h"
+
+//--- C++ ---//
+#include <stdexcept>
+
+//--- Tracking ---//
+#include "Tracking/Sim/FastMath.h"
+
+namespace tracking {
+namespace sim {
+
+namespace {
+/// Smallest width of a charge cloud, so that the charge deposited right on
+/// the readout side still has a well defined sharing
+constexpr float kMinSigma = 1e-4;
+}  // namespace
+
+StripDigitizer::StripDigitizer(const Config& cfg) : cfg_(cfg) {
+  if (cfg_.n_strips < 1 || cfg_.n_segments < 1 || cfg_.n_samples < 1 ||
+      !(cfg_.pair_energy > 0.) || !(cfg_.electrons_per_adc > 0.) ||
+      !(cfg_.shaping_time > 0.))
+    throw std::runtime_error("StripDigitizer: invalid configuration");
+}
+
+void StripDigitizer::clear() {
+  slots_.clear();
+  slot_sensor_.clear();
+  slot_half_u_.clear();
+  seg_slot_.clear();
+  seg_u_.clear();
+  seg_w_.clear();
+  seg_thickness_.clear();
+  seg_half_u_.clear();
+  seg_sigma_.clear();
+  seg_charge_.clear();
+  seg_time_.clear();
+  strips_.clear();
+}
+
+std::size_t StripDigitizer::slot(int sensor_id, double half_length_u) {
+  auto [it, inserted] = slots_.try_emplace(sensor_id, slot_sensor_.size());
+  if (inserted) {
+    slot_sensor_.push_back(sensor_id);
+    slot_half_u_.push_back(half_length_u);
+  }
+  return it->second;
+}
+
+void StripDigitizer::deposit(int sensor_id, double half_length_u,
+                             double thickness, const Acts::Vector3& entry,
+                             const Acts::Vector3& exit, double edep,
+                             double time) {
+  if (!(edep > 0.) || !(thickness > 0.) || !(half_length_u > 0.)) return;
+
+  // Clip the path to the thickness of the sensor
+  double half_t = 0.5 * thickness;
+  Acts::Vector3 start = entry;
+  Acts::Vector3 path = exit - entry;
+  if (std::abs(path(2)) > 0.) {
+    double f0 = std::clamp((-half_t - entry(2)) / path(2), 0., 1.);
+    double f1 = std::clamp((half_t - entry(2)) / path(2), 0., 1.);
+    if (f0 > f1) std::swap(f0, f1);
+    start = entry + f0 * path;
+    path *= f1 - f0;
+  }
+
+  std::size_t s = slot(sensor_id, half_length_u);
+  float charge = edep / cfg_.pair_energy / cfg_.n_segments;
+  for (int k = 0; k < cfg_.n_segments; k++) {
+    Acts::Vector3 pos = start + (k + 0.5) / cfg_.n_segments * path;
+    seg_slot_.push_back(s);
+    seg_u_.push_back(pos(0));
+    seg_w_.push_back(std::clamp(pos(2), -half_t, half_t));
+    seg_thickness_.push_back(thickness);
+    seg_half_u_.push_back(half_length_u);
+    seg_charge_.push_back(charge);
+    seg_time_.push_back(time);
+  }
+}
+
+void StripDigitizer::drift() {
+  const std::size_t n = seg_u_.size();
+  seg_sigma_.resize(n);
+
+  const float side = cfg_.readout_side < 0 ? -1.f : 1.f;
+  const float lorentz_tan = cfg_.lorentz_tan;
+  const float diffusion = cfg_.diffusion;
+  float* u = seg_u_.data();
+  float* sigma = seg_sigma_.data();
+  const float* w = seg_w_.data();
+  const float* thickness = seg_thickness_.data();
+
+  for (std::size_t i = 0; i < n; i++) {
+    // Distance to the readout side, at w = side * thickness / 2
+    float d = std::max(0.f, 0.5f * thickness[i] - side * w[i]);
+    u[i] += d * lorentz_tan;
+    sigma[i] = diffusion * std::sqrt(d / thickness[i]) + kMinSigma;
+  }
+}
+
+void StripDigitizer::share() {
+  const int n_strips = cfg_.n_strips;
+  const std::size_t n = seg_u_.size();
+  charge_.assign(slot_sensor_.size() * n_strips, 0.f);
+  charge_time_.assign(slot_sensor_.size() * n_strips, 0.f);
+
+  // Position and width in strips of each segment, strip j covers [j, j + 1)
+  seg_x_.resize(n);
+  seg_width_.resize(n);
+  const float max_strip = n_strips;
+  const float* u = seg_u_.data();
+  const float* sigma = seg_sigma_.data();
+  const float* half_u = seg_half_u_.data();
+  float* x = seg_x_.data();
+  float* width = seg_width_.data();
+  for (std::size_t i = 0; i < n; i++) {
+    float inv_pitch = 0.5f * max_strip / half_u[i];
+    x[i] = (u[i] + half_u[i]) * inv_pitch;
+    width[i] = sigma[i] * inv_pitch;
+  }
+
+  // The strips [lo, hi) within 3 sigma of each segment. The bounds are
+  // clamped before the conversion, so the truncation is a floor.
+  seg_inv_width_.resize(n);
+  seg_lo_.resize(n);
+  seg_hi_.resize(n);
+  float* inv_width = seg_inv_width_.data();
+  int* lo = seg_lo_.data();
+  int* hi = seg_hi_.data();
+  int n_edges = 1;
+  for (std::size_t i = 0; i < n; i++) {
+    lo[i] = int(std::min(std::max(x[i] - 3.f * width[i], 0.f), max_strip));
+    hi[i] =
+        int(std::min(std::max(x[i] + 3.f * width[i] + 1.f, 0.f), max_strip));
+    n_edges = std::max(n_edges, hi[i] - lo[i] + 1);
+    inv_width[i] = 1.f / (std::sqrt(2.f) * width[i]);
+  }
+
+  // Error function at the edges of the strips of each segment, edge e of
+  // segment i at edges_[e * n + i]. All the segments get the same number of
+  // edges so that the loop runs over the segments.
+  edges_.resize(n_edges * n);
+  for (int e = 0; e < n_edges; e++) {
+    float* edges = edges_.data() + e * n;
+    for (std::size_t i = 0; i < n; i++)
+      edges[i] = fastmath::erf((lo[i] + e - x[i]) * inv_width[i]);
+  }
+
+  // Fraction of the Gaussian cloud between the edges of each strip
+  for (std::size_t i = 0; i < n; i++) {
+    std::size_t s = seg_slot_[i];
+    float q = 0.5f * seg_charge_[i];
+    float qt = q * seg_time_[i];
+    float* charge = charge_.data() + s * n_strips + lo[i];
+    float* charge_time = charge_time_.data() + s * n_strips + lo[i];
+    const float* edges = edges_.data() + i;
+    for (int j = 0; j < hi[i] - lo[i]; j++) {
+      float frac = edges[(j + 1) * n] - edges[j * n];
+      charge[j] += q * frac;
+      charge_time[j] += qt * frac;
+    }
+  }
+}
+
+void StripDigitizer::noise(const PhiloxRandom& random, int event) {
+  strips_.clear();
+  for (std::size_t k = 0; k < charge_.size(); k++)
+    if (charge_[k] > 0.) strips_.push_back(k);
+
+  const std::size_t n_blocks = noise_blocks();
+  counters_.resize(strips_.size() * n_blocks);
+  for (std::size_t j = 0; j < strips_.size(); j++) {
+    int sensor_id = slot_sensor_[strips_[j] / cfg_.n_strips];
+    int strip = strips_[j] % cfg_.n_strips;
+    for (std::size_t b = 0; b < n_blocks; b++)
+      counters_[j * n_blocks + b] =
+          PhiloxRandom::counter(event, sensor_id, strip, b);
+  }
+
+  noise_.resize(counters_.size() * PhiloxRandom::kBlockSize);
+  random.normal(counters_.data(), counters_.size(), noise_.data());
+}
+
+void StripDigitizer::pulseShape(float t0, std::vector<float>& pulse) const {
+  const float first_sample_time = cfg_.first_sample_time;
+  const float sample_spacing = cfg_.sample_spacing;
+  const float inv_tau = 1. / cfg_.shaping_time;
+  float* f = pulse.data();
+  for (int i = 0; i < cfg_.n_samples; i++) {
+    float t = std::max(
+        0.f, (first_sample_time + i * sample_spacing - t0) * inv_tau);
+    f[i] = t * fastmath::exp(1.f - t);
+  }
+}
+
+}  // namespace sim
+}  // namespace tracking
@@ -0,0 +1,83 @@
+#include "Tracking/Sim/SurfaceSourceLinks.h"
+
+//--- C++ ---//
+#include <algorithm>
+
+namespace tracking {
+namespace sim {
+
+void SurfaceSourceLinks::setSurfaces(
+    const std::unordered_map<unsigned int, const Acts::Surface*>&
+        layer_surfaces) {
+  geo_ids_.clear();
+  for (const auto& [layer, surface] : layer_surfaces) {
+    if (surface) geo_ids_.push_back(surface->geometryId().value());
+  }
+  std::sort(geo_ids_.begin(), geo_ids_.end());
+  geo_ids_.erase(std::unique(geo_ids_.begin(), geo_ids_.end()),
+                 geo_ids_.end());
+
+  layer_slots_.clear();
+  for (const auto& [layer, surface] : layer_surfaces) {
+    layer_slots_.emplace_back(
+        layer, surface ? findSlot(surface->geometryId()) : -1);
+  }
+  std::sort(layer_slots_.begin(), layer_slots_.end());
+
+  offsets_.assign(geo_ids_.size() + 1, 0);
+  links_.clear();
+}
+
+std::size_t SurfaceSourceLinks::fill(
+    const std::vector<ldmx::Measurement>& measurements,
+    const HitMask* used_hits) {
+  const std::size_t n_slots = geo_ids_.size();
+  std::size_t n_missing = 0;
+
+  // Count the measurements of each slot
+  measurement_slots_.resize(measurements.size());
+  offsets_.assign(n_slots + 1, 0);
+  for (std::size_t i = 0; i < measurements.size(); i++) {
+    if (used_hits && used_hits->used(i)) {
+      measurement_slots_[i] = -1;
+      continue;
+    }
+    unsigned int layer = measurements[i].getLayerID();
+    auto it = std::lower_bound(
+        layer_slots_.begin(), layer_slots_.end(), layer,
+        [](const auto& entry, unsigned int id) { return entry.first < id; });
+    std::int32_t slot =
+        (it != layer_slots_.end() && it->first == layer) ? it->second : -1;
+    measurement_slots_[i] = slot;
+    if (slot < 0) {
+      n_missing++;
+      continue;
+    }
+    offsets_[slot + 1]++;
+  }
+
+  for (std::size_t s = 0; s < n_slots; s++) offsets_[s + 1] += offsets_[s];
+
+  // Place the source links, keeping the order of the measurements
+  links_.resize(offsets_[n_slots]);
+  cursors_.assign(offsets_.begin(), offsets_.end() - 1);
+  for (std::size_t i = 0; i < measurements.size(); i++) {
+    std::int32_t slot = measurement_slots_[i];
+    if (slot < 0) continue;
+    links_[cursors_[slot]++] = ActsExamples::IndexSourceLink(
+        Acts::GeometryIdentifier(geo_ids_[slot]),
+        static_cast<ActsExamples::Index>(i));
+  }
+
+  return n_missing;
+}
+
+std::int32_t SurfaceSourceLinks::findSlot(
+    Acts::GeometryIdentifier geo_id) const {
+  auto it = std::lower_bound(geo_ids_.begin(), geo_ids_.end(), geo_id.value());
+  if (it == geo_ids_.end() || *it != geo_id.value()) return -1;
+  return static_cast<std::int32_t>(it - geo_ids_.begin());
+}
+
+}  // namespace sim
+}  // namespace tracking
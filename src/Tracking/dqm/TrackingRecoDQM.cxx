@@ -3,6 +3,8 @@
 
 
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 
 namespace tracking::dqm {
 
@@ -19,7 +21,8 @@ void TrackingRecoDQM::configure(framework::config::Parameters &parameters) {
 void TrackingRecoDQM::analyze(const framework::Event& event) {
   
   if (!event.exists(trackCollection_)) return;
-  auto tracks{event.getCollection<ldmx::Track>(trackCollection_)};
+  auto start = std::chrono::high_resolution_clock::now();
+  const auto& tracks{event.getCollection<ldmx::Track>(trackCollection_)};
 
   // The truth track collection
   if (event.exists(truthCollection_)) {
@@ -53,6 +56,10 @@ void TrackingRecoDQM::analyze(const framework::Event& event) {
   uniqueTracks.clear();
   duplicateTracks.clear();
   fakeTracks.clear();
+
+  auto end = std::chrono::high_resolution_clock::now();
+  processing_time_ += std::chrono::duration<double, std::milli>(end - start).count();
+  nevents_++;
   
 }
 
@@ -62,6 +69,11 @@ void TrackingRecoDQM::onProcessEnd() {
   //Produce the efficiency plots. (TODO::Switch to TEfficiency instead)
 
   //TH1* matchp = histograms_.get(title+"match_p");
+
+  std::cout << "PROCESSOR:: " << this->getName()
+            << "   AVG Time/Event: "
+            << (nevents_ > 0 ? processing_time_ / nevents_ : 0.) << " ms"
+            << std::endl;
 } 
 
 
@@ -79,7 +91,7 @@ void TrackingRecoDQM::TrackMonitoring(const std::vector<ldmx::Track>& tracks,
     double trk_phi    = track.getPhi();
     double trk_p      = 1./abs(trk_qop);
     
-    std::vector<double> trk_mom = track.getMomentum();
+    const auto& trk_mom = track.getMomentum();
     
     //The transverse momentum in the bending plane
     double pt_bending = std::sqrt(trk_mom[0]*trk_mom[0] + trk_mom[1]*trk_mom[1]);
@@ -128,7 +140,7 @@ void TrackingRecoDQM::TrackMonitoring(const std::vector<ldmx::Track>& tracks,
 
 
     //Track states monitoring
-    auto trackStates = track.getTrackStates();
+    const auto& trackStates = track.getTrackStates();
     
     for (auto& ts : trackStates) {}
         
@@ -241,9 +253,7 @@ void TrackingRecoDQM::TrackEcalScoringPlaneMonitoring(const std::vector<ldmx::Tr
 
   std::vector<ldmx::SimTrackerHit> sel_ecal_spHits;
 
-  // TODO Use reference instead to avoid copy?
-
-  for (auto sp_hit : *(ecal_scoring_hits_)) {
+  for (const auto& sp_hit : *(ecal_scoring_hits_)) {
     
     if (sp_hit.getMomentum()[2] > 0 && ((sp_hit.getID() & 0xfff) == 31)) {
       
@@ -267,7 +277,7 @@ void TrackingRecoDQM::TrackEcalScoringPlaneMonitoring(const std::vector<ldmx::Tr
           continue;
                   
         
-        ldmx::Track::TrackState ecalState = track.getTrackStates()[1];
+        const ldmx::Track::TrackState& ecalState = track.getTrackStates()[1];
         
 
         // Here is where you add the histograms
@@ -0,0 +1,273 @@
+#include "Tracking/geo/GeometryCache.h"
+
+#include "Acts/Material/HomogeneousSurfaceMaterial.hpp"
+#include "Acts/Material/HomogeneousVolumeMaterial.hpp"
+#include "Acts/Material/MaterialSlab.hpp"
+#include "Acts/Surfaces/PlaneSurface.hpp"
+#include "Acts/Surfaces/RectangleBounds.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace tracking::geo {
+
+namespace {
+
+const std::string kCacheMagic = "LDMX-TRACKING-GEOMETRY";
+const int kCacheVersion = 1;
+
+/// 64 bit FNV-1a hash
+class Hasher {
+ public:
+  void add(const char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+      hash_ ^= static_cast<unsigned char>(data[i]);
+      hash_ *= 0x100000001b3ULL;
+    }
+  }
+  void add(const std::string& s) { add(s.data(), s.size() + 1); }
+  std::uint64_t value() const { return hash_; }
+
+ private:
+  std::uint64_t hash_{0xcbf29ce484222325ULL};
+};
+
+void hashFile(Hasher& hasher, const std::filesystem::path& file) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("GeometryCache: can't read " + file.string());
+  hasher.add(file.filename().string());
+  char buffer[1 << 16];
+  while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+    hasher.add(buffer, in.gcount());
+}
+
+}  // namespace
+
+GeometryCache::Volume GeometryCache::describe(
+    const Acts::CuboidVolumeBuilder::VolumeConfig& cfg,
+    const Acts::GeometryContext& gctx) {
+  Volume volume;
+  volume.name = cfg.name;
+  volume.position = cfg.position;
+  volume.length = cfg.length;
+
+  for (const auto& lcfg : cfg.layerCfg) {
+    Layer layer;
+    layer.envelope_x = lcfg.envelopeX;
+    for (const auto& surface : lcfg.surfaces) {
+      auto bounds =
+          dynamic_cast<const Acts::RectangleBounds*>(&surface->bounds());
+      auto material = dynamic_cast<const Acts::HomogeneousSurfaceMaterial*>(
+          surface->surfaceMaterial());
+      if (!bounds || !material)
+        throw std::runtime_error("GeometryCache: the surfaces of " + cfg.name +
+                                 " are not rectangular sensors");
+
+      const auto& slab = material->materialSlab(Acts::Vector2::Zero());
+      Sensor sensor;
+      sensor.transform = surface->transform(gctx);
+      sensor.half_x = bounds->halfLengthX();
+      sensor.half_y = bounds->halfLengthY();
+      sensor.material = slab.material();
+      sensor.thickness = slab.thickness();
+      layer.sensors.push_back(sensor);
+    }
+    volume.layers.push_back(layer);
+  }
+
+  return volume;
+}
+
+Acts::CuboidVolumeBuilder::VolumeConfig GeometryCache::build(
+    const Volume& volume) {
+  Acts::CuboidVolumeBuilder::VolumeConfig cfg;
+  cfg.position = volume.position;
+  cfg.length = volume.length;
+  cfg.name = volume.name;
+
+  // Vacuum material
+  cfg.volumeMaterial =
+      std::make_shared<Acts::HomogeneousVolumeMaterial>(Acts::Material());
+
+  for (const auto& layer : volume.layers) {
+    Acts::CuboidVolumeBuilder::LayerConfig lcfg;
+    for (const auto& sensor : layer.sensors) {
+      auto bounds = std::make_shared<const Acts::RectangleBounds>(
+          sensor.half_x, sensor.half_y);
+      auto surface = Acts::Surface::makeShared<Acts::PlaneSurface>(
+          sensor.transform, bounds);
+      surface->assignSurfaceMaterial(
+          std::make_shared<Acts::HomogeneousSurfaceMaterial>(
+              Acts::MaterialSlab(sensor.material, sensor.thickness)));
+      lcfg.surfaces.push_back(surface);
+    }
+    lcfg.envelopeX = layer.envelope_x;
+    lcfg.active = true;
+    cfg.layerCfg.push_back(lcfg);
+  }
+
+  return cfg;
+}
+
+std::uint64_t GeometryCache::hashGDML(const std::string& gdml) {
+  std::filesystem::path main(gdml);
+  Hasher hasher;
+  hashFile(hasher, main);
+
+  // The detector GDML may include the other GDML files of its directory
+  std::vector<std::filesystem::path> others;
+  std::error_code ec;
+  std::filesystem::path dir = main.parent_path();
+  if (dir.empty()) dir = ".";
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.path().extension() == ".gdml" &&
+        entry.path().filename() != main.filename())
+      others.push_back(entry.path());
+  }
+  std::sort(others.begin(), others.end());
+  for (const auto& file : others) hashFile(hasher, file);
+
+  return hasher.value();
+}
+
+std::string GeometryCache::path(const std::string& dir,
+                                std::uint64_t gdml_hash) {
+  std::ostringstream name;
+  name << "tracking_geometry_" << std::hex << std::setw(16)
+       << std::setfill('0') << gdml_hash << ".txt";
+  return (std::filesystem::path(dir) / name.str()).string();
+}
+
+GeometryCache GeometryCache::read(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("GeometryCache: can't open " + path);
+
+  auto expect = [&](const std::string& keyword) {
+    std::string word;
+    if (!(in >> word) || word != keyword)
+      throw std::runtime_error("GeometryCache: " + path +
+                               " is not a valid cache file, expected '" +
+                               keyword + "'");
+  };
+
+  GeometryCache cache;
+  int version = 0;
+  std::size_t nvolumes = 0;
+
+  expect(kCacheMagic);
+  in >> version;
+  if (!in || version != kCacheVersion)
+    throw std::runtime_error("GeometryCache: " + path +
+                             " has an unsupported version");
+  expect("gdml_hash");
+  in >> std::hex >> cache.gdml_hash >> std::dec;
+  expect("volumes");
+  in >> nvolumes;
+  if (!in)
+    throw std::runtime_error("GeometryCache: " + path +
+                             " has an invalid header");
+
+  // name position[3] length[3] nlayers, then per layer
+  // envelope[2] nsensors, then per sensor
+  // rotation[9] (row major) translation[3] half_x half_y
+  // X0 L0 Ar Z molar_density thickness
+  for (std::size_t v = 0; v < nvolumes; v++) {
+    Volume volume;
+    std::size_t nlayers = 0;
+    expect("volume");
+    in >> volume.name;
+    for (int i = 0; i < 3; i++) in >> volume.position(i);
+    for (int i = 0; i < 3; i++) in >> volume.length(i);
+    in >> nlayers;
+
+    for (std::size_t l = 0; in && l < nlayers; l++) {
+      Layer layer;
+      std::size_t nsensors = 0;
+      expect("layer");
+      in >> layer.envelope_x[0] >> layer.envelope_x[1] >> nsensors;
+
+      for (std::size_t s = 0; in && s < nsensors; s++) {
+        Sensor sensor;
+        Acts::RotationMatrix3 rotation;
+        Acts::Vector3 translation;
+        for (int i = 0; i < 3; i++)
+          for (int j = 0; j < 3; j++) in >> rotation(i, j);
+        for (int i = 0; i < 3; i++) in >> translation(i);
+        in >> sensor.half_x >> sensor.half_y;
+        float x0, l0, ar, z, molar_rho;
+        in >> x0 >> l0 >> ar >> z >> molar_rho >> sensor.thickness;
+
+        sensor.transform = Acts::Translation3(translation) * rotation;
+        sensor.material =
+            Acts::Material::fromMolarDensity(x0, l0, ar, z, molar_rho);
+        layer.sensors.push_back(sensor);
+      }
+      volume.layers.push_back(layer);
+    }
+
+    if (!in)
+      throw std::runtime_error("GeometryCache: " + path + " is truncated");
+    cache.volumes.push_back(volume);
+  }
+
+  return cache;
+}
+
+void GeometryCache::write(const std::string& path) const {
+  // Write to a temporary file and move it in place once complete
+  std::string tmp_path = path + ".tmp." + std::to_string(::getpid());
+  {
+    std::ofstream out(tmp_path, std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("GeometryCache: can't open " + tmp_path);
+
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    out << kCacheMagic << " " << kCacheVersion << "\n";
+    out << "gdml_hash " << std::hex << gdml_hash << std::dec << "\n";
+    out << "volumes " << volumes.size() << "\n";
+    for (const auto& volume : volumes) {
+      out << "volume " << volume.name;
+      for (int i = 0; i < 3; i++) out << " " << volume.position(i);
+      for (int i = 0; i < 3; i++) out << " " << volume.length(i);
+      out << " " << volume.layers.size() << "\n";
+
+      for (const auto& layer : volume.layers) {
+        out << "layer " << layer.envelope_x[0] << " " << layer.envelope_x[1]
+            << " " << layer.sensors.size() << "\n";
+        for (const auto& sensor : layer.sensors) {
+          const auto& rotation = sensor.transform.rotation();
+          for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++) out << rotation(i, j) << " ";
+          for (int i = 0; i < 3; i++)
+            out << sensor.transform.translation()(i) << " ";
+          out << sensor.half_x << " " << sensor.half_y << " ";
+          const auto& m = sensor.material;
+          out << m.X0() << " " << m.L0() << " " << m.Ar() << " " << m.Z()
+              << " " << m.molarDensity() << " " << sensor.thickness << "\n";
+        }
+      }
+    }
+
+    if (!out) {
+      std::remove(tmp_path.c_str());
+      throw std::runtime_error("GeometryCache: failed writing " + tmp_path);
+    }
+  }
+
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("GeometryCache: can't rename " + tmp_path +
+                             " to " + path);
+  }
+}
+
+}  // namespace tracking::geo
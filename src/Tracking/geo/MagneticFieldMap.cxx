@@ -0,0 +1,108 @@
+#include "Tracking/geo/MagneticFieldMap.h"
+
+#include "Framework/ConditionsObjectProvider.h"
+#include "Framework/Configure/Parameters.h"
+#include "Framework/Exception/Exception.h"
+
+#include "Tracking/Sim/BFieldMapView.h"
+
+#include <stdexcept>
+
+namespace tracking::geo {
+
+const std::string MagneticFieldMap::NAME = "TrackingMagneticFieldMap";
+
+MagneticFieldMap::MagneticFieldMap(const std::string& field_map,
+                                   const std::string& field_model)
+  : framework::ConditionsObject(NAME) {
+  grid_ = std::make_shared<const MagneticFieldGrid3>(loadDefaultBFieldGrid(field_map));
+  field_ = std::make_shared<const tracking::sim::DefaultBFieldMapView>(grid_);
+
+  if (!field_model.empty()) {
+    model_ = std::make_shared<const tracking::sim::BFieldRegionModel>(
+        tracking::sim::BFieldRegionModel::read(field_model));
+    if (!model_->matches(*grid_)) {
+      throw std::runtime_error("The field model " + field_model +
+                               " was not fitted on the field map " + field_map);
+    }
+  }
+}
+
+std::shared_ptr<const Acts::MagneticFieldProvider> MagneticFieldMap::get() const {
+  return field_;
+}
+
+std::shared_ptr<const Acts::MagneticFieldProvider> MagneticFieldMap::makeView(
+    const Acts::Vector3& offset, const Acts::RotationMatrix3& rotation,
+    double scale) const {
+  // Without any variation the default view can be shared
+  if (offset.isZero() && rotation.isIdentity() && scale == 1.)
+    return field_;
+
+  return std::make_shared<const tracking::sim::SystematicBFieldMapView>(
+      grid_, tracking::sim::OffsetPosTransform{offset},
+      tracking::sim::RotatedFieldTransform{scale * rotation});
+}
+
+std::shared_ptr<const Acts::MagneticFieldProvider> MagneticFieldMap::makeHybridView(
+    const Acts::Vector3& offset, const Acts::RotationMatrix3& rotation,
+    double scale) const {
+  if (!model_) {
+    throw std::runtime_error(
+        "A hybrid field map was requested but no field model was given to "
+        "the MagneticFieldMapProvider");
+  }
+
+  if (offset.isZero() && rotation.isIdentity() && scale == 1.)
+    return std::make_shared<const tracking::sim::DefaultBFieldHybridMap>(grid_, model_);
+
+  return std::make_shared<const tracking::sim::SystematicBFieldHybridMap>(
+      grid_, model_, tracking::sim::OffsetPosTransform{offset},
+      tracking::sim::RotatedFieldTransform{scale * rotation});
+}
+
+class MagneticFieldMapProvider : public framework::ConditionsObjectProvider {
+ public:
+  /**
+   * Create the field map conditions object provider
+   *
+   * @param[in] name the name of this provider
+   * @param[in] tagname the name of the tag generation of this condition
+   * @param[in] parameters configuration parameters from python
+   * @param[in] process reference to the running process object
+   */
+  MagneticFieldMapProvider(const std::string& name, const std::string& tagname,
+                           const framework::config::Parameters& parameters,
+                           framework::Process& process)
+    : framework::ConditionsObjectProvider(MagneticFieldMap::NAME, tagname, parameters, process) {
+    field_map_ = parameters.getParameter<std::string>("field_map");
+    field_model_ = parameters.getParameter<std::string>("field_model", "");
+  }
+
+  /**
+   * Get the field map as a conditions object
+   *
+   * The map is loaded the first time it is requested and is valid
+   * for the entire job.
+   *
+   * @param[in] context EventHeader for the event context
+   * @returns new field map and unlimited interval of validity
+   */
+  std::pair<const framework::ConditionsObject*, framework::ConditionsIOV>
+  getCondition(const ldmx::EventHeader& context) final override {
+    return std::make_pair<const framework::ConditionsObject*, framework::ConditionsIOV>(
+        new MagneticFieldMap(field_map_, field_model_),
+        framework::ConditionsIOV(true, true)
+    );
+  }
+
+ private:
+  /// path to the field map
+  std::string field_map_;
+  /// path to the region model of the field map, empty if none
+  std::string field_model_;
+};
+
+}
+
+DECLARE_CONDITIONS_PROVIDER_NS(tracking::geo, MagneticFieldMapProvider)
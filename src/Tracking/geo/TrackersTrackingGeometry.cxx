@@ -1,29 +1,74 @@
 #include "Tracking/geo/TrackersTrackingGeometry.h"
 
+#include "Tracking/geo/GeometryCache.h"
+
+#include <filesystem>
+
 namespace tracking::geo {
 
 const std::string TrackersTrackingGeometry::NAME = "TrackersTrackingGeometry";
 
 TrackersTrackingGeometry::TrackersTrackingGeometry(
-    const Acts::GeometryContext& gctx, const std::string& gdml, bool debug)
+    const Acts::GeometryContext& gctx, const std::string& gdml, bool debug,
+    const std::string& cache_dir)
   : TrackingGeometry(NAME, gctx, gdml, debug) {
-  if (debug_) std::cout << "Looking for Tagger and Recoil volumes" << std::endl;
-
-  Tagger_ = findDaughterByName(fWorldPhysVol_, "tagger_PV");
-  //v12
-  //BuildTaggerLayoutMap(Tagger_, "LDMXTaggerModuleVolume_physvol");
-  //v14
-  BuildTaggerLayoutMap(Tagger_, "tagger");
-  Acts::CuboidVolumeBuilder::VolumeConfig tagger_volume_cfg =
-      buildTrackerVolume();
-  
-  Recoil_ = findDaughterByName(fWorldPhysVol_, "recoil_PV");
-  BuildRecoilLayoutMap(Recoil_, "recoil");
-  Acts::CuboidVolumeBuilder::VolumeConfig recoil_volume_cfg =
-      buildRecoilVolume();
-  
-  std::vector<Acts::CuboidVolumeBuilder::VolumeConfig> volBuilderConfigs{
-    tagger_volume_cfg, recoil_volume_cfg};
+  std::vector<Acts::CuboidVolumeBuilder::VolumeConfig> volBuilderConfigs;
+
+  // Look for a cache of this detector, which saves parsing the GDML
+  std::string cache_path;
+  std::uint64_t gdml_hash{0};
+  if (!cache_dir.empty()) {
+    gdml_hash = GeometryCache::hashGDML(gdml_);
+    cache_path = GeometryCache::path(cache_dir, gdml_hash);
+    if (std::filesystem::exists(cache_path)) {
+      try {
+        GeometryCache cache = GeometryCache::read(cache_path);
+        if (cache.gdml_hash != gdml_hash)
+          throw std::runtime_error("GeometryCache: " + cache_path +
+                                   " was built from another detector");
+        for (const auto& volume : cache.volumes)
+          volBuilderConfigs.push_back(GeometryCache::build(volume));
+        if (debug_)
+          std::cout << "Tracking geometry read from " << cache_path
+                    << std::endl;
+      } catch (const std::runtime_error& e) {
+        std::cout << "WARNING:: " << e.what()
+                  << ". Building the tracking geometry from the GDML."
+                  << std::endl;
+        volBuilderConfigs.clear();
+      }
+    }
+  }
+
+  if (volBuilderConfigs.empty()) {
+    parseGDML();
+
+    if (debug_) std::cout << "Looking for Tagger and Recoil volumes" << std::endl;
+
+    Tagger_ = findDaughterByName(fWorldPhysVol_, "tagger_PV");
+    //v12
+    //BuildTaggerLayoutMap(Tagger_, "LDMXTaggerModuleVolume_physvol");
+    //v14
+    BuildTaggerLayoutMap(Tagger_, "tagger");
+    volBuilderConfigs.push_back(buildTrackerVolume());
+
+    Recoil_ = findDaughterByName(fWorldPhysVol_, "recoil_PV");
+    BuildRecoilLayoutMap(Recoil_, "recoil");
+    volBuilderConfigs.push_back(buildRecoilVolume());
+
+    if (!cache_path.empty()) {
+      try {
+        GeometryCache cache;
+        cache.gdml_hash = gdml_hash;
+        for (const auto& cfg : volBuilderConfigs)
+          cache.volumes.push_back(GeometryCache::describe(cfg, gctx_));
+        cache.write(cache_path);
+      } catch (const std::runtime_error& e) {
+        // The job can go on without the cache
+        std::cout << "WARNING:: " << e.what() << std::endl;
+      }
+    }
+  }
   
   // Create the builder
   Acts::CuboidVolumeBuilder cvb;
@@ -32,6 +32,8 @@ class TrackersTrackingGeometryProvider : public framework::ConditionsObjectProvi
   std::string detector_;
   /// whether to have debug information or not
   bool debug_;
+  /// directory of the geometry caches, empty to not use them
+  std::string geometry_cache_;
 };
 
 TrackersTrackingGeometryProvider::TrackersTrackingGeometryProvider(
@@ -41,6 +43,7 @@ TrackersTrackingGeometryProvider::TrackersTrackingGeometryProvider(
   : framework::ConditionsObjectProvider(name, tag_name, parameters, process) {
     detector_ = parameters.getParameter<std::string>("detector");
     debug_ = parameters.getParameter<bool>("debug");
+    geometry_cache_ = parameters.getParameter<std::string>("geometry_cache", "");
 }
 
 std::pair<const framework::ConditionsObject*, framework::ConditionsIOV>
@@ -64,7 +67,8 @@ TrackersTrackingGeometryProvider::getCondition(const ldmx::EventHeader& context)
    * but is the main way to do it in the currently-designed conditions system.
    */
   return std::make_pair(
-      new TrackersTrackingGeometry(the_context->get(), detector_, debug_),
+      new TrackersTrackingGeometry(the_context->get(), detector_, debug_,
+                                   geometry_cache_),
       iov
   );
 }
@@ -1,6 +1,13 @@
 
 #include "Tracking/geo/TrackingGeometry.h"
 
+#include "Acts/Material/ISurfaceMaterial.hpp"
+#include "Acts/Surfaces/PlanarBounds.hpp"
+#include "Acts/Surfaces/RectangleBounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+
 namespace tracking::geo {
 
 TrackingGeometry::TrackingGeometry(
@@ -36,7 +43,9 @@ TrackingGeometry::TrackingGeometry(
   x_rot_.col(0) = xPos2;
   x_rot_.col(1) = yPos2;
   x_rot_.col(2) = zPos2;
+}
 
+void TrackingGeometry::parseGDML() {
   // Get the world volume
   G4GDMLParser parser;
 
@@ -253,6 +262,8 @@ void TrackingGeometry::makeLayerSurfacesMap() {
 
   }  // surfaces loop
 
+  makeSensorTable();
+
   if (debug_) {
     std::cout << __PRETTY_FUNCTION__ << std::endl;
 
@@ -268,4 +279,65 @@ void TrackingGeometry::makeLayerSurfacesMap() {
   }
 }
 
+void TrackingGeometry::makeSensorTable() {
+  std::vector<unsigned int> ids;
+  for (const auto& [id, surface] : layer_surface_map_) ids.push_back(id);
+  std::sort(ids.begin(), ids.end());
+
+  sensors_.clear();
+  sensor_index_.assign(ids.empty() ? 0 : ids.back() + 1, -1);
+
+  for (unsigned int id : ids) {
+    const Acts::Surface* surface = layer_surface_map_.at(id);
+    if (!surface) continue;
+
+    Sensor sensor;
+    sensor.surface = surface;
+    sensor.geometry_id = surface->geometryId();
+    sensor.transform = surface->transform(gctx_);
+    sensor.inverse = sensor.transform.inverse();
+    sensor.rotation = sensor.transform.rotation().transpose();
+    sensor.translation = sensor.transform.translation();
+    sensor.normal = sensor.transform.rotation().col(2);
+
+    auto bounds = dynamic_cast<const Acts::PlanarBounds*>(&surface->bounds());
+    if (bounds) {
+      sensor.half_length_u = bounds->boundingBox().halfLengthX();
+      sensor.half_length_v = bounds->boundingBox().halfLengthY();
+    }
+
+    if (surface->surfaceMaterial()) {
+      sensor.thickness = surface->surfaceMaterial()
+                             ->materialSlab(Acts::Vector2::Zero())
+                             .thickness();
+    }
+
+    sensor_index_[id] = static_cast<std::int32_t>(sensors_.size());
+    sensors_.push_back(sensor);
+  }
+
+  // Group the sensors orthogonal to x at the same position in planes. A
+  // sensor that is not orthogonal to x gets its own plane.
+  const double plane_tolerance = 1e-3 * Acts::UnitConstants::mm;
+  std::vector<const Sensor*> by_x;
+  for (const auto& sensor : sensors_) by_x.push_back(&sensor);
+  std::stable_sort(by_x.begin(), by_x.end(),
+                   [](const Sensor* a, const Sensor* b) {
+                     return a->translation(0) < b->translation(0);
+                   });
+
+  telescope_planes_.clear();
+  bool last_orthogonal = false;
+  for (const Sensor* sensor : by_x) {
+    bool orthogonal = std::abs(std::abs(sensor->normal(0)) - 1.) < 1e-9;
+    if (telescope_planes_.empty() || !orthogonal || !last_orthogonal ||
+        sensor->translation(0) - telescope_planes_.back().x > plane_tolerance) {
+      telescope_planes_.emplace_back();
+      telescope_planes_.back().x = sensor->translation(0);
+    }
+    telescope_planes_.back().sensors.push_back(sensor->surface);
+    last_orthogonal = orthogonal;
+  }
+}
+
 }  // namespace tracking::geo